@@ -26,7 +26,9 @@ set(CORE_SOURCES
         operator_cost.cc
         option_parser.h
         option_parser_util.h
+        per_state_bitset.cc
         per_state_information.cc
+        planner_service.cc
         plugin.h
         pruning_method.cc
         priority_queue.cc
@@ -131,9 +133,13 @@ fast_downward_plugin(
         utils/markup.cc
         utils/math.cc
         utils/memory.cc
+        utils/parallel.cc
         utils/planvis.cc
+        utils/profiler.cc
         utils/rng.cc
         utils/rng_options.cc
+        utils/search_trace.cc
+        utils/segment_allocator.cc
         utils/system.cc
         utils/system_unix.cc
         utils/system_windows.cc
@@ -232,6 +238,13 @@ fast_downward_plugin(
     DEPENDENCY_ONLY
 )
 
+fast_downward_plugin(
+    NAME ANYTIME_SEARCH
+    HELP "Anytime repairing A* search algorithm"
+    SOURCES
+        search_engines/anytime_search.cc
+)
+
 fast_downward_plugin(
     NAME EAGER_SEARCH
     HELP "Eager search algorithm"
@@ -248,6 +261,13 @@ fast_downward_plugin(
     DEPENDS SEARCH_COMMON PREF_EVALUATOR G_EVALUATOR
 )
 
+fast_downward_plugin(
+    NAME EXTERNAL_SEARCH
+    HELP "External breadth-first search with delayed duplicate detection"
+    SOURCES
+        search_engines/external_search.cc
+)
+
 fast_downward_plugin(
     NAME ITERATED_SEARCH
     HELP "Iterated search algorithm"
@@ -255,6 +275,21 @@ fast_downward_plugin(
         search_engines/iterated_search.cc
 )
 
+fast_downward_plugin(
+    NAME PORTFOLIO_SEARCH
+    HELP "In-process portfolio of search algorithms"
+    SOURCES
+        search_engines/portfolio_search.cc
+)
+
+fast_downward_plugin(
+    NAME PARALLEL_GREEDY_SEARCH
+    HELP "Greedy best-first search with several threads"
+    SOURCES
+        search_engines/parallel_greedy_search.cc
+    DEPENDS SEARCH_COMMON
+)
+
 fast_downward_plugin(
     NAME LAZY_SEARCH
     HELP "Lazy search algorithm"
@@ -278,6 +313,7 @@ fast_downward_plugin(
     HELP "The base class for relaxation heuristics"
     SOURCES
         heuristics/relaxation_heuristic.cc
+        heuristics/relaxed_task.cc
     DEPENDENCY_ONLY
 )
 
@@ -568,6 +604,7 @@ fast_downward_plugin(
     SOURCES
         pdbs/canonical_pdbs.cc
         pdbs/canonical_pdbs_heuristic.cc
+        pdbs/compressed_distances.cc
         pdbs/dominance_pruning.cc
         pdbs/incremental_canonical_pdbs.cc
         pdbs/match_tree.cc
@@ -607,6 +644,8 @@ fast_downward_plugin(
         numeric_pdbs/numeric_helper.cc
         numeric_pdbs/numeric_state_registry.cc
         numeric_pdbs/numeric_task_proxy.cc
+        numeric_pdbs/packed_pdb_collection.cc
+        numeric_pdbs/pattern_collection_generator_cached.cc
         numeric_pdbs/pattern_collection_generator_hillclimbing.cc
         numeric_pdbs/pattern_collection_generator_systematic.cc
         numeric_pdbs/pattern_collection_information.cc
@@ -618,6 +657,7 @@ fast_downward_plugin(
         numeric_pdbs/types.cc
         numeric_pdbs/validation.cc
         numeric_pdbs/variable_order_finder.cc
+    DEPENDS PDBS
 )
 
 fast_downward_plugin(
@@ -0,0 +1,71 @@
+#ifndef ARRAY_VIEW_H
+#define ARRAY_VIEW_H
+
+#include <cassert>
+#include <cstddef>
+#include <type_traits>
+#include <vector>
+
+/*
+  ArrayView gives access to a contiguous array of elements owned by someone
+  else, e.g. the entries a PerStateArray stores for one state. Views of
+  const elements can also be created from vectors and from views of
+  non-const elements.
+*/
+template<class T>
+class ArrayView {
+    typedef typename std::remove_const<T>::type Element;
+
+    T *p;
+    std::size_t the_size;
+public:
+    ArrayView(T *p, std::size_t size)
+        : p(p), the_size(size) {
+    }
+
+    ArrayView(std::vector<Element> &vec)
+        : p(vec.data()), the_size(vec.size()) {
+    }
+
+    // Only usable for views of const elements.
+    ArrayView(const std::vector<Element> &vec)
+        : p(vec.data()), the_size(vec.size()) {
+    }
+
+    template<class U, class = typename std::enable_if<
+                          std::is_same<const U, T>::value>::type>
+    ArrayView(const ArrayView<U> &other)
+        : p(other.data()), the_size(other.size()) {
+    }
+
+    T &operator[](std::size_t index) const {
+        assert(index < the_size);
+        return p[index];
+    }
+
+    T *data() const {
+        return p;
+    }
+
+    std::size_t size() const {
+        return the_size;
+    }
+
+    bool empty() const {
+        return the_size == 0;
+    }
+
+    T *begin() const {
+        return p;
+    }
+
+    T *end() const {
+        return p + the_size;
+    }
+
+    std::vector<Element> to_vector() const {
+        return std::vector<Element>(begin(), end());
+    }
+};
+
+#endif
@@ -3,6 +3,8 @@
 #include "globals.h"
 #include "int_packer.h"
 
+#include "utils/profiler.h"
+
 #include <algorithm>
 #include <cassert>
 #include <iostream>
@@ -169,6 +171,9 @@ AxiomEvaluator::AxiomEvaluator() {
 }
 
 void AxiomEvaluator::evaluate(PackedStateBin *buffer, vector<ap_float> &numeric_state) {
+    static utils::ProfileNode &profile_node =
+        utils::get_profile_node("search/axioms");
+    utils::ProfileScope profile_scope(profile_node);
     if (!has_axioms()) {
     	if (DEBUG) cout << "Task has no axioms -> return" << endl;
         return;
@@ -202,6 +207,9 @@ void AxiomEvaluator::evaluate(vector<int> &state, vector<ap_float> &numeric_stat
 
 void AxiomEvaluator::evaluate_arithmetic_axioms(vector<ap_float> &numeric_state)
 {
+    static utils::ProfileNode &profile_node =
+        utils::get_profile_node("search/arithmetic_axioms");
+    utils::ProfileScope profile_scope(profile_node);
 //	int current_layer = -1;
 	for (const auto & ax : g_ass_axioms) {
 		assert(g_numeric_var_names.size() == numeric_state.size());
@@ -325,10 +333,19 @@ void AxiomEvaluator::evaluate_comparison_axioms(vector<int> &state, vector<ap_fl
 }
 
 
+AxiomEvaluator::EvaluationData &AxiomEvaluator::get_evaluation_data() const {
+    static thread_local EvaluationData data;
+    data.unsatisfied_conditions.resize(rules.size());
+    return data;
+}
+
 // TODO rethink the way this is called: see issue348.
 void AxiomEvaluator::evaluate_logic_axioms(PackedStateBin *buffer) {
     if (!has_logic_axioms())
         return;
+    EvaluationData &data = get_evaluation_data();
+    vector<AxiomLiteral *> &queue = data.queue;
+    vector<int> &unsatisfied_conditions = data.unsatisfied_conditions;
     assert(queue.empty());
     for (size_t i = 0; i < g_axiom_layers.size(); ++i) { // g_axiom_layers[i] is the layer of the i-th variable
 
@@ -359,7 +376,7 @@ void AxiomEvaluator::evaluate_logic_axioms(PackedStateBin *buffer) {
     }
 
     for (size_t i = 0; i < rules.size(); ++i) {
-        rules[i].unsatisfied_conditions = rules[i].condition_count;
+        unsatisfied_conditions[i] = rules[i].condition_count;
 
         // TODO: In a perfect world, trivial axioms would have been
         // compiled away, and we could have the following assertion
@@ -388,7 +405,7 @@ void AxiomEvaluator::evaluate_logic_axioms(PackedStateBin *buffer) {
             for (size_t i = 0; i < curr_literal->condition_of.size(); ++i) {
                 AxiomRule *rule = curr_literal->condition_of[i];
 //                if(DEBUG) cout << "Axiom Eval Queue popped literal which is a condition of [" << rule->effect_var << "][" << rule->effect_val << "]" << endl;
-                if (--rule->unsatisfied_conditions == 0) {
+                if (--unsatisfied_conditions[rule - rules.data()] == 0) {
                     int var_no = rule->effect_var;
                     container_int val = rule->effect_val;
                     if (g_state_packer->get(buffer, var_no) != val) {
@@ -417,6 +434,9 @@ void AxiomEvaluator::evaluate_logic_axioms(PackedStateBin *buffer) {
 void AxiomEvaluator::evaluate_logic_axioms(vector<int> &state) {
     if (!has_logic_axioms())
         return;
+    EvaluationData &data = get_evaluation_data();
+    vector<AxiomLiteral *> &queue = data.queue;
+    vector<int> &unsatisfied_conditions = data.unsatisfied_conditions;
     assert(queue.empty());
     for (size_t i = 0; i < g_axiom_layers.size(); ++i) { // g_axiom_layers[i] is the layer of the i-th variable
 
@@ -447,7 +467,7 @@ void AxiomEvaluator::evaluate_logic_axioms(vector<int> &state) {
     }
 
     for (size_t i = 0; i < rules.size(); ++i) {
-        rules[i].unsatisfied_conditions = rules[i].condition_count;
+        unsatisfied_conditions[i] = rules[i].condition_count;
 
         // TODO: In a perfect world, trivial axioms would have been
         // compiled away, and we could have the following assertion
@@ -476,7 +496,7 @@ void AxiomEvaluator::evaluate_logic_axioms(vector<int> &state) {
             for (size_t i = 0; i < curr_literal->condition_of.size(); ++i) {
                 AxiomRule *rule = curr_literal->condition_of[i];
 //                if(DEBUG) cout << "Axiom Eval Queue popped literal which is a condition of [" << rule->effect_var << "][" << rule->effect_val << "]" << endl;
-                if (--rule->unsatisfied_conditions == 0) {
+                if (--unsatisfied_conditions[rule - rules.data()] == 0) {
                     int var_no = rule->effect_var;
                     container_int val = rule->effect_val;
                     if (state[var_no] != val) {
@@ -75,12 +75,11 @@ class AxiomEvaluator {
     };
     struct AxiomRule {
         int condition_count;
-        int unsatisfied_conditions;
         int effect_var;
         container_int effect_val;
         AxiomLiteral *effect_literal;
         AxiomRule(int cond_count, int eff_var, int eff_val, AxiomLiteral *eff_literal)
-            : condition_count(cond_count), unsatisfied_conditions(cond_count),
+            : condition_count(cond_count),
               effect_var(eff_var), effect_val(eff_val), effect_literal(eff_literal) {
         }
     };
@@ -95,9 +94,18 @@ class AxiomEvaluator {
     std::vector<AxiomRule> rules;
     std::vector<std::vector<NegationByFailureInfo>> nbf_info_by_layer;
 
-    // The queue is an instance variable rather than a local variable
-    // to reduce reallocation effort. See issue420.
-    std::vector<AxiomLiteral *> queue;
+    /*
+      Data that changes while logic axioms are evaluated. Every thread has
+      its own copy, so that several threads can evaluate axioms at the same
+      time. The data is kept between evaluations rather than being local
+      to reduce reallocation effort. See issue420.
+    */
+    struct EvaluationData {
+        std::vector<AxiomLiteral *> queue;
+        // Number of unsatisfied conditions, indexed like rules.
+        std::vector<int> unsatisfied_conditions;
+    };
+    EvaluationData &get_evaluation_data() const;
 private:
     void evaluate_comparison_axioms(PackedStateBin *buffer, std::vector<ap_float> &numeric_state);
     void evaluate_comparison_axioms(std::vector<int> &state, std::vector<ap_float> &numeric_state);
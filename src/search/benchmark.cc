@@ -0,0 +1,496 @@
+#include "axioms.h"
+#include "evaluation_context.h"
+#include "global_operator.h"
+#include "global_state.h"
+#include "globals.h"
+#include "heuristic.h"
+#include "option_parser.h"
+#include "state_registry.h"
+#include "successor_generator.h"
+
+#include "open_lists/open_list_factory.h"
+
+#include "utils/system.h"
+#include "utils/timer.h"
+
+#include <algorithm>
+#include <deque>
+#include <fstream>
+#include <iostream>
+#include <limits>
+#include <memory>
+#include <string>
+#include <vector>
+
+using namespace std;
+using utils::ExitCode;
+
+/*
+  Measures the throughput of the hot paths of the search in isolation on a
+  single preprocessed task:
+
+  * state_space_exploration: breadth-first search that samples the states
+  * successor_generation: SuccessorGenerator::generate_applicable_ops
+  * state_registry_insert: StateRegistry::get_successor_state with an
+    empty registry, so that (almost) all successors are new
+  * state_registry_lookup: StateRegistry::get_successor_state with
+    successors that are registered already
+  * axioms: AxiomEvaluator (arithmetic, comparison and logic axioms)
+  * heuristic <config>: Heuristic::compute_result for each --heuristic
+  * open_list <config>: insert and remove_min of the --open-list
+
+  All components work on the same sample of states, which is the result of
+  a breadth-first search from the initial state. Times are CPU times; each
+  measurement is repeated and the fastest repetition is reported, except
+  for heuristics, whose estimates would be cached after the first one.
+
+  Results are written as JSON (--output) and can be compared against the
+  results of a previous run (--baseline). Components that got slower (or
+  use more memory per state) by more than the tolerance are reported as
+  regressions and make the benchmark exit with code 1.
+
+  The tasks in src/search/benchmarks are run by the run_benchmarks target.
+*/
+
+struct BenchmarkResult {
+    string name;
+    double states_per_second;
+    // Only measured for the state space exploration, 0 otherwise.
+    double bytes_per_state;
+};
+
+struct BenchmarkOptions {
+    string task_filename;
+    string output_filename;
+    string baseline_filename;
+    vector<string> heuristics = {"blind()", "hrmax()", "aibr()"};
+    vector<string> open_lists = {"single(g())"};
+    int num_states = 10000;
+    int repetitions = 5;
+    double tolerance = 0.1;
+};
+
+static string get_task_name(const string &filename) {
+    // Bundled tasks are stored as benchmarks/<name>/output.
+    string name = filename;
+    size_t end = name.find_last_of('/');
+    if (end != string::npos && name.substr(end + 1) == "output") {
+        name = name.substr(0, end);
+    }
+    size_t begin = name.find_last_of('/');
+    return begin == string::npos ? name : name.substr(begin + 1);
+}
+
+static BenchmarkOptions parse_arguments(int argc, const char **argv) {
+    BenchmarkOptions options;
+    bool default_heuristics = true;
+    bool default_open_lists = true;
+    for (int i = 1; i < argc; ++i) {
+        string arg = argv[i];
+        if (i == argc - 1) {
+            cerr << "missing argument after " << arg << endl;
+            utils::exit_with(ExitCode::INPUT_ERROR);
+        }
+        string value = argv[++i];
+        if (arg == "--task") {
+            options.task_filename = value;
+        } else if (arg == "--output") {
+            options.output_filename = value;
+        } else if (arg == "--baseline") {
+            options.baseline_filename = value;
+        } else if (arg == "--heuristic") {
+            if (default_heuristics)
+                options.heuristics.clear();
+            default_heuristics = false;
+            options.heuristics.push_back(value);
+        } else if (arg == "--open-list") {
+            if (default_open_lists)
+                options.open_lists.clear();
+            default_open_lists = false;
+            options.open_lists.push_back(value);
+        } else if (arg == "--states") {
+            options.num_states = stoi(value);
+        } else if (arg == "--repetitions") {
+            options.repetitions = stoi(value);
+        } else if (arg == "--tolerance") {
+            options.tolerance = stod(value);
+        } else {
+            cerr << "unknown option " << arg << endl;
+            utils::exit_with(ExitCode::INPUT_ERROR);
+        }
+    }
+    if (options.task_filename.empty()) {
+        cerr << "usage: " << argv[0] << " --task OUTPUT [--output JSON]"
+             << " [--baseline JSON] [--heuristic CONFIG]..."
+             << " [--open-list CONFIG]... [--states N] [--repetitions N]"
+             << " [--tolerance FRACTION]" << endl;
+        utils::exit_with(ExitCode::INPUT_ERROR);
+    }
+    if (options.num_states < 1 || options.repetitions < 1) {
+        cerr << "--states and --repetitions must be positive" << endl;
+        utils::exit_with(ExitCode::INPUT_ERROR);
+    }
+    return options;
+}
+
+/*
+  Runs the given function the given number of times and returns the CPU
+  time of the fastest run.
+*/
+template<typename Function>
+static double get_best_time(int repetitions, Function function) {
+    double best_time = numeric_limits<double>::max();
+    for (int i = 0; i < repetitions; ++i) {
+        utils::Timer timer;
+        function();
+        best_time = min(best_time, timer.stop());
+    }
+    return best_time;
+}
+
+static double get_rate(size_t num_states, double time) {
+    // Guard against timer resolution on tiny tasks.
+    return num_states / max(time, 1e-9);
+}
+
+static int get_num_vars_of_type(numType type) {
+    return count(g_numeric_var_types.begin(), g_numeric_var_types.end(), type);
+}
+
+/*
+  Memory per state of the given registry: its packed state data and hash
+  set entries, and the instrumentation variables of the state.
+*/
+static double get_bytes_per_state(const StateRegistry &registry) {
+    if (registry.size() == 0)
+        return 0;
+    return static_cast<double>(registry.get_memory_in_bytes()) / registry.size() +
+           get_num_vars_of_type(instrumentation) * sizeof(ap_float);
+}
+
+/*
+  Breadth-first search from the initial state until num_states states are
+  expanded. Also reports the memory used per registered state.
+*/
+static vector<StateID> sample_states(int num_states, vector<BenchmarkResult> &results) {
+    const GlobalState &initial_state = g_initial_state();
+    size_t registry_size_before = g_state_registry->size();
+    vector<StateID> states;
+    deque<StateID> queue;
+    queue.push_back(initial_state.get_id());
+    vector<const GlobalOperator *> applicable_ops;
+    utils::Timer timer;
+    while (!queue.empty() && static_cast<int>(states.size()) < num_states) {
+        GlobalState state = g_state_registry->lookup_state(queue.front());
+        queue.pop_front();
+        states.push_back(state.get_id());
+        applicable_ops.clear();
+        g_successor_generator->generate_applicable_ops(state, applicable_ops);
+        for (const GlobalOperator *op : applicable_ops) {
+            size_t old_size = g_state_registry->size();
+            GlobalState succ_state = g_state_registry->get_successor_state(state, *op);
+            if (g_state_registry->size() > old_size)
+                queue.push_back(succ_state.get_id());
+        }
+    }
+    double time = timer.stop();
+    size_t registered = g_state_registry->size() - registry_size_before;
+    results.push_back(
+        {"state_space_exploration", get_rate(states.size(), time),
+         get_bytes_per_state(*g_state_registry)});
+    cout << "Sampled " << states.size() << " states (" << registered
+         << " registered)" << endl;
+    return states;
+}
+
+static void benchmark_successor_generation(
+    const vector<StateID> &states, int repetitions,
+    vector<BenchmarkResult> &results) {
+    vector<const GlobalOperator *> applicable_ops;
+    size_t num_ops = 0;
+    double time = get_best_time(repetitions, [&] () {
+        num_ops = 0;
+        for (StateID id : states) {
+            GlobalState state = g_state_registry->lookup_state(id);
+            applicable_ops.clear();
+            g_successor_generator->generate_applicable_ops(state, applicable_ops);
+            num_ops += applicable_ops.size();
+        }
+    });
+    results.push_back({"successor_generation", get_rate(states.size(), time), 0});
+    cout << "Applicable operators per state: "
+         << static_cast<double>(num_ops) / states.size() << endl;
+}
+
+static void benchmark_state_registry(
+    const vector<StateID> &states, int repetitions,
+    vector<BenchmarkResult> &results) {
+    vector<pair<StateID, const GlobalOperator *>> transitions;
+    vector<const GlobalOperator *> applicable_ops;
+    for (StateID id : states) {
+        GlobalState state = g_state_registry->lookup_state(id);
+        applicable_ops.clear();
+        g_successor_generator->generate_applicable_ops(state, applicable_ops);
+        for (const GlobalOperator *op : applicable_ops)
+            transitions.emplace_back(id, op);
+    }
+
+    /*
+      The successors of the sampled states are new in a fresh registry. The
+      registry is created and destroyed outside of the measurement.
+    */
+    double insert_time = numeric_limits<double>::max();
+    double bytes_per_state = 0;
+    for (int i = 0; i < repetitions; ++i) {
+        StateRegistry registry(get_num_vars_of_type(constant));
+        // Sets up where the registry stores numeric variables.
+        registry.get_initial_state();
+        utils::Timer timer;
+        for (const auto &transition : transitions) {
+            GlobalState state = g_state_registry->lookup_state(transition.first);
+            registry.get_successor_state(state, *transition.second);
+        }
+        insert_time = min(insert_time, timer.stop());
+        bytes_per_state = get_bytes_per_state(registry);
+    }
+    results.push_back({"state_registry_insert",
+                       get_rate(transitions.size(), insert_time),
+                       bytes_per_state});
+
+    // The sampling registered all successors of the sampled states.
+    double lookup_time = get_best_time(repetitions, [&] () {
+        for (const auto &transition : transitions) {
+            GlobalState state = g_state_registry->lookup_state(transition.first);
+            g_state_registry->get_successor_state(state, *transition.second);
+        }
+    });
+    results.push_back({"state_registry_lookup",
+                       get_rate(transitions.size(), lookup_time), 0});
+}
+
+static void benchmark_state_unpacking(
+    const vector<StateID> &states, int repetitions,
+    vector<BenchmarkResult> &results) {
+    size_t checksum = 0;
+    double time = get_best_time(repetitions, [&] () {
+        for (StateID id : states) {
+            GlobalState state = g_state_registry->lookup_state(id);
+            vector<int> values = state.get_values();
+            checksum += values.empty() ? 0 : values.back();
+        }
+    });
+    // Use the values, so that the compiler cannot remove the unpacking.
+    if (checksum == numeric_limits<size_t>::max())
+        cout << "checksum " << checksum << endl;
+    results.push_back({"state_unpacking", get_rate(states.size(), time), 0});
+}
+
+static void benchmark_axioms(
+    const vector<StateID> &states, int repetitions,
+    vector<BenchmarkResult> &results) {
+    vector<vector<int>> unpacked_states;
+    vector<vector<ap_float>> numeric_states;
+    for (StateID id : states) {
+        GlobalState state = g_state_registry->lookup_state(id);
+        unpacked_states.push_back(state.get_values());
+        numeric_states.push_back(state.get_numeric_vars());
+    }
+    double time = get_best_time(repetitions, [&] () {
+        for (size_t i = 0; i < states.size(); ++i) {
+            vector<int> values = unpacked_states[i];
+            vector<ap_float> numeric_values = numeric_states[i];
+            g_axiom_evaluator->evaluate_arithmetic_axioms(numeric_values);
+            g_axiom_evaluator->evaluate(values, numeric_values);
+        }
+    });
+    results.push_back({"axioms", get_rate(states.size(), time), 0});
+}
+
+static void benchmark_heuristic(
+    const string &config, const vector<StateID> &states,
+    vector<BenchmarkResult> &results) {
+    Heuristic *heuristic = nullptr;
+    try {
+        OptionParser(config, true).start_parsing<Heuristic *>();
+        heuristic = OptionParser(config, false).start_parsing<Heuristic *>();
+    } catch (ParseError &error) {
+        cerr << error << endl;
+        utils::exit_with(ExitCode::INPUT_ERROR);
+    }
+    // Keep initialization out of the measurement.
+    EvaluationContext initial_context(g_initial_state());
+    initial_context.get_heuristic_value_or_infinity(heuristic);
+
+    utils::Timer timer;
+    for (StateID id : states) {
+        EvaluationContext eval_context(g_state_registry->lookup_state(id));
+        eval_context.get_heuristic_value_or_infinity(heuristic);
+    }
+    double time = timer.stop();
+    results.push_back({"heuristic " + config, get_rate(states.size(), time), 0});
+}
+
+static void benchmark_open_list(
+    const string &config, const vector<StateID> &states, int repetitions,
+    vector<BenchmarkResult> &results) {
+    shared_ptr<OpenListFactory> factory;
+    try {
+        OptionParser(config, true).start_parsing<shared_ptr<OpenListFactory>>();
+        factory = OptionParser(config, false).start_parsing<shared_ptr<OpenListFactory>>();
+    } catch (ParseError &error) {
+        cerr << error << endl;
+        utils::exit_with(ExitCode::INPUT_ERROR);
+    }
+    double time = get_best_time(repetitions, [&] () {
+        unique_ptr<StateOpenList> open_list = factory->create_state_open_list();
+        // States are sampled in breadth-first order, so the position
+        // is a monotone stand-in for the g value.
+        for (size_t i = 0; i < states.size(); ++i) {
+            EvaluationContext eval_context(
+                g_state_registry->lookup_state(states[i]), i, false, nullptr);
+            open_list->insert(eval_context, states[i]);
+        }
+        while (!open_list->empty())
+            open_list->remove_min();
+    });
+    results.push_back({"open_list " + config, get_rate(states.size(), time), 0});
+}
+
+static string escape_json(const string &text) {
+    string result;
+    for (char c : text) {
+        if (c == '"' || c == '\\')
+            result += '\\';
+        result += c;
+    }
+    return result;
+}
+
+static void write_results(const string &filename, const string &task_name,
+                          const vector<BenchmarkResult> &results) {
+    ofstream out(filename);
+    if (!out) {
+        cerr << "Could not write benchmark results to " << filename << endl;
+        utils::exit_with(ExitCode::CRITICAL_ERROR);
+    }
+    // One result per line so that read_results does not need a JSON parser.
+    out << "{\"task\": \"" << escape_json(task_name) << "\", \"results\": [" << endl;
+    for (size_t i = 0; i < results.size(); ++i) {
+        const BenchmarkResult &result = results[i];
+        out << "{\"name\": \"" << escape_json(result.name) << "\", "
+            << "\"states_per_second\": " << result.states_per_second << ", "
+            << "\"bytes_per_state\": " << result.bytes_per_state << "}"
+            << (i + 1 < results.size() ? "," : "") << endl;
+    }
+    out << "]}" << endl;
+}
+
+static double read_number_after(const string &line, const string &key) {
+    size_t pos = line.find(key);
+    if (pos == string::npos)
+        return 0;
+    return stod(line.substr(pos + key.size()));
+}
+
+// Reads files written by write_results.
+static vector<BenchmarkResult> read_results(const string &filename) {
+    ifstream in(filename);
+    if (!in) {
+        cerr << "Could not read benchmark baseline " << filename << endl;
+        utils::exit_with(ExitCode::INPUT_ERROR);
+    }
+    vector<BenchmarkResult> results;
+    const string name_key = "{\"name\": \"";
+    string line;
+    while (getline(in, line)) {
+        if (line.compare(0, name_key.size(), name_key) != 0)
+            continue;
+        BenchmarkResult result;
+        size_t end = name_key.size();
+        while (end < line.size() && line[end] != '"') {
+            if (line[end] == '\\')
+                ++end;
+            result.name += line[end++];
+        }
+        result.states_per_second = read_number_after(line, "\"states_per_second\": ");
+        result.bytes_per_state = read_number_after(line, "\"bytes_per_state\": ");
+        results.push_back(result);
+    }
+    return results;
+}
+
+// Returns the number of regressions.
+static int compare_with_baseline(const vector<BenchmarkResult> &results,
+                                 const vector<BenchmarkResult> &baseline,
+                                 double tolerance) {
+    int num_regressions = 0;
+    for (const BenchmarkResult &result : results) {
+        auto old_result = find_if(
+            baseline.begin(), baseline.end(),
+            [&result] (const BenchmarkResult &old) {
+                return old.name == result.name;
+            });
+        if (old_result == baseline.end())
+            continue;
+        double speedup = result.states_per_second / old_result->states_per_second;
+        bool slower = speedup < 1 - tolerance;
+        bool larger = old_result->bytes_per_state > 0 &&
+            result.bytes_per_state > old_result->bytes_per_state * (1 + tolerance);
+        cout << result.name << ": " << speedup << "x baseline throughput";
+        if (slower || larger) {
+            cout << " REGRESSION";
+            if (larger)
+                cout << " (" << result.bytes_per_state << " vs. "
+                     << old_result->bytes_per_state << " bytes/state)";
+            ++num_regressions;
+        }
+        cout << endl;
+    }
+    return num_regressions;
+}
+
+int main(int argc, const char **argv) {
+    utils::register_event_handlers();
+    BenchmarkOptions options = parse_arguments(argc, argv);
+
+    ifstream task_file(options.task_filename);
+    if (!task_file) {
+        cerr << "Could not open task " << options.task_filename << endl;
+        utils::exit_with(ExitCode::INPUT_ERROR);
+    }
+    read_everything(task_file);
+    string task_name = get_task_name(options.task_filename);
+
+    vector<BenchmarkResult> results;
+    vector<StateID> states = sample_states(options.num_states, results);
+    benchmark_successor_generation(states, options.repetitions, results);
+    benchmark_state_registry(states, options.repetitions, results);
+    benchmark_state_unpacking(states, options.repetitions, results);
+    benchmark_axioms(states, options.repetitions, results);
+    for (const string &config : options.heuristics)
+        benchmark_heuristic(config, states, results);
+    for (const string &config : options.open_lists)
+        benchmark_open_list(config, states, options.repetitions, results);
+
+    cout << "Benchmark results for " << task_name << ":" << endl;
+    for (const BenchmarkResult &result : results) {
+        cout << result.name << ": " << result.states_per_second << " states/s";
+        if (result.bytes_per_state > 0)
+            cout << ", " << result.bytes_per_state << " bytes/state";
+        cout << endl;
+    }
+
+    if (!options.output_filename.empty())
+        write_results(options.output_filename, task_name, results);
+
+    if (!options.baseline_filename.empty()) {
+        int num_regressions = compare_with_baseline(
+            results, read_results(options.baseline_filename), options.tolerance);
+        if (num_regressions > 0) {
+            cout << num_regressions << " regression(s) compared to "
+                 << options.baseline_filename << endl;
+            return 1;
+        }
+    }
+    return 0;
+}
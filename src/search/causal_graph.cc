@@ -223,3 +223,7 @@ const CausalGraph &get_causal_graph(const AbstractTask *task) {
 
     return *causal_graph_cache[task];
 }
+
+void clear_causal_graph_cache() {
+    causal_graph_cache.clear();
+}
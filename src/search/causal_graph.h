@@ -115,4 +115,8 @@ public:
    with this function, we build at most one causal graph per AbstractTask. */
 extern const CausalGraph &get_causal_graph(const AbstractTask *task);
 
+/* Delete all cached causal graphs. The caller has to make sure that the
+   causal graphs are no longer used. */
+extern void clear_causal_graph_cache();
+
 #endif
@@ -9,7 +9,14 @@ IPCompilation::IPCompilation(const Options &opts, const std::shared_ptr<Abstract
                                                                                                                   opts.get_list<shared_ptr<IPConstraintGenerator>>("ipmodel")), lp_solver(lp::LPSolverType(opts.get_enum("lpsolver")),lp::LPConstraintType(opts.get_enum("lprelaxation"))), task(t) {
     // options here
 }
+
+IPCompilation::IPCompilation(const Options &opts, const IPCompilation &other) : lp_solver(lp::LPSolverType(opts.get_enum("lpsolver")),lp::LPConstraintType(opts.get_enum("lprelaxation"))), task(other.task) {
+    for (auto generator : other.constraint_generators)
+        constraint_generators.push_back(generator->clone());
+}
+
 void IPCompilation::initialize(int t) {
+    horizon = t;
     double infinity = lp_solver.get_infinity();
     vector<vector<int>> * index_opt = new vector<vector<int>>();
     for (auto generator : constraint_generators) {
@@ -24,6 +31,11 @@ void IPCompilation::initialize(int t) {
         generator->initialize_constraints(task, constraints, infinity);
     }
     lp_solver.load_problem(lp::LPObjectiveSense::MINIMIZE, variables, constraints);
+    for (auto generator : constraint_generators)
+        generator->pop_replaced_constraints();
+    num_loaded_variables = variables.size();
+    num_loaded_constraints = constraints.size();
+    incumbent.clear();
 }
 
 ap_float IPCompilation::get_min_action_cost(){
@@ -55,18 +67,48 @@ bool IPCompilation::contains_forget(){
     return false;
 }
 
-ap_float IPCompilation::compute_plan(const int horizon, const double time){
+void IPCompilation::extend_model(){
+    double infinity = lp_solver.get_infinity();
     for (auto generator : constraint_generators) {
-        double infinity = lp_solver.get_infinity();
-        bool dead_end = generator->update_constraints(horizon, lp_solver,task,variables,infinity,constraints);
-        if (dead_end) {
-            lp_solver.clear_temporary_constraints();
-            return -1;
+        for (int index : generator->pop_replaced_constraints()) {
+            constraints[index].set_lower_bound(-infinity);
+            constraints[index].set_upper_bound(infinity);
+            lp_solver.set_constraint_lower_bound(index, -infinity);
+            lp_solver.set_constraint_upper_bound(index, infinity);
         }
     }
+    vector<lp::LPVariable> new_variables(variables.begin() + num_loaded_variables, variables.end());
+    vector<lp::LPConstraint> new_constraints(constraints.begin() + num_loaded_constraints, constraints.end());
+    lp_solver.extend_problem(new_variables, new_constraints);
+    num_loaded_variables = variables.size();
+    num_loaded_constraints = constraints.size();
+}
+
+ap_float IPCompilation::compute_plan(const int horizon, const double time){
+    if (!extend_horizon(horizon))
+        return -1;
     cout << "updating " << horizon << " remaining time " << time << endl;
+    return solve(time);
+}
+
+bool IPCompilation::extend_horizon(const int new_horizon){
+    horizon = new_horizon;
     lp_solver.clear_temporary_constraints();
-    lp_solver.load_problem(lp::LPObjectiveSense::MINIMIZE, variables, constraints);
+    lp_solver.clear_interrupt();
+    bool dead_end = false;
+    for (auto generator : constraint_generators) {
+        double infinity = lp_solver.get_infinity();
+        dead_end |= generator->update_constraints(horizon, lp_solver,task,variables,infinity,constraints);
+    }
+    // Keep the loaded model in sync with the generators even for dead ends.
+    extend_model();
+    lp_solver.clear_temporary_constraints();
+    return !dead_end;
+}
+
+ap_float IPCompilation::solve(const double time){
+    if (!incumbent.empty())
+        lp_solver.set_warm_start(incumbent);
     
     ap_float result;
     lp_solver.set_time_limit(time);
@@ -75,6 +117,7 @@ ap_float IPCompilation::compute_plan(const int horizon, const double time){
         double epsilon = 0.01;
         double objective_value = lp_solver.get_objective_value();
         result = ceil(objective_value - epsilon);
+        incumbent = lp_solver.extract_solution();
     } else {
         result = -1;
     }
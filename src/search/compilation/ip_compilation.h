@@ -14,6 +14,10 @@ namespace ip_compilation{
     /*
         this class create the model and solve one iteration of the ip compilation
         - constraint generator
+        The model is loaded once in initialize(). compute_plan() only appends
+        the variables and constraints of the new time steps to the loaded
+        model and warm starts from the basis and incumbent of the previous
+        horizon.
      */
     enum class ModelType {
         SB, SC, SAS
@@ -24,16 +28,39 @@ namespace ip_compilation{
         lp::LPSolver lp_solver;
     public:
         IPCompilation(const options::Options &opts, const std::shared_ptr<AbstractTask> &task);
+        // Copy the generators of a model that is not initialized yet and use a new LP solver.
+        IPCompilation(const options::Options &opts, const IPCompilation &other);
         ~IPCompilation() {}
         void initialize(int t);
         ap_float get_min_action_cost();
         ap_float compute_plan(const int horizon, const double time);
+        /*
+          compute_plan split in two steps: extend_horizon() adds the time steps
+          up to horizon to the model and returns false for dead ends; solve()
+          can then run in another thread and be aborted with interrupt().
+        */
+        bool extend_horizon(const int horizon);
+        ap_float solve(const double time);
+        void interrupt() {
+            lp_solver.interrupt();
+        }
+        int get_horizon() const {
+            return horizon;
+        }
         bool contains_forget();
         void print_plan();
     protected:
         const std::shared_ptr<AbstractTask> task;
         std::vector<lp::LPVariable> variables;
         std::vector<lp::LPConstraint> constraints;
+        // Number of variables and constraints already loaded into lp_solver.
+        size_t num_loaded_variables = 0;
+        size_t num_loaded_constraints = 0;
+        // Solution of the last horizon that was solved optimally.
+        std::vector<double> incumbent;
+        int horizon = 0;
+        
+        void extend_model();
 
     };
     
@@ -34,5 +34,10 @@ void IPConstraintGenerator::print_solution(vector<double> &solution,const std::s
     cout << "Plan length: " << steps  << " step(s)." << endl;
 }
 
-
-
+void IPConstraintGenerator::replace_constraint(int &index, const lp::LPConstraint &constraint,
+                                               vector<lp::LPConstraint> &constraints){
+    if (index != -1)
+        replaced_constraints.push_back(index);
+    index = constraints.size();
+    constraints.push_back(constraint);
+}
@@ -7,6 +7,12 @@
 namespace operator_counting {
     class IPConstraintGenerator : public ConstraintGenerator {
     public:
+        /*
+          Copy a generator that has not been initialized yet, e.g. to build
+          the same model for another LP solver.
+        */
+        virtual std::shared_ptr<IPConstraintGenerator> clone() const = 0;
+        
         virtual void print_solution(std::vector<double> &solution, const std::shared_ptr<AbstractTask> task);
         
         void set_index_opt(std::vector<std::vector<int>>* io){
@@ -27,12 +33,34 @@ namespace operator_counting {
             t_min = t;
         }
         
+        /*
+          Return the indices of the constraints replaced since the last call.
+          They are already loaded into the LP and have to be disabled there.
+        */
+        std::vector<int> pop_replaced_constraints() {
+            std::vector<int> replaced;
+            replaced.swap(replaced_constraints);
+            return replaced;
+        }
+        
     protected:
         
         std::vector<std::vector<int>> *index_opt;
         int t_max = 0;
         int t_min = 0;
         
+        /*
+          Constraints on the last time step (e.g. the goal) change with the
+          horizon. Since the LP is extended instead of reloaded, they are not
+          overwritten: the new constraint is appended and the old one (if
+          index != -1) is remembered to be disabled. Sets index to the new one.
+        */
+        void replace_constraint(int &index, const lp::LPConstraint &constraint,
+                                std::vector<lp::LPConstraint> &constraints);
+        
+    private:
+        std::vector<int> replaced_constraints;
+        
     };
 }
 #endif
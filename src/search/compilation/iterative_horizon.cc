@@ -8,6 +8,14 @@
 #include "../search_engines/search_common.h"
 #include "ip_compilation.h"
 
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <limits>
+#include <mutex>
+#include <thread>
+
 using namespace std;
 using namespace ip_compilation;
 
@@ -19,6 +27,8 @@ IterativeHorizon::IterativeHorizon(const Options &opts)
 
   const std::shared_ptr<AbstractTask> task(get_task_from_options(opts));
   model = new IPCompilation(opts, task);
+  for (int i = 1; i < opts.get<int>("probes"); ++i)
+    probe_models.emplace_back(new IPCompilation(opts, *model));
 
   //    OptionParser
   //    h_parser("operatorcounting([delete_relaxation_constraints([basic])],CPLEX,lp)",true);
@@ -42,6 +52,10 @@ void IterativeHorizon::initialize() {
   ap_float min_action_cost = model->get_min_action_cost();
   bool forget = model->contains_forget();
   int t = !forget ? initial_t : initial_t * 2;
+  if (!probe_models.empty()) {
+    probe_horizons_concurrently(t, forget, min_action_cost);
+    return;
+  }
   model->initialize(t);
   // iterative method;
   bool solved = false;
@@ -79,12 +93,184 @@ void IterativeHorizon::initialize() {
   cout << "Time: " << timer.get_elapsed_time() << " s" << endl;
 }
 
+void IterativeHorizon::probe_horizons_concurrently(int t, bool forget,
+                                                   ap_float min_action_cost) {
+  struct Probe {
+    IPCompilation *model;
+    thread solver_thread;
+    bool running = false;
+    bool interrupted = false;
+    // Exception of the last solve, e.g. of exit_with.
+    exception_ptr error;
+  };
+  vector<Probe> probes(probe_models.size() + 1);
+  probes[0].model = model;
+  for (size_t i = 0; i < probe_models.size(); ++i)
+    probes[i + 1].model = probe_models[i].get();
+  for (Probe &probe : probes) probe.model->initialize(t);
+
+  mutex finished_mutex;
+  condition_variable finished_condition;
+  // Pairs of probe index and plan cost (-1 if no plan) of finished solves.
+  deque<pair<int, ap_float>> finished;
+
+  // Models are only extended in this thread, only the solves run concurrently.
+  auto launch = [&](int id, int horizon) {
+    Probe &probe = probes[id];
+    bool dead_end = !probe.model->extend_horizon(horizon);
+    double time = timer.get_remaining_time();
+    cout << "probing horizon " << horizon << " remaining time " << time
+         << endl;
+    probe.running = true;
+    probe.interrupted = false;
+    probe.error = nullptr;
+    probe.solver_thread = thread([&, id, dead_end, time]() {
+      ap_float plan_cost = -1;
+      exception_ptr error;
+      try {
+        if (!dead_end) plan_cost = probes[id].model->solve(time);
+      } catch (...) {
+        error = current_exception();
+      }
+      lock_guard<mutex> lock(finished_mutex);
+      probes[id].error = error;
+      finished.emplace_back(id, plan_cost);
+      finished_condition.notify_one();
+    });
+  };
+  auto interrupt = [&](int id) {
+    if (probes[id].running && !probes[id].interrupted) {
+      probes[id].interrupted = true;
+      probes[id].model->interrupt();
+    }
+  };
+  auto stop_all = [&]() {
+    for (size_t id = 0; id < probes.size(); ++id) interrupt(id);
+    for (Probe &probe : probes)
+      if (probe.solver_thread.joinable()) probe.solver_thread.join();
+  };
+  // Assign the horizons of a round in increasing order to the models in
+  // increasing order of their horizon, since models can only grow. A model
+  // is never launched at its current horizon, since extending it to the
+  // same horizon again would add the step constraints a second time.
+  auto start_round = [&](int max_infeasible) {
+    int num_probes = probes.size();
+    vector<int> horizons;
+    for (int i = 1; i < num_probes; ++i) horizons.push_back(max_infeasible + i);
+    horizons.push_back(max(2 * max_infeasible, max_infeasible + num_probes));
+    vector<int> order(num_probes);
+    for (int i = 0; i < num_probes; ++i) order[i] = i;
+    sort(order.begin(), order.end(), [&](int a, int b) {
+      return probes[a].model->get_horizon() < probes[b].model->get_horizon();
+    });
+    for (int i = 0; i < num_probes; ++i)
+      launch(order[i],
+             max(horizons[i], probes[order[i]].model->get_horizon() + 1));
+  };
+
+  // All horizons up to max_infeasible have no plan.
+  int max_infeasible = t;
+  IPCompilation *best_model = nullptr;
+  ap_float best_cost = -1;
+  int best_horizon = 0;
+  // A plan found for this or a larger horizon is optimal.
+  int check_horizon = numeric_limits<int>::max();
+  bool solved = false;
+  int n_iterations = 0;
+  try {
+    start_round(max_infeasible);
+    while (true) {
+      pair<int, ap_float> result;
+      {
+        unique_lock<mutex> lock(finished_mutex);
+        finished_condition.wait(lock, [&]() { return !finished.empty(); });
+        result = finished.front();
+        finished.pop_front();
+      }
+      Probe &probe = probes[result.first];
+      probe.solver_thread.join();
+      probe.running = false;
+      if (probe.error) rethrow_exception(probe.error);
+      n_iterations++;
+      int horizon = probe.model->get_horizon();
+      ap_float plan_cost = result.second;
+      if (!probe.interrupted) {
+        if (plan_cost >= 0 &&
+            (!best_model || plan_cost < best_cost || horizon >= check_horizon)) {
+          best_model = probe.model;
+          best_cost = plan_cost;
+          best_horizon = horizon;
+          double to_check = plan_cost / min_action_cost;
+          if (forget) to_check = to_check * 2;
+          check_horizon = min(check_horizon, static_cast<int>(to_check) + 1);
+          if (plan_cost == initial_t || best_horizon >= check_horizon)
+            solved = true;
+        } else if (plan_cost < 0 && !best_model) {
+          max_infeasible = max(max_infeasible, horizon);
+        }
+      }
+      if (solved) break;
+      if (best_model) {
+        // Solves for smaller horizons cannot find cheaper plans.
+        bool checking = false;
+        for (size_t id = 0; id < probes.size(); ++id) {
+          if (!probes[id].running) continue;
+          if (probes[id].model->get_horizon() < check_horizon)
+            interrupt(id);
+          else
+            checking = true;
+        }
+        if (!checking) {
+          if (timer.is_expired()) break;
+          int check_id = -1;
+          for (size_t id = 0; id < probes.size(); ++id) {
+            if (probes[id].running ||
+                probes[id].model->get_horizon() >= check_horizon)
+              continue;
+            // Keep the solution of the best model unless it is the only one.
+            if (check_id == -1 || probes[check_id].model == best_model)
+              check_id = id;
+          }
+          if (check_id != -1) {
+            cout << "optimality check " << check_horizon << endl;
+            launch(check_id, check_horizon);
+          } else if (none_of(probes.begin(), probes.end(),
+                             [](const Probe &p) { return p.running; })) {
+            break;
+          }
+          // Otherwise wait until an interrupted solve has stopped.
+        }
+      } else if (none_of(probes.begin(), probes.end(),
+                         [](const Probe &p) { return p.running; })) {
+        if (timer.is_expired()) break;
+        start_round(max_infeasible);
+      }
+    }
+  } catch (...) {
+    // Stop the other solves before the exception ends the search.
+    stop_all();
+    throw;
+  }
+  stop_all();
+
+  if (solved) best_model->print_plan();
+  cout << "Best plan cost found: " << best_cost << " at horizon "
+       << best_horizon << endl;
+  cout << "Iterations: " << n_iterations << endl;
+  cout << "Time: " << timer.get_elapsed_time() << " s" << endl;
+}
+
 static SearchEngine *_parse(OptionParser &parser) {
   parser.document_synopsis("ip compilation", "");
   ip_compilation::add_model_option_to_parser(parser);
   lp::add_lp_solver_option_to_parser(parser);
   lp::add_lp_constraint_option_to_parser(parser);
   parser.add_option<ScalarEvaluator *>("eval", "evaluator for h-value");
+  parser.add_option<int>(
+      "probes",
+      "number of horizons that are solved concurrently, each with its own "
+      "LP solver (1 for solving one horizon after the other)",
+      "1", Bounds("1", "infinity"));
   parser.add_option<shared_ptr<AbstractTask>>(
       "transform",
       "Optional task transformation for the heuristic. "
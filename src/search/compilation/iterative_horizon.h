@@ -9,6 +9,9 @@
 #include "ip_compilation.h"
 #include "../utils/countdown_timer.h"
 
+#include <memory>
+#include <vector>
+
 
 namespace options {
     class Options;
@@ -23,6 +26,16 @@ namespace ip_compilation{
         virtual void initialize() override;
         virtual SearchStatus step() override {};
         int initial_t;
+        // Additional models, each with its own LP solver, for probing several horizons at once.
+        std::vector<std::unique_ptr<IPCompilation>> probe_models;
+        /*
+          Solve one horizon per model concurrently: the next horizons after
+          the largest one known to be infeasible and a probe at twice that
+          horizon. As soon as a plan is found, the solves that cannot improve
+          on it or prove it optimal are interrupted and the optimality check
+          is started on a free model. All solves share the remaining time.
+        */
+        void probe_horizons_concurrently(int t, bool forget, ap_float min_action_cost);
     public:
         explicit IterativeHorizon(const options::Options &opts);
         virtual ~IterativeHorizon() override;
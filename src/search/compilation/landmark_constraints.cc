@@ -62,12 +62,7 @@ void LandmarkConstraints::landmark_constraints(const std::shared_ptr<AbstractTas
         for (int t = 0; t < t_max; ++t){
             constraint.insert((*index_opt)[op_id][t], 1.);
         }
-        if (landmark_constraints_index[id] == -1){
-            landmark_constraints_index[id]= constraints.size();
-            constraints.push_back(constraint);
-        }else{
-            constraints[landmark_constraints_index[id]] = constraint;
-        }
+        replace_constraint(landmark_constraints_index[id], constraint, constraints);
         ++id;
     }
 }
@@ -40,6 +40,9 @@ namespace operator_counting {
         std::set<int> action_landmarks;
         std::vector<int> landmark_constraints_index;
  public:
+        virtual std::shared_ptr<IPConstraintGenerator> clone() const override {
+            return std::make_shared<LandmarkConstraints>(*this);
+        }
         void print_solution(std::vector<double> &solution, const std::shared_ptr<AbstractTask> task){ };
     };
 }
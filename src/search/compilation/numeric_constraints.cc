@@ -230,8 +230,7 @@ void NumericConstraints::goal_state_constraint(
     const std::shared_ptr<AbstractTask> task,
     std::vector<lp::LPConstraint> &constraints, double infinity, int t_max) {
   TaskProxy task_proxy(*task);
-  static bool first = goal_index.empty();
-  if (first) {
+  if (goal_index.empty()) {
     int n_goals = 0;
     for (size_t id_goal = 0; id_goal < numeric_task.get_n_numeric_goals();
          ++id_goal) {
@@ -260,17 +259,11 @@ void NumericConstraints::goal_state_constraint(
         constraint.insert(index_numeric_var[n_id][t_max - 1], coefficient);
       }
       if (!constraint.empty()) {
-        if (first) {
-          goal_index[i_goal] = constraints.size();
-          constraints.push_back(constraint);
-        } else {
-          constraints[goal_index[i_goal]] = constraint;
-        }
+        replace_constraint(goal_index[i_goal], constraint, constraints);
       }
       i_goal++;
     }
   }
-  if (first) first = false;
 }
 
 void NumericConstraints::initialize_numeric_mutex() {
@@ -63,6 +63,9 @@ class NumericConstraints : public IPConstraintGenerator {
                      int t_min, int t_max);
 
  public:
+  virtual std::shared_ptr<IPConstraintGenerator> clone() const override {
+    return std::make_shared<NumericConstraints>(*this);
+  }
   void print_solution(std::vector<double> &solution,
                       const std::shared_ptr<AbstractTask> task){};
 };
@@ -225,8 +225,7 @@ void SASStateChangeModel::goal_state_constraint(
     std::vector<lp::LPConstraint> &constraints, int t_max) {
   TaskProxy task_proxy(*task);
   VariablesProxy vars = task_proxy.get_variables();
-  bool first = goal_index.empty();
-  if (first) goal_index.assign(task_proxy.get_goals().size(), -1);
+  if (goal_index.empty()) goal_index.assign(task_proxy.get_goals().size(), -1);
   for (size_t id_goal = 0; id_goal < task_proxy.get_goals().size(); ++id_goal) {
     FactProxy goal = task_proxy.get_goals()[id_goal];
     lp::LPConstraint constraint(1., 1.);
@@ -240,12 +239,7 @@ void SASStateChangeModel::goal_state_constraint(
     if (!numeric_task.numeric_goals_empty(id_goal))
       continue;  // this is a numeric goal
     if (!constraint.empty()) {
-      if (first) {
-        goal_index[id_goal] = constraints.size();
-        constraints.push_back(constraint);
-      } else {
-        constraints[goal_index[id_goal]] = constraint;
-      }
+      replace_constraint(goal_index[id_goal], constraint, constraints);
     }
   }
 }
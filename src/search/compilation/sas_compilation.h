@@ -66,6 +66,9 @@ class SASStateChangeModel : public IPConstraintGenerator {
                                     double infinity, int t_min, int t_max);
 
  public:
+  virtual std::shared_ptr<IPConstraintGenerator> clone() const override {
+    return std::make_shared<SASStateChangeModel>(*this);
+  }
   // void print_solution(std::vector<double> &solution, const
   // std::shared_ptr<AbstractTask> task);
 };
@@ -56,6 +56,9 @@ namespace operator_counting {
                            std::vector<lp::LPVariable> &variables,
                            double infinity, int t_min, int t_max);
     public:
+        virtual std::shared_ptr<IPConstraintGenerator> clone() const override {
+            return std::make_shared<StateBasedModel>(*this);
+        }
         //void print_solution(std::vector<double> &solution, const std::shared_ptr<AbstractTask> task);
     };
 }
@@ -230,8 +230,7 @@ void StateChangeModel::goal_state_constraint(const std::shared_ptr<AbstractTask>
                                             std::vector<lp::LPConstraint> &constraints,
                                             int t_max) {
     TaskProxy task_proxy(*task);
-    bool first = goal_index.empty();
-    if (first)
+    if (goal_index.empty())
         goal_index.assign(task_proxy.get_goals().size(),-1);
     for (size_t id_goal = 0; id_goal < task_proxy.get_goals().size(); ++id_goal) {
         FactProxy goal = task_proxy.get_goals()[id_goal];
@@ -243,12 +242,7 @@ void StateChangeModel::goal_state_constraint(const std::shared_ptr<AbstractTask>
         constraint.insert(index_mant[index_p][t_max-1], 1.);
         if (!numeric_task.numeric_goals_empty(id_goal)) continue; // this is a numeric goal
         if (!constraint.empty()) {
-            if (first){
-                goal_index[id_goal]= constraints.size();
-                constraints.push_back(constraint);
-            }else{
-                constraints[goal_index[id_goal]] = constraint;
-            }
+            replace_constraint(goal_index[id_goal], constraint, constraints);
         }
     }
 }
@@ -88,6 +88,7 @@ void GlobalOperator::read_pre_post(istream &in) {
 
 GlobalOperator::GlobalOperator(istream &in, bool axiom) {
     marked = false;
+    has_packed_masks = false;
 
     is_an_axiom = axiom;
     if (!is_an_axiom) {
@@ -175,6 +176,82 @@ void GlobalOperator::dump() const {
     cout << " (" << cost << ")" << endl;
 }
 
+static void add_to_bin_masks(
+    vector<PackedBinMask> &bin_masks, const IntPacker &packer,
+    int var, container_int val) {
+    int bin = packer.get_bin_index(var);
+    auto it = find_if(bin_masks.begin(), bin_masks.end(),
+                      [bin](const PackedBinMask &bin_mask) {
+                          return bin_mask.bin == bin;
+                      });
+    if (it == bin_masks.end()) {
+        bin_masks.push_back(PackedBinMask {bin, 0, 0});
+        it = bin_masks.end() - 1;
+    }
+    // A later value for the same variable replaces the earlier one.
+    PackedStateBin var_mask = packer.get_bin_mask(var);
+    it->mask |= var_mask;
+    it->value = (it->value & ~var_mask) | packer.get_bin_value(var, val);
+}
+
+void GlobalOperator::compile_packed_masks(const IntPacker &packer) {
+    packed_preconditions.clear();
+    packed_effects.clear();
+    unpacked_effect_ids.clear();
+    vector<int> precondition_values(g_variable_domain.size(), -1);
+    for (const GlobalCondition &precondition : preconditions) {
+        int &value = precondition_values[precondition.var];
+        if (value != -1 && value != static_cast<int>(precondition.val)) {
+            // Contradicting preconditions: use a mask that no state satisfies.
+            packed_preconditions.assign(1, PackedBinMask {0, 0, 1});
+            break;
+        }
+        value = precondition.val;
+        add_to_bin_masks(packed_preconditions, packer,
+                         precondition.var, precondition.val);
+    }
+
+    /*
+      Unconditional effects are combined into one mask per bin, which is
+      applied before the conditional effects. This is only correct if no
+      conditional effect sets a variable that an unconditional effect sets
+      as well, since then the order of the effects matters.
+    */
+    vector<bool> set_conditionally(g_variable_domain.size(), false);
+    for (const GlobalEffect &effect : effects) {
+        if (!effect.conditions.empty())
+            set_conditionally[effect.var] = true;
+    }
+    for (size_t i = 0; i < effects.size(); ++i) {
+        const GlobalEffect &effect = effects[i];
+        if (effect.conditions.empty() && !set_conditionally[effect.var])
+            add_to_bin_masks(packed_effects, packer, effect.var, effect.val);
+        else
+            unpacked_effect_ids.push_back(i);
+    }
+    has_packed_masks = true;
+}
+
+void GlobalOperator::apply_effects(
+    const GlobalState &predecessor, PackedStateBin *buffer) const {
+    if (!has_packed_masks) {
+        for (const GlobalEffect &effect : effects) {
+            if (effect.does_fire(predecessor))
+                g_state_packer->set(buffer, effect.var, effect.val);
+        }
+        return;
+    }
+    for (const PackedBinMask &effect : packed_effects) {
+        PackedStateBin &bin = buffer[effect.bin];
+        bin = (bin & ~effect.mask) | effect.value;
+    }
+    for (int effect_id : unpacked_effect_ids) {
+        const GlobalEffect &effect = effects[effect_id];
+        if (effect.does_fire(predecessor))
+            g_state_packer->set(buffer, effect.var, effect.val);
+    }
+}
+
 void GlobalOperator::set_cost(ap_float init_cost) {
 //	if(DEBUG) cout << "Recomputing cost of operator " << name << endl;
 	ap_float old_cost = cost;
@@ -193,6 +270,7 @@ GlobalOperator::GlobalOperator(PropositionalAxiom convert_from_axiom) :
 		is_an_axiom(true),
 		preconditions(convert_from_axiom.conditions),
 		effects(convert_from_axiom.effects),
+		has_packed_masks(false),
 		assign_effects(vector<AssignEffect>()),
 		name("OpLogicAxiom"),
 		cost(0),
@@ -57,10 +57,31 @@ struct AssignEffect {
 	void dump() const;
 };
 
+/*
+  Condition or assignment for the variables of one bin of a packed state:
+  a state satisfies it if (buffer[bin] & mask) == value, and it is applied
+  with buffer[bin] = (buffer[bin] & ~mask) | value.
+*/
+struct PackedBinMask {
+    int bin;
+    PackedStateBin mask;
+    PackedStateBin value;
+};
+
 class GlobalOperator {
     bool is_an_axiom;
     std::vector<GlobalCondition> preconditions;
     std::vector<GlobalEffect> effects;
+    /*
+      Preconditions and unconditional effects compiled to one mask per bin
+      of the packed state (see compile_packed_masks). Effects that cannot
+      be applied in this way are listed in unpacked_effect_ids, in their
+      original order.
+    */
+    bool has_packed_masks;
+    std::vector<PackedBinMask> packed_preconditions;
+    std::vector<PackedBinMask> packed_effects;
+    std::vector<int> unpacked_effect_ids;
     std::vector<AssignEffect> assign_effects;
 //    std::vector<AssignEffect> instrumentation_effects;
     std::string name;
@@ -81,12 +102,33 @@ public:
   //  const std::vector<AssignEffect> &get_instrumentation_effects() const {return instrumentation_effects; }
 
     bool is_applicable(const GlobalState &state) const {
+        if (has_packed_masks) {
+            const PackedStateBin *buffer = state.get_packed_buffer();
+            for (const PackedBinMask &condition : packed_preconditions)
+                if ((buffer[condition.bin] & condition.mask) != condition.value)
+                    return false;
+            return true;
+        }
         for (size_t i = 0; i < preconditions.size(); ++i)
             if (!preconditions[i].is_applicable(state))
                 return false;
         return true;
     }
 
+    /*
+      Computes the masks for is_applicable and apply_effects. This must be
+      done after g_state_packer has been created and before the
+      preconditions or effects are modified.
+    */
+    void compile_packed_masks(const IntPacker &packer);
+
+    /*
+      Sets the propositional effects that fire in predecessor in buffer,
+      which must contain a copy of predecessor.
+    */
+    void apply_effects(const GlobalState &predecessor,
+                       PackedStateBin *buffer) const;
+
     bool is_marked() const {
         return marked;
     }
@@ -27,6 +27,13 @@ container_int GlobalState::operator[](size_t index) const {
     return g_state_packer->get(buffer, index);
 }
 
+vector<int> GlobalState::get_values() const {
+    int num_vars = g_variable_domain.size();
+    vector<int> values(num_vars);
+    g_state_packer->unpack_all(buffer, values.data(), num_vars);
+    return values;
+}
+
 bool GlobalState::same_values(const GlobalState &state) const {
     for (size_t i = 0; i < g_variable_domain.size(); ++i) {
         if (this->operator[](i) != state[i]) return false;
@@ -11,14 +11,25 @@
 class GlobalOperator;
 class StateRegistry;
 
+namespace external_search {
+class ExternalSearch;
+}
+
+namespace utils {
+class SearchTraceWriter;
+}
+
 typedef IntPacker::Bin PackedStateBin;
 
 // For documentation on classes relevant to storing and working with registered
 // states see the file state_registry.h.
 class GlobalState {
     friend class StateRegistry;
-    template<typename Entry>
-    friend class PerStateInformation;
+    friend class GlobalOperator;
+    template<typename Element>
+    friend class PerStateStorage;
+    friend class utils::SearchTraceWriter;
+    friend class external_search::ExternalSearch;
     // Values for vars are maintained in a packed state and accessed on demand.
     const PackedStateBin *buffer;
     // registry isn't a reference because we want to support operator=
@@ -47,6 +58,9 @@ public:
 
     container_int operator[](std::size_t index) const;
 
+    // Values of all propositional variables, unpacked in one pass.
+    std::vector<int> get_values() const;
+
     bool same_values(const GlobalState &state) const;
 
     bool same_values(const std::vector<container_int> &values, const std::vector<ap_float> &numeric_values) const;
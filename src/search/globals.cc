@@ -8,7 +8,7 @@
 #include "int_packer.h"
 #include "state_registry.h"
 #include "successor_generator.h"
-#include "per_state_information.h" // instrumentation variables are stored as PSI
+#include "per_state_array.h" // instrumentation variables are stored as PerStateArray
 
 #include "tasks/root_task.h"
 
@@ -388,6 +388,7 @@ void read_everything(istream &in) {
     	if (type == instrumentation) ++instrumentation_vars;
     }
     if (DEBUG) cout << "Task has " << numeric_constants << " numeric constants and " << instrumentation_vars << " instrumentation variables." << endl;
+    g_cost_information.set_default_array(vector<ap_float>(instrumentation_vars, 0));
     /*
 	 The state packer's bin size is either 32 bit or 64 bit.
 	 Note that in order to have 64 bit precision floats a.k.a "double"
@@ -418,6 +419,7 @@ void read_everything(istream &in) {
     if(DEBUG) cout << "Cost of initial state is " << init_cost << endl; // usually 0.0
 
     for (auto &op : g_operators) {
+    	op.compile_packed_masks(*g_state_packer);
     	op.set_cost(init_cost); // has to be done after the g_state_registry has been created
     	g_min_action_cost = min(g_min_action_cost, op.get_cost());
     	g_max_action_cost = max(g_max_action_cost, op.get_cost());
@@ -437,6 +439,60 @@ void read_everything(istream &in) {
     if (PLAN_VIS_LOG != 0) g_plan_logger = new utils::PlanVisLogger();
 }
 
+/*
+  All users share one root task, so that objects cached per task (e.g.
+  causal graphs and relaxed tasks) are only built once. Every task read
+  gets a new root task. Caches keyed by the address of the task are
+  cleared or only hold entries of live tasks when a task is released, so
+  that they never mistake a new task for an old one.
+*/
+static shared_ptr<AbstractTask> &get_root_task_pointer() {
+    static shared_ptr<AbstractTask> root_task = make_shared<tasks::RootTask>();
+    return root_task;
+}
+
+void release_everything() {
+    delete g_plan_logger;
+    g_plan_logger = 0;
+    delete g_successor_generator;
+    g_successor_generator = 0;
+    // Also removes the data of all PerStateInformation objects for its states.
+    delete g_state_registry;
+    g_state_registry = 0;
+    delete g_state_packer;
+    g_state_packer = 0;
+    delete g_axiom_evaluator;
+    g_axiom_evaluator = 0;
+    g_symmetry_graph = nullptr;
+
+    g_variable_name.clear();
+    g_variable_domain.clear();
+    g_fact_names.clear();
+    g_axiom_layers.clear();
+    g_default_axiom_values.clear();
+    g_numeric_axiom_layers.clear();
+    g_numeric_var_names.clear();
+    g_numeric_var_types.clear();
+    g_inconsistent_facts.clear();
+    g_mutex_group.clear();
+    g_initial_state_data.clear();
+    g_initial_state_numeric.clear();
+    g_goal.clear();
+    g_operators.clear();
+    g_logic_axioms.clear();
+    g_axioms_as_operator.clear();
+    g_comp_axioms.clear();
+    g_ass_axioms.clear();
+    g_min_action_cost = numeric_limits<ap_float>::max();
+    g_max_action_cost = 0;
+    g_num_previously_generated_plans = 0;
+    g_is_part_of_anytime_portfolio = false;
+    g_plan_filename = "sas_plan";
+
+    g_rng()->seed(2011);
+    clear_causal_graph_cache();
+    get_root_task_pointer() = make_shared<tasks::RootTask>();
+}
 
 void dump_variable(size_t variable_id) {
 	cout << g_variable_name[variable_id] << " {" << g_fact_names[variable_id][0];
@@ -539,9 +595,9 @@ const GlobalState &g_initial_state() {
     return g_state_registry->get_initial_state();
 }
 
+
 const shared_ptr<AbstractTask> g_root_task() {
-    const shared_ptr<AbstractTask> root_task = make_shared<tasks::RootTask>();
-    return root_task;//extra_tasks::create_resource_task(root_task);
+    return get_root_task_pointer();//extra_tasks::create_resource_task(root_task);
 }
 
 shared_ptr<utils::RandomNumberGenerator> g_rng() {
@@ -588,11 +644,12 @@ string g_plan_filename = "sas_plan";
 int g_num_previously_generated_plans = 0;
 bool g_is_part_of_anytime_portfolio = false;
 StateRegistry *g_state_registry = 0;
-PerStateInformation<std::vector<ap_float> > g_cost_information;
+PerStateArray<ap_float> g_cost_information;
 
 //TODO: the loggers should be managed in the same class
 utils::Log g_log;
 utils::PlanVisLogger *g_plan_logger = 0;
+utils::SearchTraceWriter *g_search_trace = 0;
 
 
 istream& operator>>(istream &is, cal_operator &cop) {
@@ -31,9 +31,10 @@ namespace utils {
 struct Log;
 class PlanVisLogger;
 class RandomNumberGenerator;
+class SearchTraceWriter;
 }
 
-template<class Entry> class PerStateInformation;
+template<class T> class PerStateArray;
 
 // TODO: the encoding size of floats has to be determined by command line
 // a container_int has to be an integer variable with the same encoding size as ap_float
@@ -63,6 +64,13 @@ ap_float calculate_plan_cost(const std::vector<const GlobalOperator *> &plan);
 
 
 void read_everything(std::istream &in);
+/*
+  Frees everything built by read_everything and resets the global task data,
+  so that read_everything can read another task (used by the planner
+  service). Objects that still refer to the old task must not be used
+  afterwards.
+*/
+void release_everything();
 void dump_variable(size_t variable_id);
 void dump_everything();
 
@@ -167,8 +175,10 @@ extern std::shared_ptr<utils::RandomNumberGenerator> g_rng();
 // for each problem in this case the method GlobalState::get_id would also have to be
 // changed.
 extern StateRegistry *g_state_registry;
-extern PerStateInformation<std::vector<ap_float>> g_cost_information;
+extern PerStateArray<ap_float> g_cost_information;
 extern utils::PlanVisLogger *g_plan_logger;
+// Binary search trace, only set if --search-trace is given.
+extern utils::SearchTraceWriter *g_search_trace;
 extern int g_last_arithmetic_axiom_layer;
 extern int g_comparison_axiom_layer;
 extern int g_first_logic_axiom_layer;
@@ -10,7 +10,9 @@
 
 #include "tasks/cost_adapted_task.h"
 #include "numeric_operator_counting/numeric_helper.h"
+#include "utils/profiler.h"
 
+#include <algorithm>
 #include <cassert>
 #include <cstdlib>
 #include <limits>
@@ -20,6 +22,7 @@ using namespace std;
 Heuristic::Heuristic(const Options &opts)
     : description(opts.get_unparsed_config()),
       initialized(false),
+      profile_node(nullptr),
       multiplicator(0),
       heuristic_cache(HEntry(NO_VALUE_INT, true)), //TODO: is true really a good idea here?
       cache_h_values(opts.get<bool>("cache_estimates")),
@@ -109,6 +112,10 @@ EvaluationResult Heuristic::compute_result(EvaluationContext &eval_context) {
     if (!initialized) {
         initialize();
         initialized = true;
+        // A '/' in the description would start a new level of the profile.
+        string node_name = description;
+        replace(node_name.begin(), node_name.end(), '/', '_');
+        profile_node = &utils::get_profile_node("search/heuristics/" + node_name);
     }
 
     assert(preferred_operators.empty());
@@ -123,6 +130,7 @@ EvaluationResult Heuristic::compute_result(EvaluationContext &eval_context) {
         heuristic = heuristic_cache[state].h;
         result.set_count_evaluation(false);
     } else {
+        utils::ProfileScope profile_scope(*profile_node);
         heuristic = compute_heuristic(state);
         if (cache_h_values) {
             heuristic_cache[state] = HEntry(heuristic, false);
@@ -19,6 +19,10 @@ class OptionParser;
 class Options;
 }
 
+namespace utils {
+class ProfileNode;
+}
+
 class Heuristic : public ScalarEvaluator {
     struct HEntry {
         int h : 31;
@@ -28,6 +32,8 @@ class Heuristic : public ScalarEvaluator {
 
     std::string description;
     bool initialized;
+    // Created on first use, when the profiler has been configured.
+    utils::ProfileNode *profile_node;
 
     /*
       TODO: We might want to get rid of the preferred_operators
@@ -43,69 +43,73 @@ void AdditiveHeuristic::initialize() {
 void AdditiveHeuristic::setup_exploration_queue() {
     queue.clear();
 
-    for (size_t var = 0; var < propositions.size(); ++var) {
-        for (size_t value = 0; value < propositions[var].size(); ++value) {
-            Proposition &prop = propositions[var][value];
-            prop.cost = -1;
-            prop.marked = false;
-        }
+    for (PropositionData &data : proposition_data) {
+        data.cost = -1;
+        data.marked = false;
     }
 
     // Deal with operators and axioms without preconditions.
+    const vector<UnaryOperator> &unary_operators =
+        relaxed_task->get_unary_operators();
     for (size_t i = 0; i < unary_operators.size(); ++i) {
-        UnaryOperator &op = unary_operators[i];
-        op.unsatisfied_preconditions = op.precondition.size();
-        op.cost = op.base_cost; // will be increased by precondition costs
+        const UnaryOperator &op = unary_operators[i];
+        UnaryOperatorData &data = operator_data[i];
+        data.unsatisfied_preconditions = op.num_preconditions;
+        data.cost = op.base_cost; // will be increased by precondition costs
 
-        if (op.unsatisfied_preconditions == 0)
-            enqueue_if_necessary(op.effect, op.base_cost, &op);
+        if (data.unsatisfied_preconditions == 0)
+            enqueue_if_necessary(op.effect, op.base_cost, i);
     }
 }
 
 void AdditiveHeuristic::setup_exploration_queue_state(const State &state) {
     for (FactProxy fact : state) {
-        Proposition *init_prop = get_proposition(fact);
-        enqueue_if_necessary(init_prop, 0, 0);
+        PropID init_prop = get_proposition(fact);
+        enqueue_if_necessary(init_prop, 0, NO_OP);
     }
 }
 
 void AdditiveHeuristic::relaxed_exploration() {
-    int unsolved_goals = goal_propositions.size();
+    const vector<UnaryOperator> &unary_operators =
+        relaxed_task->get_unary_operators();
+    int unsolved_goals = relaxed_task->get_goal_propositions().size();
     while (!queue.empty()) {
-        pair<int, Proposition *> top_pair = queue.pop();
+        pair<int, PropID> top_pair = queue.pop();
         int distance = top_pair.first;
-        Proposition *prop = top_pair.second;
-        ap_float prop_cost = prop->cost;
+        PropID prop = top_pair.second;
+        ap_float prop_cost = proposition_data[prop].cost;
         assert(prop_cost >= 0);
         assert(prop_cost <= distance);
         if (prop_cost < distance)
             continue;
-        if (prop->is_goal && --unsolved_goals == 0)
+        if (relaxed_task->is_goal(prop) && --unsolved_goals == 0)
             return;
-        const vector<UnaryOperator *> &triggered_operators =
-            prop->precondition_of;
-        for (size_t i = 0; i < triggered_operators.size(); ++i) {
-            UnaryOperator *unary_op = triggered_operators[i];
-            increase_cost(unary_op->cost, prop_cost);
-            --unary_op->unsatisfied_preconditions;
-            assert(unary_op->unsatisfied_preconditions >= 0);
-            if (unary_op->unsatisfied_preconditions == 0)
-                enqueue_if_necessary(unary_op->effect,
-                                     unary_op->cost, unary_op);
+        for (OpID op_id : relaxed_task->get_precondition_of(prop)) {
+            UnaryOperatorData &data = operator_data[op_id];
+            increase_cost(data.cost, prop_cost);
+            --data.unsatisfied_preconditions;
+            assert(data.unsatisfied_preconditions >= 0);
+            if (data.unsatisfied_preconditions == 0)
+                enqueue_if_necessary(unary_operators[op_id].effect,
+                                     data.cost, op_id);
         }
     }
 }
 
 void AdditiveHeuristic::mark_preferred_operators(
-    const State &state, Proposition *goal) {
-    if (!goal->marked) { // Only consider each subgoal once.
-        goal->marked = true;
-        UnaryOperator *unary_op = goal->reached_by;
-        if (unary_op) { // We have not yet chained back to a start node.
-            for (size_t i = 0; i < unary_op->precondition.size(); ++i)
-                mark_preferred_operators(state, unary_op->precondition[i]);
-            int operator_no = unary_op->operator_no;
-            if (unary_op->cost == unary_op->base_cost && operator_no != -1) {
+    const State &state, PropID goal) {
+    PropositionData &goal_data = proposition_data[goal];
+    if (!goal_data.marked) { // Only consider each subgoal once.
+        goal_data.marked = true;
+        OpID op_id = goal_data.reached_by;
+        if (op_id != NO_OP) { // We have not yet chained back to a start node.
+            const UnaryOperator &unary_op =
+                relaxed_task->get_unary_operators()[op_id];
+            for (PropID precondition : relaxed_task->get_preconditions(unary_op))
+                mark_preferred_operators(state, precondition);
+            int operator_no = unary_op.operator_no;
+            if (operator_data[op_id].cost == unary_op.base_cost &&
+                operator_no != -1) {
                 // Necessary condition for this being a preferred
                 // operator, which we use as a quick test before the
                 // more expensive applicability test.
@@ -125,8 +129,8 @@ ap_float AdditiveHeuristic::compute_add_and_ff(const State &state) {
     relaxed_exploration();
 
     ap_float total_cost = 0;
-    for (size_t i = 0; i < goal_propositions.size(); ++i) {
-        int prop_cost = goal_propositions[i]->cost;
+    for (PropID goal : relaxed_task->get_goal_propositions()) {
+        int prop_cost = proposition_data[goal].cost;
         if (prop_cost == -1)
             return DEAD_END;
         increase_cost(total_cost, prop_cost);
@@ -137,8 +141,8 @@ ap_float AdditiveHeuristic::compute_add_and_ff(const State &state) {
 ap_float AdditiveHeuristic::compute_heuristic(const State &state) {
     ap_float h = compute_add_and_ff(state);
     if (h != DEAD_END) {
-        for (size_t i = 0; i < goal_propositions.size(); ++i)
-            mark_preferred_operators(state, goal_propositions[i]);
+        for (PropID goal : relaxed_task->get_goal_propositions())
+            mark_preferred_operators(state, goal);
     }
     return h;
 }
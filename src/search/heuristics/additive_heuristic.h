@@ -5,15 +5,17 @@
 
 #include "../priority_queue.h"
 
-#include "../utils/collections.h"
-
 #include <cassert>
 
 class State;
 
 namespace additive_heuristic {
-using relaxation_heuristic::Proposition;
+using relaxation_heuristic::NO_OP;
+using relaxation_heuristic::OpID;
+using relaxation_heuristic::PropID;
+using relaxation_heuristic::PropositionData;
 using relaxation_heuristic::UnaryOperator;
+using relaxation_heuristic::UnaryOperatorData;
 
 class AdditiveHeuristic : public relaxation_heuristic::RelaxationHeuristic {
     /* Costs larger than MAX_COST_VALUE are clamped to max_value. The
@@ -25,22 +27,23 @@ class AdditiveHeuristic : public relaxation_heuristic::RelaxationHeuristic {
      */
     static constexpr ap_float MAX_COST_VALUE = 100000000;
 
-    AdaptiveQueue<Proposition *> queue;
+    AdaptiveQueue<PropID> queue;
     bool did_write_overflow_warning;
 
     void setup_exploration_queue();
     void setup_exploration_queue_state(const State &state);
     void relaxed_exploration();
-    void mark_preferred_operators(const State &state, Proposition *goal);
+    void mark_preferred_operators(const State &state, PropID goal);
 
-    void enqueue_if_necessary(Proposition *prop, ap_float cost, UnaryOperator *op) {
+    void enqueue_if_necessary(PropID prop, ap_float cost, OpID op) {
         assert(cost >= 0);
-        if (prop->cost == -1 || prop->cost > cost) {
-            prop->cost = cost;
-            prop->reached_by = op;
+        PropositionData &data = proposition_data[prop];
+        if (data.cost == -1 || data.cost > cost) {
+            data.cost = cost;
+            data.reached_by = op;
             queue.push(cost, prop);
         }
-        assert(prop->cost != -1 && prop->cost <= cost);
+        assert(data.cost != -1 && data.cost <= cost);
     }
 
     void increase_cost(ap_float &cost, ap_float amount) {
@@ -75,9 +78,7 @@ public:
     void initialize_and_compute_heuristic_for_cegar(const State &state);
 
     int get_cost_for_cegar(int var, int value) const {
-        assert(utils::in_bounds(var, propositions));
-        assert(utils::in_bounds(value, propositions[var]));
-        return propositions[var][value].cost;
+        return proposition_data[relaxed_task->get_proposition(var, value)].cost;
     }
 };
 }
@@ -25,20 +25,22 @@ void FFHeuristic::initialize() {
 }
 
 void FFHeuristic::mark_preferred_operators_and_relaxed_plan(
-    const State &state, Proposition *goal) {
-    if (!goal->marked) { // Only consider each subgoal once.
-        goal->marked = true;
-        UnaryOperator *unary_op = goal->reached_by;
-        if (unary_op) { // We have not yet chained back to a start node.
-            for (size_t i = 0; i < unary_op->precondition.size(); ++i)
-                mark_preferred_operators_and_relaxed_plan(
-                    state, unary_op->precondition[i]);
-            int operator_no = unary_op->operator_no;
+    const State &state, PropID goal) {
+    PropositionData &goal_data = proposition_data[goal];
+    if (!goal_data.marked) { // Only consider each subgoal once.
+        goal_data.marked = true;
+        OpID op_id = goal_data.reached_by;
+        if (op_id != NO_OP) { // We have not yet chained back to a start node.
+            const UnaryOperator &unary_op =
+                relaxed_task->get_unary_operators()[op_id];
+            for (PropID precondition : relaxed_task->get_preconditions(unary_op))
+                mark_preferred_operators_and_relaxed_plan(state, precondition);
+            int operator_no = unary_op.operator_no;
             if (operator_no != -1) {
                 // This is not an axiom.
                 relaxed_plan[operator_no] = true;
 
-                if (unary_op->cost == unary_op->base_cost) {
+                if (operator_data[op_id].cost == unary_op.base_cost) {
                     // This test is implied by the next but cheaper,
                     // so we perform it to save work.
                     // If we had no 0-cost operators and axioms to worry
@@ -59,8 +61,8 @@ ap_float FFHeuristic::compute_heuristic(const GlobalState &global_state) {
         return h_add;
 
     // Collecting the relaxed plan also sets the preferred operators.
-    for (size_t i = 0; i < goal_propositions.size(); ++i)
-        mark_preferred_operators_and_relaxed_plan(state, goal_propositions[i]);
+    for (PropID goal : relaxed_task->get_goal_propositions())
+        mark_preferred_operators_and_relaxed_plan(state, goal);
 
     int h_ff = 0;
     for (size_t op_no = 0; op_no < relaxed_plan.size(); ++op_no) {
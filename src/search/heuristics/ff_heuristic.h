@@ -6,8 +6,11 @@
 #include <vector>
 
 namespace ff_heuristic {
-using Proposition = relaxation_heuristic::Proposition;
-using UnaryOperator = relaxation_heuristic::UnaryOperator;
+using relaxation_heuristic::NO_OP;
+using relaxation_heuristic::OpID;
+using relaxation_heuristic::PropID;
+using relaxation_heuristic::PropositionData;
+using relaxation_heuristic::UnaryOperator;
 
 /*
   TODO: In a better world, this should not derive from
@@ -23,7 +26,7 @@ class FFHeuristic : public additive_heuristic::AdditiveHeuristic {
     typedef std::vector<bool> RelaxedPlan;
     RelaxedPlan relaxed_plan;
     void mark_preferred_operators_and_relaxed_plan(
-        const State &state, Proposition *goal);
+        const State &state, PropID goal);
 protected:
     virtual void initialize();
     virtual ap_float compute_heuristic(const GlobalState &global_state);
@@ -39,50 +39,53 @@ void HSPMaxHeuristic::initialize() {
 void HSPMaxHeuristic::setup_exploration_queue() {
     queue.clear();
 
-    for (vector<Proposition> &props_of_var : propositions) {
-        for (Proposition &prop : props_of_var) {
-            prop.cost = -1;
-        }
+    for (PropositionData &data : proposition_data) {
+        data.cost = -1;
     }
 
     // Deal with operators and axioms without preconditions.
-    for (UnaryOperator &op : unary_operators) {
-        op.unsatisfied_preconditions = op.precondition.size();
-        op.cost = op.base_cost; // will be increased by precondition costs
-
-        if (op.unsatisfied_preconditions == 0)
+    const vector<UnaryOperator> &unary_operators =
+        relaxed_task->get_unary_operators();
+    for (size_t i = 0; i < unary_operators.size(); ++i) {
+        const UnaryOperator &op = unary_operators[i];
+        UnaryOperatorData &data = operator_data[i];
+        data.unsatisfied_preconditions = op.num_preconditions;
+        data.cost = op.base_cost; // will be increased by precondition costs
+
+        if (data.unsatisfied_preconditions == 0)
             enqueue_if_necessary(op.effect, op.base_cost);
     }
 }
 
 void HSPMaxHeuristic::setup_exploration_queue_state(const State &state) {
     for (FactProxy fact : state) {
-        Proposition *init_prop = get_proposition(fact);
+        PropID init_prop = get_proposition(fact);
         enqueue_if_necessary(init_prop, 0);
     }
 }
 
 void HSPMaxHeuristic::relaxed_exploration() {
-    int unsolved_goals = goal_propositions.size();
+    const vector<UnaryOperator> &unary_operators =
+        relaxed_task->get_unary_operators();
+    int unsolved_goals = relaxed_task->get_goal_propositions().size();
     while (!queue.empty()) {
-        pair<ap_float, Proposition *> top_pair = queue.pop();
+        pair<ap_float, PropID> top_pair = queue.pop();
         ap_float distance = top_pair.first;
-        Proposition *prop = top_pair.second;
-        ap_float prop_cost = prop->cost;
+        PropID prop = top_pair.second;
+        ap_float prop_cost = proposition_data[prop].cost;
         assert(prop_cost <= distance);
         if (prop_cost < distance)
             continue;
-        if (prop->is_goal && --unsolved_goals == 0)
+        if (relaxed_task->is_goal(prop) && --unsolved_goals == 0)
             return;
-        const vector<UnaryOperator *> &triggered_operators =
-            prop->precondition_of;
-        for (UnaryOperator *unary_op : triggered_operators) {
-            --unary_op->unsatisfied_preconditions;
-            unary_op->cost = max(unary_op->cost,
-                                 unary_op->base_cost + prop_cost);
-            assert(unary_op->unsatisfied_preconditions >= 0);
-            if (unary_op->unsatisfied_preconditions == 0)
-                enqueue_if_necessary(unary_op->effect, unary_op->cost);
+        for (OpID op_id : relaxed_task->get_precondition_of(prop)) {
+            const UnaryOperator &unary_op = unary_operators[op_id];
+            UnaryOperatorData &data = operator_data[op_id];
+            --data.unsatisfied_preconditions;
+            data.cost = max(data.cost, unary_op.base_cost + prop_cost);
+            assert(data.unsatisfied_preconditions >= 0);
+            if (data.unsatisfied_preconditions == 0)
+                enqueue_if_necessary(unary_op.effect, data.cost);
         }
     }
 }
@@ -95,8 +98,8 @@ ap_float HSPMaxHeuristic::compute_heuristic(const GlobalState &global_state) {
     relaxed_exploration();
 
     ap_float total_cost = 0;
-    for (Proposition *prop : goal_propositions) {
-        ap_float prop_cost = prop->cost;
+    for (PropID goal : relaxed_task->get_goal_propositions()) {
+        ap_float prop_cost = proposition_data[goal].cost;
         if (prop_cost == -1) {
             return DEAD_END;
         }
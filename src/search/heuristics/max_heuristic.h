@@ -8,23 +8,27 @@
 #include <cassert>
 
 namespace max_heuristic {
-using relaxation_heuristic::Proposition;
+using relaxation_heuristic::OpID;
+using relaxation_heuristic::PropID;
+using relaxation_heuristic::PropositionData;
 using relaxation_heuristic::UnaryOperator;
+using relaxation_heuristic::UnaryOperatorData;
 
 class HSPMaxHeuristic : public relaxation_heuristic::RelaxationHeuristic {
-    AdaptiveQueue<Proposition *> queue;
+    AdaptiveQueue<PropID> queue;
 
     void setup_exploration_queue();
     void setup_exploration_queue_state(const State &state);
     void relaxed_exploration();
 
-    void enqueue_if_necessary(Proposition *prop, ap_float cost) {
+    void enqueue_if_necessary(PropID prop, ap_float cost) {
         assert(cost >= 0);
-        if (prop->cost == -1 || prop->cost > cost) {
-            prop->cost = cost;
+        ap_float &prop_cost = proposition_data[prop].cost;
+        if (prop_cost == -1 || prop_cost > cost) {
+            prop_cost = cost;
             queue.push(cost, prop);
         }
-        assert(prop->cost != -1 && prop->cost <= cost);
+        assert(prop_cost != -1 && prop_cost <= cost);
     }
 protected:
     virtual void initialize();
@@ -1,60 +1,52 @@
 #ifndef HEURISTICS_RELAXATION_HEURISTIC_H
 #define HEURISTICS_RELAXATION_HEURISTIC_H
 
+#include "relaxed_task.h"
+
 #include "../heuristic.h"
 
+#include <memory>
 #include <vector>
 
-class FactProxy;
 class GlobalState;
-class OperatorProxy;
 
 namespace relaxation_heuristic {
-struct Proposition;
-struct UnaryOperator;
+const OpID NO_OP = -1;
+
+/*
+  The data of a proposition and of a unary operator that changes during an
+  exploration. The structure of the relaxed task itself is shared with all
+  other relaxation heuristics for the same task.
+*/
+struct PropositionData {
+    ap_float cost; // Used for h^max cost or h^add cost; -1 if not reached
+    OpID reached_by; // NO_OP if true in the state or not reached
+    bool marked; // used when computing preferred operators for h^add and h^FF
 
-struct UnaryOperator {
-    int operator_no; // -1 for axioms; index into g_operators otherwise
-    std::vector<Proposition *> precondition;
-    Proposition *effect;
-    ap_float base_cost;
-    int unsatisfied_preconditions;
-    ap_float cost; // Used for h^max cost or h^add cost;
-              // includes operator cost (base_cost)
-    UnaryOperator(const std::vector<Proposition *> &pre, Proposition *eff,
-                  int operator_no_, ap_float base)
-        : operator_no(operator_no_), precondition(pre), effect(eff),
-          base_cost(base), unsatisfied_preconditions(pre.size()), cost(base) {}
+    PropositionData()
+        : cost(-1), reached_by(NO_OP), marked(false) {
+    }
 };
 
-struct Proposition {
-    bool is_goal;
-    int id;
-    std::vector<UnaryOperator *> precondition_of;
-
-    ap_float cost; // Used for h^max cost or h^add cost
-    UnaryOperator *reached_by;
-    bool marked; // used when computing preferred operators for h^add and h^FF
+struct UnaryOperatorData {
+    ap_float cost; // Used for h^max cost or h^add cost;
+                   // includes operator cost (base_cost)
+    int unsatisfied_preconditions;
 
-    Proposition(int id_) {
-        id = id_;
-        is_goal = false;
-        cost = -1;
-        reached_by = 0;
-        marked = false;
+    UnaryOperatorData()
+        : cost(0), unsatisfied_preconditions(0) {
     }
 };
 
 class RelaxationHeuristic : public Heuristic {
-    void build_unary_operators(const OperatorProxy &op, int operator_no);
-    void simplify();
-    void build_unary_axioms(const OperatorProxy &ax, int operator_no);
 protected:
-    std::vector<UnaryOperator> unary_operators;
-    std::vector<std::vector<Proposition>> propositions;
-    std::vector<Proposition *> goal_propositions;
+    std::shared_ptr<const RelaxedTask> relaxed_task;
+    std::vector<PropositionData> proposition_data;
+    std::vector<UnaryOperatorData> operator_data;
 
-    Proposition *get_proposition(const FactProxy &fact);
+    PropID get_proposition(const FactProxy &fact) const {
+        return relaxed_task->get_proposition(fact);
+    }
     virtual void initialize();
     virtual ap_float compute_heuristic(const GlobalState &state) = 0;
 public:
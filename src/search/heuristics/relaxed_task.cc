@@ -0,0 +1,219 @@
+#include "relaxed_task.h"
+
+#include "../task_proxy.h"
+
+#include "../utils/hash.h"
+
+#include <algorithm>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+
+using namespace std;
+
+namespace relaxation_heuristic {
+/*
+  We only want to build one relaxed task per task, so they are cached
+  globally. The cache does not own the relaxed tasks: a relaxed task is
+  reclaimed when the last heuristic using it is destroyed. Since these
+  heuristics also keep their task alive, a cached entry that has not
+  expired always belongs to the task with the given address. Expired
+  entries are removed on lookup, so the cache does not grow when many
+  tasks are solved in one process.
+*/
+static unordered_map<const AbstractTask *, weak_ptr<RelaxedTask>> relaxed_task_cache;
+static mutex relaxed_task_cache_mutex;
+
+RelaxedTask::RelaxedTask(const TaskProxy &task_proxy) {
+    // Build propositions.
+    VariablesProxy variables = task_proxy.get_variables();
+    proposition_offsets.reserve(variables.size() + 1);
+    proposition_offsets.push_back(0);
+    for (VariableProxy var : variables)
+        proposition_offsets.push_back(
+            proposition_offsets.back() + var.get_domain_size());
+    int num_propositions = get_num_propositions();
+
+    // Build goal propositions.
+    goal.resize(num_propositions, false);
+    for (FactProxy fact : task_proxy.get_goals()) {
+        PropID prop = get_proposition(fact);
+        goal[prop] = true;
+        goal_propositions.push_back(prop);
+    }
+
+    // Build unary operators for operators and axioms.
+    vector<UnaryOperatorInfo> infos;
+    OperatorsProxy operators = task_proxy.get_operators();
+    cout << "Building " << operators.size() << " unary operators" << endl;
+    int op_no = 0;
+    for (OperatorProxy op : operators)
+        build_unary_operators(op, op_no++, infos);
+    AxiomsProxy axioms = task_proxy.get_axioms();
+    cout << "Building " << axioms.size() << " unary axioms" << endl;
+    for (OperatorProxy axiom : axioms) {
+        assert(axiom.get_cost() == 0);
+        build_unary_operators(axiom, -1, infos);
+    }
+    // Simplify unary operators.
+    simplify(infos);
+
+    // Lay out the unary operators and their preconditions contiguously.
+    unary_operators.reserve(infos.size());
+    precondition_of_begin.assign(num_propositions + 1, 0);
+    for (const UnaryOperatorInfo &info : infos) {
+        unary_operators.emplace_back(
+            info.operator_no, info.effect, info.base_cost,
+            preconditions.size(), info.preconditions.size());
+        preconditions.insert(preconditions.end(),
+                             info.preconditions.begin(),
+                             info.preconditions.end());
+        for (PropID prop : info.preconditions)
+            ++precondition_of_begin[prop + 1];
+    }
+
+    // Cross-reference unary operators.
+    for (int prop = 0; prop < num_propositions; ++prop)
+        precondition_of_begin[prop + 1] += precondition_of_begin[prop];
+    precondition_of.resize(preconditions.size());
+    vector<int> next_position(precondition_of_begin.begin(),
+                              precondition_of_begin.end() - 1);
+    for (size_t op_id = 0; op_id < unary_operators.size(); ++op_id) {
+        for (PropID prop : get_preconditions(unary_operators[op_id]))
+            precondition_of[next_position[prop]++] = op_id;
+    }
+}
+
+PropID RelaxedTask::get_proposition(const FactProxy &fact) const {
+    return get_proposition(fact.get_variable().get_id(), fact.get_value());
+}
+
+void RelaxedTask::build_unary_operators(
+    const OperatorProxy &op, int operator_no,
+    vector<UnaryOperatorInfo> &infos) const {
+    if (DEBUG)
+        cout << "Building unary operators for " << op.get_name() << endl;
+    ap_float base_cost = op.get_cost();
+    vector<PropID> precondition_props;
+    for (FactProxy precondition : op.get_preconditions()) {
+        precondition_props.push_back(get_proposition(precondition));
+    }
+    for (EffectProxy effect : op.get_effects()) {
+        PropID effect_prop = get_proposition(effect.get_fact());
+        EffectConditionsProxy eff_conds = effect.get_conditions();
+        for (FactProxy eff_cond : eff_conds) {
+            precondition_props.push_back(get_proposition(eff_cond));
+        }
+        infos.push_back({operator_no, effect_prop, base_cost, precondition_props});
+        precondition_props.erase(precondition_props.end() - eff_conds.size(), precondition_props.end());
+    }
+}
+
+void RelaxedTask::simplify(vector<UnaryOperatorInfo> &infos) const {
+    // Remove duplicate or dominated unary operators.
+
+    /*
+      Algorithm: Put all unary operators into an unordered map
+      (key: condition and effect; value: index in operator vector.
+      This gets rid of operators with identical conditions.
+
+      Then go through the unordered map, checking for each element if
+      none of the possible dominators are part of the map.
+      Put the element into the new operator vector iff this is the case.
+
+      In both loops, be careful to ensure that a higher-cost operator
+      never dominates a lower-cost operator.
+
+      In the end, the vector of unary operators is sorted by operator_no,
+      effect, base_cost and precondition.
+    */
+    cout << "Simplifying " << infos.size() << " unary operators..." << flush;
+
+    typedef pair<vector<PropID>, PropID> Key;
+    typedef unordered_map<Key, int> Map;
+    Map unary_operator_index;
+    unary_operator_index.reserve(infos.size());
+
+    for (size_t i = 0; i < infos.size(); ++i) {
+        UnaryOperatorInfo &op = infos[i];
+        sort(op.preconditions.begin(), op.preconditions.end());
+        Key key(op.preconditions, op.effect);
+        pair<Map::iterator, bool> inserted = unary_operator_index.insert(
+            make_pair(key, i));
+        if (!inserted.second) {
+            // We already had an element with this key; check its cost.
+            Map::iterator iter = inserted.first;
+            int old_op_no = iter->second;
+            int old_cost = infos[old_op_no].base_cost;
+            int new_cost = infos[i].base_cost;
+            if (new_cost < old_cost)
+                iter->second = i;
+            assert(infos[unary_operator_index[key]].base_cost ==
+                   min(old_cost, new_cost));
+        }
+    }
+
+    vector<UnaryOperatorInfo> old_infos;
+    old_infos.swap(infos);
+
+    for (Map::iterator it = unary_operator_index.begin();
+         it != unary_operator_index.end(); ++it) {
+        const Key &key = it->first;
+        int unary_operator_no = it->second;
+        bool match = false;
+        if (key.first.size() <= 5) { // HACK! Don't spend too much time here...
+            int powerset_size = (1 << key.first.size()) - 1; // -1: only consider proper subsets
+            for (int mask = 0; mask < powerset_size; ++mask) {
+                Key dominating_key = make_pair(vector<PropID>(), key.second);
+                for (size_t i = 0; i < key.first.size(); ++i)
+                    if (mask & (1 << i))
+                        dominating_key.first.push_back(key.first[i]);
+                Map::iterator found = unary_operator_index.find(
+                    dominating_key);
+                if (found != unary_operator_index.end()) {
+                    int my_cost = old_infos[unary_operator_no].base_cost;
+                    int dominator_op_no = found->second;
+                    ap_float dominator_cost = old_infos[dominator_op_no].base_cost;
+                    if (dominator_cost <= my_cost) {
+                        match = true;
+                        break;
+                    }
+                }
+            }
+        }
+        if (!match)
+            infos.push_back(move(old_infos[unary_operator_no]));
+    }
+
+    sort(infos.begin(), infos.end(),
+         [] (const UnaryOperatorInfo &o1, const UnaryOperatorInfo &o2) {
+            if (o1.operator_no != o2.operator_no)
+                return o1.operator_no < o2.operator_no;
+            if (o1.effect != o2.effect)
+                return o1.effect < o2.effect;
+            if (o1.base_cost != o2.base_cost)
+                return o1.base_cost < o2.base_cost;
+            return o1.preconditions < o2.preconditions;
+        });
+
+    cout << " done! [" << infos.size() << " unary operators]" << endl;
+}
+
+shared_ptr<RelaxedTask> get_relaxed_task(const AbstractTask *task) {
+    lock_guard<mutex> lock(relaxed_task_cache_mutex);
+    for (auto it = relaxed_task_cache.begin(); it != relaxed_task_cache.end();) {
+        if (it->second.expired())
+            it = relaxed_task_cache.erase(it);
+        else
+            ++it;
+    }
+    weak_ptr<RelaxedTask> &cached = relaxed_task_cache[task];
+    shared_ptr<RelaxedTask> relaxed_task = cached.lock();
+    if (!relaxed_task) {
+        relaxed_task = make_shared<RelaxedTask>(TaskProxy(*task));
+        cached = relaxed_task;
+    }
+    return relaxed_task;
+}
+}
@@ -0,0 +1,128 @@
+#ifndef HEURISTICS_RELAXED_TASK_H
+#define HEURISTICS_RELAXED_TASK_H
+
+#include "../array_view.h"
+#include "../globals.h"
+
+#include <cassert>
+#include <memory>
+#include <vector>
+
+class AbstractTask;
+class FactProxy;
+class OperatorProxy;
+class TaskProxy;
+
+namespace relaxation_heuristic {
+// Propositions and unary operators are referred to by their index.
+using PropID = int;
+using OpID = int;
+
+struct UnaryOperator {
+    int operator_no; // -1 for axioms; index into g_operators otherwise
+    PropID effect;
+    ap_float base_cost;
+    // The preconditions are RelaxedTask::preconditions[begin, begin + count).
+    int preconditions_begin;
+    int num_preconditions;
+
+    UnaryOperator(int operator_no, PropID effect, ap_float base_cost,
+                  int preconditions_begin, int num_preconditions)
+        : operator_no(operator_no), effect(effect), base_cost(base_cost),
+          preconditions_begin(preconditions_begin),
+          num_preconditions(num_preconditions) {
+    }
+};
+
+/*
+  The delete relaxation of a task compiled into contiguous arrays: the
+  propositions of variable var have the ids offsets[var], ...,
+  offsets[var + 1] - 1, the preconditions of all unary operators are stored
+  in one array and the operators that have a proposition as precondition are
+  stored in compressed sparse row format.
+
+  The relaxed task does not change once it is built, so the propositional
+  relaxation heuristics (h^add, h^max and h^FF) of the same task share it
+  (see get_relaxed_task) and keep the costs of an exploration in arrays of
+  their own.
+
+  Only the propositional delete relaxation is represented: unary operators
+  have one propositional effect, numeric effects and numeric axioms are
+  dropped and dominated operators are removed. The interval, repetition
+  and numeric LM-cut relaxations need the numeric effects and the
+  numeric axioms of every operator, so they do not use this class.
+*/
+class RelaxedTask {
+    std::vector<int> proposition_offsets;
+    std::vector<UnaryOperator> unary_operators;
+    std::vector<PropID> preconditions;
+    // precondition_of[precondition_of_begin[p], precondition_of_begin[p + 1])
+    std::vector<int> precondition_of_begin;
+    std::vector<OpID> precondition_of;
+    std::vector<PropID> goal_propositions;
+    std::vector<bool> goal;
+
+    struct UnaryOperatorInfo {
+        int operator_no;
+        PropID effect;
+        ap_float base_cost;
+        std::vector<PropID> preconditions;
+    };
+
+    void build_unary_operators(const OperatorProxy &op, int operator_no,
+                               std::vector<UnaryOperatorInfo> &infos) const;
+    void simplify(std::vector<UnaryOperatorInfo> &infos) const;
+public:
+    /* Use the factory function get_relaxed_task to create relaxed tasks
+       to avoid creating more than one relaxed task per AbstractTask. */
+    explicit RelaxedTask(const TaskProxy &task_proxy);
+
+    int get_num_propositions() const {
+        return proposition_offsets.back();
+    }
+
+    int get_num_variables() const {
+        return proposition_offsets.size() - 1;
+    }
+
+    PropID get_proposition(int var, int value) const {
+        assert(var >= 0 && var < get_num_variables());
+        assert(value >= 0 &&
+               proposition_offsets[var] + value < proposition_offsets[var + 1]);
+        return proposition_offsets[var] + value;
+    }
+
+    PropID get_proposition(const FactProxy &fact) const;
+
+    const std::vector<UnaryOperator> &get_unary_operators() const {
+        return unary_operators;
+    }
+
+    ArrayView<const PropID> get_preconditions(const UnaryOperator &op) const {
+        return ArrayView<const PropID>(
+            preconditions.data() + op.preconditions_begin, op.num_preconditions);
+    }
+
+    ArrayView<const OpID> get_precondition_of(PropID prop) const {
+        int begin = precondition_of_begin[prop];
+        return ArrayView<const OpID>(
+            precondition_of.data() + begin,
+            precondition_of_begin[prop + 1] - begin);
+    }
+
+    const std::vector<PropID> &get_goal_propositions() const {
+        return goal_propositions;
+    }
+
+    bool is_goal(PropID prop) const {
+        return goal[prop];
+    }
+};
+
+/* Create or retrieve a relaxed task from cache. If relaxed tasks are created
+   with this function, at most one relaxed task per AbstractTask exists at a
+   time. The caller has to keep the task alive while it uses the result. */
+extern std::shared_ptr<RelaxedTask> get_relaxed_task(const AbstractTask *task);
+}
+
+#endif
@@ -1,6 +1,7 @@
 #include "int_packer.h"
 #include "globals.h" // required for the number of numeric Variables
 
+#include <algorithm>
 #include<iostream>
 #include <limits>
 #include <cassert>
@@ -60,6 +61,19 @@ public:
     ~VariableInfo() {
     }
 
+    int get_bin_index() const {
+        return bin_index;
+    }
+
+    Bin get_read_mask() const {
+        return read_mask;
+    }
+
+    Bin get_bin_value(container_int value) const {
+        assert(value <= range);
+        return value << shift;
+    }
+
     container_int get(const Bin *buffer) const {
 //    	cout << "about to return the variable in Bin #" << bin_index << " with the readmask " << read_mask << endl;
 //    	cout << "Im Buffer befindet sich folgendes: " << buffer[bin_index] << endl;
@@ -115,6 +129,43 @@ void IntPacker::setDouble(Bin *buffer, int var, ap_float value) const {
     var_infos[var].set(buffer, packedDouble);
 }
 
+int IntPacker::get_bin_index(int var) const {
+    return var_infos[var].get_bin_index();
+}
+
+IntPacker::Bin IntPacker::get_bin_mask(int var) const {
+    return var_infos[var].get_read_mask();
+}
+
+IntPacker::Bin IntPacker::get_bin_value(int var, container_int value) const {
+    return var_infos[var].get_bin_value(value);
+}
+
+void IntPacker::pack_all(
+    Bin *buffer, const container_int *values, int num_values) const {
+    for (int bin_index = 0; bin_index < num_bins; ++bin_index) {
+        if (bin_min_var[bin_index] >= num_values)
+            continue;
+        int end = bin_begin[bin_index + 1];
+        if (bin_max_var[bin_index] < num_values) {
+            // All fields of the bin are given, so the bin is overwritten.
+            Bin bin = 0;
+            for (int i = bin_begin[bin_index]; i < end; ++i) {
+                const BinField &field = fields[i];
+                assert(values[field.var] <= field.mask);
+                bin |= values[field.var] << field.shift;
+            }
+            buffer[bin_index] = bin;
+        } else {
+            for (int i = bin_begin[bin_index]; i < end; ++i) {
+                const BinField &field = fields[i];
+                if (field.var < num_values)
+                    var_infos[field.var].set(buffer, values[field.var]);
+            }
+        }
+    }
+}
+
 void IntPacker::pack_bins(const vector<container_int> &ranges) {
     assert(var_infos.empty());
 
@@ -134,9 +185,9 @@ void IntPacker::pack_bins(const vector<container_int> &ranges) {
     }
 
     int packed_vars = 0;
+    bin_begin.push_back(0);
     while (packed_vars != num_vars)
         packed_vars += pack_one_bin(ranges, bits_to_vars);
-
 }
 
 int IntPacker::pack_one_bin(const vector<container_int> &ranges,
@@ -159,6 +210,7 @@ int IntPacker::pack_one_bin(const vector<container_int> &ranges,
         if (bits == 0) {
             // No more variables fit into the bin.
             // (This also happens when all variables have been packed.)
+            bin_begin.push_back(fields.size());
             return num_vars_in_bin;
         }
 
@@ -169,6 +221,14 @@ int IntPacker::pack_one_bin(const vector<container_int> &ranges,
         best_fit_vars.pop_back();
 
         var_infos[var] = VariableInfo(ranges[var], bin_index, used_bits);
+        fields.push_back(BinField {var, used_bits, get_bit_mask(0, bits)});
+        if (num_vars_in_bin == 0) {
+            bin_min_var.push_back(var);
+            bin_max_var.push_back(var);
+        } else {
+            bin_min_var[bin_index] = min(bin_min_var[bin_index], var);
+            bin_max_var[bin_index] = max(bin_max_var[bin_index], var);
+        }
         used_bits += bits;
         ++num_vars_in_bin;
     }
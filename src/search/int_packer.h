@@ -22,8 +22,25 @@
 class IntPacker {
     class VariableInfo;
 
+    /*
+      Position of a variable in its bin. The fields of each bin are stored
+      consecutively (fields[bin_begin[bin]] to fields[bin_begin[bin + 1] - 1]),
+      so that the bulk methods read or write each bin only once.
+    */
+    struct BinField {
+        int var;
+        int shift;
+        // Mask of the (unshifted) value.
+        container_int mask;
+    };
+
     std::vector<VariableInfo> var_infos;
     int num_bins;
+    std::vector<BinField> fields;
+    std::vector<int> bin_begin;
+    // Smallest and largest variable of each bin.
+    std::vector<int> bin_min_var;
+    std::vector<int> bin_max_var;
 
     int pack_one_bin(const std::vector<container_int> &ranges,
                      std::vector<std::vector<int> > &bits_to_vars);
@@ -46,6 +63,27 @@ public:
     void set(Bin *buffer, int var, container_int value) const;
     void setDouble(Bin *buffer, int var, ap_float value) const;
 
+    /*
+      Bulk versions of get and set for the variables 0, ..., num_values - 1,
+      e.g. all propositional variables, which precede the numeric ones.
+      They visit the bins one after the other and extract (or combine) all
+      fields of a bin with precomputed shifts and masks. pack_all does not
+      change the fields of other variables.
+    */
+    template<typename Value>
+    void unpack_all(const Bin *buffer, Value *values, int num_values) const;
+    void pack_all(Bin *buffer, const container_int *values, int num_values) const;
+
+    /*
+      Position of a variable in the packed buffer, e.g. to compare or set
+      several variables of a bin with one operation: the index of its bin,
+      the mask of its bits in this bin, and the given value shifted to
+      these bits.
+    */
+    int get_bin_index(int var) const;
+    Bin get_bin_mask(int var) const;
+    Bin get_bin_value(int var, container_int value) const;
+
     int get_num_bins() const {return num_bins; }
     std::size_t get_bin_size_in_bytes() const {return sizeof(Bin); }
 
@@ -54,4 +92,27 @@ public:
 
 };
 
+template<typename Value>
+void IntPacker::unpack_all(
+    const Bin *buffer, Value *values, int num_values) const {
+    for (int bin_index = 0; bin_index < num_bins; ++bin_index) {
+        if (bin_min_var[bin_index] >= num_values)
+            continue;
+        Bin bin = buffer[bin_index];
+        int end = bin_begin[bin_index + 1];
+        if (bin_max_var[bin_index] < num_values) {
+            for (int i = bin_begin[bin_index]; i < end; ++i) {
+                const BinField &field = fields[i];
+                values[field.var] = (bin >> field.shift) & field.mask;
+            }
+        } else {
+            for (int i = bin_begin[bin_index]; i < end; ++i) {
+                const BinField &field = fields[i];
+                if (field.var < num_values)
+                    values[field.var] = (bin >> field.shift) & field.mask;
+            }
+        }
+    }
+}
+
 #endif
@@ -62,7 +62,7 @@ void LandmarkCountHeuristic::set_exploration_goals(const GlobalState &state) {
     // Set additional goals for FF exploration
     vector<pair<int, int> > lm_leaves;
     LandmarkSet result;
-    const vector<bool> &reached_lms_v = lm_status_manager.get_reached_landmarks(state);
+    BitsetView reached_lms_v = lm_status_manager.get_reached_landmarks(state);
     convert_lms(result, reached_lms_v);
     collect_lm_leaves(ff_search_disjunctive_lms, result, lm_leaves);
     exploration->set_additional_goals(lm_leaves);
@@ -122,7 +122,7 @@ ap_float LandmarkCountHeuristic::compute_heuristic(const GlobalState &state) {
     // to achieve one of the LM leaves.
 
     LandmarkSet reached_lms;
-    vector<bool> &reached_lms_v = lm_status_manager.get_reached_landmarks(state);
+    BitsetView reached_lms_v = lm_status_manager.get_reached_landmarks(state);
     convert_lms(reached_lms, reached_lms_v);
 
     int num_reached = reached_lms.size();
@@ -259,13 +259,13 @@ bool LandmarkCountHeuristic::dead_ends_are_reliable() const {
 }
 
 void LandmarkCountHeuristic::convert_lms(LandmarkSet &lms_set,
-                                         const vector<bool> &lms_vec) {
+                                         const BitsetView &lms_vec) {
     // This function exists purely so we don't have to change all the
     // functions in this class that use LandmarkSets for the reached LMs
     // (HACK).
 
-    for (size_t i = 0; i < lms_vec.size(); ++i)
-        if (lms_vec[i])
+    for (int i = 0; i < lms_vec.size(); ++i)
+        if (lms_vec.test(i))
             lms_set.insert(lgraph.get_lm_for_index(i));
 }
 
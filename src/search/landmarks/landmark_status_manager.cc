@@ -1,10 +1,14 @@
 #include "landmark_status_manager.h"
 
+#include <algorithm>
+
 using namespace std;
 
 namespace landmarks {
 LandmarkStatusManager::LandmarkStatusManager(LandmarkGraph &graph)
-    : lm_graph(graph) {
+    : reached_lms(graph.number_of_landmarks(), true),
+      old_reached_blocks(BitsetView::compute_num_blocks(graph.number_of_landmarks())),
+      lm_graph(graph) {
     do_intersection = true;
 }
 
@@ -13,7 +17,7 @@ LandmarkStatusManager::~LandmarkStatusManager() {
 }
 
 
-vector<bool> &LandmarkStatusManager::get_reached_landmarks(const GlobalState &state) {
+BitsetView LandmarkStatusManager::get_reached_landmarks(const GlobalState &state) {
     return reached_lms[state];
 }
 
@@ -21,8 +25,8 @@ vector<bool> &LandmarkStatusManager::get_reached_landmarks(const GlobalState &st
 void LandmarkStatusManager::set_landmarks_for_initial_state() {
     // TODO use correct state registry here.
     const GlobalState &initial_state = g_initial_state();
-    vector<bool> &reached = get_reached_landmarks(initial_state);
-    reached.resize(lm_graph.number_of_landmarks());
+    BitsetView reached = get_reached_landmarks(initial_state);
+    reached.reset();
     //cout << "NUMBER OF LANDMARKS: " << lm_graph.number_of_landmarks() << endl;
 
     int inserted = 0;
@@ -47,13 +51,13 @@ void LandmarkStatusManager::set_landmarks_for_initial_state() {
                 }
             }
             if (lm_true) {
-                reached[node_p->get_id()] = true;
+                reached.set(node_p->get_id());
                 ++inserted;
             }
         } else {
             for (size_t i = 0; i < node_p->vals.size(); ++i) {
                 if ((int) initial_state[node_p->vars[i]] == node_p->vals[i]) {
-                    reached[node_p->get_id()] = true;
+                    reached.set(node_p->get_id());
                     ++inserted;
                     break;
                 }
@@ -67,51 +71,47 @@ void LandmarkStatusManager::set_landmarks_for_initial_state() {
 
 bool LandmarkStatusManager::update_reached_lms(
     const GlobalState &parent_state, const GlobalOperator &, const GlobalState &state) {
-    vector<bool> &parent_reached = get_reached_landmarks(parent_state);
-    vector<bool> &reached = get_reached_landmarks(state);
-
-
-    if (&parent_reached == &reached) {
-        assert(state.get_id() == parent_state.get_id());
+    if (state.get_id() == parent_state.get_id()) {
         // This can happen, e.g., in Satellite-01.
         return false;
     }
 
-    bool intersect = (do_intersection && !reached.empty());
-    vector<bool> old_reached;
-    if (intersect) {
-        // Save old reached landmarks for this state.
-        // Swapping is faster than old_reached = reached, and we assign
-        // a new value to reached next anyway.
-        old_reached.swap(reached);
-    }
-
-    reached = parent_reached;
-
-
+    BitsetView parent_reached = get_reached_landmarks(parent_state);
+    BitsetView reached = get_reached_landmarks(state);
 
     int num_landmarks = lm_graph.number_of_landmarks();
-    assert(static_cast<int>(reached.size()) == num_landmarks);
-    assert(static_cast<int>(parent_reached.size()) == num_landmarks);
-    assert(!intersect || static_cast<int>(old_reached.size()) == num_landmarks);
-
-    for (int id = 0; id < num_landmarks; ++id) {
-        if (intersect && !old_reached[id]) {
-            reached[id] = false;
-        } else if (!reached[id]) {
-            LandmarkNode *node = lm_graph.get_lm_for_index(id);
-            if (node->is_true_in_state(state)) {
-                // cout << "New LM reached: id " << id << " ";
-                // lm_graph.dump_node(node);
-                if (landmark_is_leaf(*node, reached)) {
-                    //      cout << "inserting new LM into reached. (2)" << endl;
-                    reached[id] = true;
+    assert(reached.size() == num_landmarks);
+    assert(parent_reached.size() == num_landmarks);
+
+    // Save old reached landmarks for this state.
+    BitsetView old_reached(old_reached_blocks.data(), num_landmarks);
+    if (do_intersection)
+        old_reached.copy_from(reached);
+
+    reached.copy_from(parent_reached);
+
+    const int bits_per_block = BitsetView::bits_per_block;
+    for (int block = 0; block < reached.get_num_blocks(); ++block) {
+        // Skip blocks where all landmarks stay reached.
+        BitsetView::Block changing = ~reached.get_blocks()[block];
+        if (do_intersection)
+            changing |= ~old_reached.get_blocks()[block];
+        if (!changing)
+            continue;
+        int end = min(num_landmarks, (block + 1) * bits_per_block);
+        for (int id = block * bits_per_block; id < end; ++id) {
+            if (do_intersection && !old_reached.test(id)) {
+                reached.reset(id);
+            } else if (!reached.test(id)) {
+                LandmarkNode *node = lm_graph.get_lm_for_index(id);
+                if (node->is_true_in_state(state)) {
+                    // cout << "New LM reached: id " << id << " ";
+                    // lm_graph.dump_node(node);
+                    if (landmark_is_leaf(*node, reached)) {
+                        //      cout << "inserting new LM into reached. (2)" << endl;
+                        reached.set(id);
+                    }
                 }
-                /*
-                   else {
-                   cout << "non-leaf, not inserting." << std::endl;
-                   }
-                 */
             }
         }
     }
@@ -121,7 +121,7 @@ bool LandmarkStatusManager::update_reached_lms(
 }
 
 bool LandmarkStatusManager::update_lm_status(const GlobalState &state) {
-    vector<bool> &reached = get_reached_landmarks(state);
+    BitsetView reached = get_reached_landmarks(state);
 
     const set<LandmarkNode *> &nodes = lm_graph.get_nodes();
     // initialize all nodes to not reached and not effect of unused ALM
@@ -129,7 +129,7 @@ bool LandmarkStatusManager::update_lm_status(const GlobalState &state) {
     for (lit = nodes.begin(); lit != nodes.end(); ++lit) {
         LandmarkNode &node = **lit;
         node.status = lm_not_reached;
-        if (reached[node.get_id()]) {
+        if (reached.test(node.get_id())) {
             node.status = lm_reached;
         }
     }
@@ -186,12 +186,12 @@ bool LandmarkStatusManager::check_lost_landmark_children_needed_again(const Land
 }
 
 bool LandmarkStatusManager::landmark_is_leaf(const LandmarkNode &node,
-                                             const vector<bool> &reached) const {
+                                             const BitsetView &reached) const {
 //Note: this is the same as !check_node_orders_disobeyed
     for (const auto &parent : node.parents) {
         LandmarkNode *parent_node = parent.first;
         if (true) // Note: no condition on edge type here
-            if (!reached[parent_node->get_id()]) {
+            if (!reached.test(parent_node->get_id())) {
                 //cout << "parent is not in reached: ";
                 //cout << parent_p << " ";
                 //lm_graph.dump_node(parent_p);
@@ -3,23 +3,29 @@
 
 #include "landmark_graph.h"
 
-#include "../per_state_information.h"
+#include "../per_state_bitset.h"
 
 namespace landmarks {
 class LandmarkStatusManager {
 private:
-    PerStateInformation<std::vector<bool>> reached_lms;
+    /*
+      Unseen states start with all landmarks reached, so that intersecting
+      with them keeps the landmarks reached on the first path.
+    */
+    PerStateBitset reached_lms;
+    // Copy of the old reached landmarks of a state while it is updated.
+    std::vector<BitsetView::Block> old_reached_blocks;
 
     bool do_intersection;
     LandmarkGraph &lm_graph;
 
-    bool landmark_is_leaf(const LandmarkNode &node, const std::vector<bool> &reached) const;
+    bool landmark_is_leaf(const LandmarkNode &node, const BitsetView &reached) const;
     bool check_lost_landmark_children_needed_again(const LandmarkNode &node) const;
 public:
     LandmarkStatusManager(LandmarkGraph &graph);
     virtual ~LandmarkStatusManager();
 
-    std::vector<bool> &get_reached_landmarks(const GlobalState &state);
+    BitsetView get_reached_landmarks(const GlobalState &state);
 
     bool update_lm_status(const GlobalState &state);
 
@@ -162,6 +162,17 @@ unique_ptr<OsiSolverInterface> create_lp_solver(LPSolverType solver_type) {
         }
     }
     
+    void set_interrupt_flag(std::unique_ptr<OsiSolverInterface> const & lp_solver, volatile int *flag) {
+#ifdef COIN_HAS_CPX
+        OsiCpxSolverInterface *cpx_solver = dynamic_cast<OsiCpxSolverInterface*>(lp_solver.get());
+        if (cpx_solver)
+            CPXsetterminate(cpx_solver->getEnvironmentPtr(), flag);
+#else
+        (void) lp_solver;
+        (void) flag;
+#endif
+    }
+    
 NO_RETURN
 void handle_coin_error(const CoinError &error) {
     cerr << "Coin threw exception: " << error.message() << endl
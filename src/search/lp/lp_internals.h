@@ -23,6 +23,12 @@ std::unique_ptr<OsiSolverInterface> create_lp_solver(LPSolverType solver_type);
     
 void set_time_limit(std::unique_ptr<OsiSolverInterface> const & lp_solver, LPSolverType solver_type, double time);
 
+/*
+  Make the solver abort a running solve as soon as *flag is nonzero. Only
+  CPLEX supports this; for other solvers, this does nothing.
+*/
+void set_interrupt_flag(std::unique_ptr<OsiSolverInterface> const & lp_solver, volatile int *flag);
+
 /*
   Print the CoinError and then exit with ExitCode::CRITICAL_ERROR.
   Note that out-of-memory conditions occurring within CPLEX code cannot
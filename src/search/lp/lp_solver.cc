@@ -14,6 +14,7 @@
 #include <OsiSolverInterface.hpp>
 #include <CoinPackedMatrix.hpp>
 #include <CoinPackedVector.hpp>
+#include <CoinWarmStartBasis.hpp>
 #ifdef __GNUG__
 #pragma GCC diagnostic pop
 #endif
@@ -126,9 +127,11 @@ LPSolver::LPSolver(LPSolverType s_t, LPConstraintType c_t)
       num_permanent_constraints(0),
       has_temporary_constraints_(false),
       solver_type(s_t),
+      interrupted(0),
       lp_type(c_t)
     {
       lp_solver = create_lp_solver(solver_type);
+      set_interrupt_flag(lp_solver, &interrupted);
 }
     
 LPSolver::LPSolver(LPSolverType s_t)
@@ -137,8 +140,10 @@ LPSolver::LPSolver(LPSolverType s_t)
     num_permanent_constraints(0),
     has_temporary_constraints_(false),
     solver_type(s_t),
+    interrupted(0),
     lp_type(LPConstraintType::LP) {
         lp_solver = create_lp_solver(solver_type);
+        set_interrupt_flag(lp_solver, &interrupted);
     }
 
 void LPSolver::clear_temporary_data() {
@@ -249,6 +254,81 @@ void LPSolver::load_problem(LPObjectiveSense sense,
     clear_temporary_data();
 }
 
+void LPSolver::extend_problem(const std::vector<LPVariable> &variables,
+                              const std::vector<LPConstraint> &constraints) {
+    assert(!has_temporary_constraints_);
+    clear_temporary_data();
+    try {
+        unique_ptr<CoinWarmStart> basis(lp_solver->getWarmStart());
+        int first_new_variable = lp_solver->getNumCols();
+        if (!variables.empty()) {
+            for (const LPVariable &var : variables) {
+                col_lb.push_back(var.lower_bound);
+                col_ub.push_back(var.upper_bound);
+                objective.push_back(var.objective_coefficient);
+                // Columns are added empty, their entries come with the rows.
+                rows.push_back(new CoinShallowPackedVector(0, nullptr, nullptr, false));
+            }
+            lp_solver->addCols(variables.size(), rows.data(),
+                               col_lb.data(), col_ub.data(), objective.data());
+            for (CoinPackedVectorBase *column : rows) {
+                delete column;
+            }
+            rows.clear();
+            if (lp_type == LPConstraintType::IP) {
+                int index = first_new_variable;
+                for (const LPVariable &var : variables) {
+                    if (var.type == integer || var.type == binary)
+                        lp_solver->setInteger(index);
+                    ++index;
+                }
+            }
+        }
+        if (!constraints.empty()) {
+            for (const LPConstraint &constraint : constraints) {
+                row_lb.push_back(constraint.get_lower_bound());
+                row_ub.push_back(constraint.get_upper_bound());
+                rows.push_back(new CoinShallowPackedVector(
+                                   constraint.get_variables().size(),
+                                   constraint.get_variables().data(),
+                                   constraint.get_coefficients().data(),
+                                   false));
+            }
+            lp_solver->addRows(constraints.size(),
+                               rows.data(), row_lb.data(), row_ub.data());
+            for (CoinPackedVectorBase *row : rows) {
+                delete row;
+            }
+        }
+        CoinWarmStartBasis *warm_start_basis =
+            dynamic_cast<CoinWarmStartBasis *>(basis.get());
+        if (warm_start_basis) {
+            warm_start_basis->resize(lp_solver->getNumRows(),
+                                     lp_solver->getNumCols());
+            lp_solver->setWarmStart(warm_start_basis);
+        }
+    } catch (CoinError &error) {
+        handle_coin_error(error);
+    }
+    num_permanent_constraints += constraints.size();
+    clear_temporary_data();
+    is_solved = false;
+}
+
+void LPSolver::set_warm_start(const std::vector<double> &solution) {
+    try {
+        int num_variables = lp_solver->getNumCols();
+        const double *lower_bounds = lp_solver->getColLower();
+        vector<double> start(lower_bounds, lower_bounds + num_variables);
+        copy(solution.begin(),
+             solution.begin() + min<int>(solution.size(), num_variables),
+             start.begin());
+        lp_solver->setColSolution(start.data());
+    } catch (CoinError &error) {
+        handle_coin_error(error);
+    }
+}
+
 void LPSolver::add_temporary_constraints(const std::vector<LPConstraint> &constraints) {
     if (!constraints.empty()) {
         clear_temporary_data();
@@ -381,7 +461,7 @@ void LPSolver::solve() {
                 is_initialized = true;
             }
         }
-        if (lp_solver->isAbandoned()) {
+        if (!interrupted && lp_solver->isAbandoned()) {
             // The documentation of OSI is not very clear here but memory seems
             // to be the most common cause for this in our case.
             cerr << "Abandoned LP during resolve. "
@@ -396,10 +476,19 @@ void LPSolver::solve() {
 
 }
 
+void LPSolver::interrupt() {
+    interrupted = 1;
+}
+
+void LPSolver::clear_interrupt() {
+    interrupted = 0;
+}
+
 bool LPSolver::has_optimal_solution() const {
     assert(is_solved);
     try {
-        return !lp_solver->isProvenPrimalInfeasible() &&
+        return !interrupted &&
+               !lp_solver->isProvenPrimalInfeasible() &&
                !lp_solver->isProvenDualInfeasible() &&
                lp_solver->isProvenOptimal();
     } catch (CoinError &error) {
@@ -107,6 +107,8 @@ class LPSolver {
     int num_permanent_constraints;
     bool has_temporary_constraints_;
     LPSolverType solver_type;
+    // Set by interrupt(), possibly from another thread.
+    volatile int interrupted;
 #ifdef USE_LP
     std::unique_ptr<OsiSolverInterface> lp_solver;
 #endif
@@ -141,6 +143,23 @@ public:
                   LPObjectiveSense sense,
                   const std::vector<LPVariable> &variables,
                   const std::vector<LPConstraint> &constraints))
+    /*
+      Append variables and permanent constraints to the loaded problem
+      without reloading it. The constraints may refer to the new variables.
+      The basis of the last solve is kept (new constraints start with basic
+      slack variables, new variables at their lower bound), so the next solve
+      is warm started. Must not be called while there are temporary
+      constraints.
+    */
+    LP_METHOD(void extend_problem(
+                  const std::vector<LPVariable> &variables,
+                  const std::vector<LPConstraint> &constraints))
+    /*
+      Pass a primal solution, e.g. the incumbent of the problem before it was
+      extended, as a starting point for the next solve. Variables without an
+      entry start at their lower bound.
+    */
+    LP_METHOD(void set_warm_start(const std::vector<double> &solution))
     LP_METHOD(void add_temporary_constraints(const std::vector<LPConstraint> &constraints))
     LP_METHOD(void clear_temporary_constraints())
     LP_METHOD(double get_infinity() const)
@@ -154,6 +173,16 @@ public:
 
     LP_METHOD(void solve())
 
+    /*
+      Abort a call of solve() that runs in another thread. The interrupted
+      solve has no optimal solution. Interrupting is only supported for
+      CPLEX; other solvers finish the solve (within the time limit) and only
+      report that there is no optimal solution. The flag stays set until
+      clear_interrupt() is called.
+    */
+    LP_METHOD(void interrupt())
+    LP_METHOD(void clear_interrupt())
+
     /*
       Return true if the solving the LP showed that it is bounded feasible and
       the discovered solution is guaranteed to be optimal. We test for
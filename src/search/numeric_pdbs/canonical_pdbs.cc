@@ -3,6 +3,8 @@
 #include "dominance_pruning.h"
 #include "pattern_database.h"
 
+#include "../utils/memory.h"
+
 #include <algorithm>
 #include <cassert>
 #include <limits>
@@ -21,31 +23,18 @@ CanonicalPDBs::CanonicalPDBs(
         max_additive_subsets = prune_dominated_subsets(
             *pattern_databases, *max_additive_subsets);
     }
+    packed_pdbs = utils::make_unique_ptr<PackedPDBCollection>(
+        *max_additive_subsets);
 }
 
 ap_float CanonicalPDBs::get_value(const State &state) const {
-    // If we have an empty collection, then max_additive_subsets = { \emptyset }.
-    assert(!max_additive_subsets->empty());
-    ap_float max_h = 0;
-    bool found_state = false;
-    for (const auto &subset : *max_additive_subsets) {
-        ap_float subset_h = 0;
-        for (const shared_ptr<PatternDatabase> &pdb : subset) {
-            /* Experiments showed that it is faster to recompute the
-               h values than to cache them in an unordered_map. */
-            auto [found_state_pdb, h] = pdb->get_value(state);
-            if (found_state_pdb){
-                found_state = true;
-            }
-            if (h == numeric_limits<ap_float>::max())
-                return numeric_limits<ap_float>::max();
-            subset_h += h;
-        }
-        max_h = max(max_h, subset_h);
-    }
+    bool found_state;
+    ap_float h = packed_pdbs->get_value(state, found_state);
+    if (h == numeric_limits<ap_float>::max())
+        return h;
     if (!found_state){
         number_lookup_misses++;
     }
-    return max_h;
+    return h;
 }
 }
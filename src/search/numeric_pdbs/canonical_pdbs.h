@@ -1,6 +1,7 @@
 #ifndef NUMERIC_PDBS_CANONICAL_PDBS_H
 #define NUMERIC_PDBS_CANONICAL_PDBS_H
 
+#include "packed_pdb_collection.h"
 #include "types.h"
 
 #include "../globals.h"
@@ -12,6 +13,7 @@ class State;
 namespace numeric_pdbs {
 class CanonicalPDBs {
     std::shared_ptr<MaxAdditivePDBSubsets> max_additive_subsets;
+    std::unique_ptr<PackedPDBCollection> packed_pdbs;
     mutable size_t number_lookup_misses; // for statistics only
 
 public:
@@ -3,6 +3,7 @@
 #include "canonical_pdbs.h"
 #include "pattern_database.h"
 
+#include "../utils/memory.h"
 #include "../utils/timer.h"
 
 #include <iostream>
@@ -34,6 +35,9 @@ IncrementalCanonicalPDBs::IncrementalCanonicalPDBs(
     cout << "PDB collection construction time: " << timer << endl;
 }
 
+IncrementalCanonicalPDBs::~IncrementalCanonicalPDBs() {
+}
+
 void IncrementalCanonicalPDBs::add_pdb_for_pattern(const Pattern &pattern) {
     pattern_databases->emplace_back(new PatternDatabase(task_proxy, pattern, max_number_pdb_states));
     size += pattern_databases->back()->get_size();
@@ -45,20 +49,28 @@ void IncrementalCanonicalPDBs::add_pattern(const Pattern &pattern) {
     recompute_max_additive_subsets();
 }
 
+void IncrementalCanonicalPDBs::add_pdb(const shared_ptr<PatternDatabase> &pdb) {
+    patterns->push_back(pdb->get_pattern());
+    pattern_databases->push_back(pdb);
+    size += pdb->get_size();
+    recompute_max_additive_subsets();
+}
+
 void IncrementalCanonicalPDBs::recompute_max_additive_subsets() {
     max_additive_subsets = compute_max_additive_subsets(*pattern_databases,
                                                         are_additive);
+    canonical_pdbs = utils::make_unique_ptr<CanonicalPDBs>(
+        pattern_databases, max_additive_subsets, false);
 }
 
 MaxAdditivePDBSubsets IncrementalCanonicalPDBs::get_max_additive_subsets(
-    const Pattern &new_pattern) {
+    const Pattern &new_pattern) const {
     return numeric_pdbs::compute_max_additive_subsets_with_pattern(
         *max_additive_subsets, new_pattern, are_additive);
 }
 
 ap_float IncrementalCanonicalPDBs::get_value(const State &state) const {
-    CanonicalPDBs canonical_pdbs(pattern_databases, max_additive_subsets, false);
-    return canonical_pdbs.get_value(state);
+    return canonical_pdbs->get_value(state);
 }
 
 bool IncrementalCanonicalPDBs::is_dead_end(const State &state) const {
@@ -9,6 +9,8 @@
 #include <memory>
 
 namespace numeric_pdbs {
+class CanonicalPDBs;
+
 class IncrementalCanonicalPDBs {
     const std::shared_ptr<AbstractTask> task;
     const std::shared_ptr<numeric_pdb_helper::NumericTaskProxy> task_proxy;
@@ -16,6 +18,8 @@ class IncrementalCanonicalPDBs {
     std::shared_ptr<PatternCollection> patterns;
     std::shared_ptr<PDBCollection> pattern_databases;
     std::shared_ptr<MaxAdditivePDBSubsets> max_additive_subsets;
+    // Evaluates the current collection; rebuilt when a pattern is added.
+    std::unique_ptr<CanonicalPDBs> canonical_pdbs;
 
     // A pair of variables is additive if no operator has an effect on both.
     NumericVariableAdditivity are_additive;
@@ -35,14 +39,20 @@ public:
                                       std::shared_ptr<numeric_pdb_helper::NumericTaskProxy> task_proxy,
                                       const PatternCollection &intitial_patterns,
                                       size_t max_number_pdb_states);
-    virtual ~IncrementalCanonicalPDBs() = default;
+    virtual ~IncrementalCanonicalPDBs();
 
     // Adds a new pattern to the collection and recomputes max_additive_subsets.
     void add_pattern(const Pattern &pattern);
 
+    /*
+      Like add_pattern, but uses the given PDB, which must have been built
+      for the task with the same max_number_pdb_states and operator costs.
+    */
+    void add_pdb(const std::shared_ptr<PatternDatabase> &pdb);
+
     /* Returns a set of subsets that would be additive to the new pattern.
        Detailed documentation in max_additive_pdb_sets.h */
-    MaxAdditivePDBSubsets get_max_additive_subsets(const Pattern &new_pattern);
+    MaxAdditivePDBSubsets get_max_additive_subsets(const Pattern &new_pattern) const;
 
     ap_float get_value(const State &state) const;
 
@@ -2,6 +2,9 @@
 
 #include "numeric_helper.h"
 
+#include "../utils/hash.h"
+
+#include <algorithm>
 #include <sstream>
 
 using namespace std;
@@ -21,33 +24,75 @@ string NumericState::get_name(const NumericTaskProxy &proxy, const Pattern &patt
     return ss.str();
 }
 
-size_t NumericStateRegistry::insert_state(const NumericState &state) {
-    state_data_pool.push_back(state);
-    size_t id(state_data_pool.size() - 1);
-    pair<StateIDSet::iterator, bool> result = registered_states.insert(id);
-    bool is_new_entry = result.second;
-    if (!is_new_entry) {
-        state_data_pool.pop_back();
+NumericStateRegistry::NumericStateRegistry(int num_numeric_vars)
+    : num_numeric_vars(num_numeric_vars),
+      numeric_values(num_numeric_vars),
+      buckets(16, 0) {
+    assert(num_numeric_vars > 0);
+}
+
+size_t NumericStateRegistry::compute_hash(size_t prop_hash,
+                                          const ap_float *num_state) const {
+    size_t seed = prop_hash;
+    for (int i = 0; i < num_numeric_vars; ++i)
+        utils::hash_combine(seed, num_state[i]);
+    return seed;
+}
+
+bool NumericStateRegistry::is_equal(size_t state_id, size_t prop_hash,
+                                    const ap_float *num_state) const {
+    if (prop_hashes[state_id] != prop_hash)
+        return false;
+    const ap_float *row = numeric_values[state_id];
+    return equal(row, row + num_numeric_vars, num_state);
+}
+
+size_t NumericStateRegistry::find_bucket(size_t prop_hash,
+                                         const ap_float *num_state) const {
+    size_t mask = buckets.size() - 1;
+    size_t bucket = compute_hash(prop_hash, num_state) & mask;
+    while (buckets[bucket] != 0 &&
+           !is_equal(buckets[bucket] - 1, prop_hash, num_state)) {
+        bucket = (bucket + 1) & mask;
     }
-    assert(registered_states.size() == state_data_pool.size());
-    return *result.first;
-}
-
-size_t NumericStateRegistry::get_id(const NumericState &state) {
-    // TODO avoid the push_back + pop_back
-    state_data_pool.push_back(state);
-    size_t id(state_data_pool.size() - 1);
-    pair<StateIDSet::iterator, bool> result = registered_states.insert(id);
-    bool is_new_entry = result.second;
-    if (is_new_entry) {
-        // state was not generated during exploration
-        registered_states.erase(id);
-        state_data_pool.pop_back();
-        assert(registered_states.size() == state_data_pool.size());
-        return numeric_limits<size_t>::max();
+    return bucket;
+}
+
+void NumericStateRegistry::grow_buckets() {
+    buckets.assign(2 * buckets.size(), 0);
+    size_t mask = buckets.size() - 1;
+    for (size_t state_id = 0; state_id < size(); ++state_id) {
+        size_t bucket = compute_hash(prop_hashes[state_id],
+                                     numeric_values[state_id]) & mask;
+        while (buckets[bucket] != 0)
+            bucket = (bucket + 1) & mask;
+        buckets[bucket] = state_id + 1;
     }
-    state_data_pool.pop_back();
-    assert(registered_states.size() == state_data_pool.size());
-    return *result.first;
 }
-}
\ No newline at end of file
+
+size_t NumericStateRegistry::insert_state(size_t prop_hash,
+                                          ArrayView<const ap_float> num_state) {
+    assert(static_cast<int>(num_state.size()) == num_numeric_vars);
+    size_t bucket = find_bucket(prop_hash, num_state.data());
+    if (buckets[bucket] != 0)
+        return buckets[bucket] - 1;
+
+    size_t state_id = size();
+    prop_hashes.push_back(prop_hash);
+    numeric_values.push_back(num_state.data());
+    buckets[bucket] = state_id + 1;
+    // Keep the load factor at most 1/2.
+    if (2 * size() > buckets.size())
+        grow_buckets();
+    return state_id;
+}
+
+size_t NumericStateRegistry::get_id(size_t prop_hash,
+                                    ArrayView<const ap_float> num_state) const {
+    assert(static_cast<int>(num_state.size()) == num_numeric_vars);
+    size_t bucket = find_bucket(prop_hash, num_state.data());
+    if (buckets[bucket] == 0)
+        return numeric_limits<size_t>::max();
+    return buckets[bucket] - 1;
+}
+}
@@ -3,12 +3,12 @@
 
 #include "types.h"
 
+#include "../array_view.h"
 #include "../globals.h"
 #include "../segmented_vector.h"
 
-#include "../utils/hash.h"
-
-#include <unordered_set>
+#include <limits>
+#include <vector>
 
 namespace numeric_pdb_helper {
 class NumericTaskProxy;
@@ -16,80 +16,68 @@ class NumericTaskProxy;
 
 namespace numeric_pdbs {
 
+/*
+  An abstract state given by the hash of its propositional part and the
+  values of the numeric pattern variables. The numeric values are not owned
+  by the state; for registered states, they live in the registry.
+*/
 struct NumericState {
     std::size_t prop_hash;
-    std::vector<ap_float> num_state;
+    ArrayView<const ap_float> num_state;
 
     NumericState(std::size_t prop_hash,
-                 std::vector<ap_float> num_state) :
+                 ArrayView<const ap_float> num_state) :
             prop_hash(prop_hash),
-            num_state(std::move(num_state)) {}
+            num_state(num_state) {}
 
     std::string get_name(const numeric_pdb_helper::NumericTaskProxy &proxy, const Pattern &pattern) const;
-
-    bool operator==(const NumericState &other) const {
-        return prop_hash == other.prop_hash && num_state == other.num_state;
-    }
-};
-
-struct NumericStateHash {
-    std::size_t operator()(const NumericState &s) const {
-        std::size_t seed = s.prop_hash;
-        utils::hash_combine(seed, s.num_state);
-        return seed;
-    }
 };
 
+/*
+  Registers abstract states with a fixed number of numeric variables. The
+  states are stored as fixed-width rows, i.e., the propositional hashes in
+  a SegmentedVector and the numeric values in a SegmentedArrayVector, and
+  are found with linear probing in an open-addressing table of state ids.
+  Hence, registering a state does not allocate memory per state, and
+  states returned by lookup_state stay valid as long as the registry does.
+*/
 class NumericStateRegistry {
-    struct StateIDSemanticHash {
-        const SegmentedVector <NumericState> &state_data_pool;
-
-        explicit StateIDSemanticHash(const SegmentedVector <NumericState> &state_data_pool_)
-                : state_data_pool(state_data_pool_) {
-        }
-
-        std::size_t operator()(std::size_t id) const {
-            return NumericStateHash{}(state_data_pool[id]);
-        }
-    };
-
-    struct StateIDSemanticEqual {
-        const SegmentedVector <NumericState> &state_data_pool;
-
-        explicit StateIDSemanticEqual(const SegmentedVector <NumericState> &state_data_pool_)
-                : state_data_pool(state_data_pool_) {
-        }
-
-        bool operator()(std::size_t lhs, std::size_t rhs) const {
-            const NumericState &lhs_data = state_data_pool[lhs];
-            const NumericState &rhs_data = state_data_pool[rhs];
-            return lhs_data == rhs_data;
-        }
-    };
-
-    typedef std::unordered_set<std::size_t,
-            StateIDSemanticHash,
-            StateIDSemanticEqual> StateIDSet;
-    SegmentedVector<NumericState> state_data_pool;
-    StateIDSet registered_states;
-
+    int num_numeric_vars;
+    SegmentedVector<std::size_t> prop_hashes;
+    SegmentedArrayVector<ap_float> numeric_values;
+    // State id + 1 for occupied buckets, 0 for empty ones.
+    std::vector<std::size_t> buckets;
+
+    std::size_t compute_hash(std::size_t prop_hash, const ap_float *num_state) const;
+    bool is_equal(std::size_t state_id, std::size_t prop_hash,
+                  const ap_float *num_state) const;
+    /*
+      Returns the bucket that contains the given state or, if the state is
+      not registered, the empty bucket where it would be inserted.
+    */
+    std::size_t find_bucket(std::size_t prop_hash, const ap_float *num_state) const;
+    void grow_buckets();
 public:
-    NumericStateRegistry() : registered_states(0,
-                                               StateIDSemanticHash(state_data_pool),
-                                               StateIDSemanticEqual(state_data_pool)) {}
+    explicit NumericStateRegistry(int num_numeric_vars);
 
-    std::size_t insert_state(const NumericState &state);
+    // Returns the id of the given state after registering it if necessary.
+    std::size_t insert_state(std::size_t prop_hash,
+                             ArrayView<const ap_float> num_state);
 
-    std::size_t get_id(const NumericState &state);
+    // Returns numeric_limits<size_t>::max() if the state is not registered.
+    std::size_t get_id(std::size_t prop_hash,
+                       ArrayView<const ap_float> num_state) const;
 
-    const NumericState &lookup_state(std::size_t state_id) const {
-        assert(state_id < state_data_pool.size());
-        return state_data_pool[state_id];
+    NumericState lookup_state(std::size_t state_id) const {
+        assert(state_id < size());
+        return NumericState(prop_hashes[state_id],
+                            ArrayView<const ap_float>(
+                                numeric_values[state_id], num_numeric_vars));
     }
 
     std::size_t size() const {
-        return state_data_pool.size();
+        return prop_hashes.size();
     }
 };
 }
-#endif
\ No newline at end of file
+#endif
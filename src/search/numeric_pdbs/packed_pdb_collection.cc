@@ -0,0 +1,184 @@
+#include "packed_pdb_collection.h"
+
+#include "pattern_database.h"
+
+#include "../task_proxy.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <limits>
+#include <unordered_map>
+#include <unordered_set>
+
+using namespace std;
+
+namespace numeric_pdbs {
+static const ap_float INFINITE_DISTANCE = numeric_limits<ap_float>::infinity();
+
+// The largest value of T represents dead ends.
+template<typename T>
+static inline ap_float to_distance(T value) {
+    return value == numeric_limits<T>::max() ? INFINITE_DISTANCE : value;
+}
+
+template<typename T>
+static bool can_quantize(const PDBCollection &pdbs) {
+    const ap_float max_distance = numeric_limits<T>::max() - 1;
+    for (const shared_ptr<PatternDatabase> &pdb : pdbs) {
+        const pdbs::CompressedDistances &distances = pdb->get_distances();
+        for (size_t i = 0; i < distances.size(); ++i) {
+            ap_float distance = distances[i];
+            if (distance == numeric_limits<ap_float>::max())
+                continue;
+            if (distance < 0 || distance > max_distance ||
+                distance != floor(distance))
+                return false;
+        }
+    }
+    return true;
+}
+
+template<typename T>
+static void append_distances(const PDBCollection &pdbs, vector<T> &table) {
+    for (const shared_ptr<PatternDatabase> &pdb : pdbs) {
+        const pdbs::CompressedDistances &distances = pdb->get_distances();
+        for (size_t i = 0; i < distances.size(); ++i) {
+            ap_float distance = distances[i];
+            if (distance == numeric_limits<ap_float>::max())
+                table.push_back(numeric_limits<T>::max());
+            else
+                table.push_back(static_cast<T>(distance));
+        }
+    }
+}
+
+PackedPDBCollection::PackedPDBCollection(
+    const MaxAdditivePDBSubsets &max_additive_subsets)
+    : max_pattern_size(0) {
+    PDBCollection packed_pdbs;
+    unordered_set<const PatternDatabase *> seen;
+    for (const PDBCollection &subset : max_additive_subsets) {
+        for (const shared_ptr<PatternDatabase> &pdb : subset) {
+            if (!seen.insert(pdb.get()).second)
+                continue;
+            if (pdb->is_propositional())
+                packed_pdbs.push_back(pdb);
+            else
+                numeric_pdbs.push_back(pdb);
+        }
+    }
+    num_packed_pdbs = packed_pdbs.size();
+
+    unordered_map<const PatternDatabase *, int> pdb_to_index;
+    for (int i = 0; i < num_packed_pdbs; ++i)
+        pdb_to_index[packed_pdbs[i].get()] = i;
+    for (size_t i = 0; i < numeric_pdbs.size(); ++i)
+        pdb_to_index[numeric_pdbs[i].get()] = num_packed_pdbs + i;
+
+    subset_offsets.push_back(0);
+    for (const PDBCollection &subset : max_additive_subsets) {
+        for (const shared_ptr<PatternDatabase> &pdb : subset)
+            subset_members.push_back(pdb_to_index[pdb.get()]);
+        subset_offsets.push_back(subset_members.size());
+    }
+
+    for (const shared_ptr<PatternDatabase> &pdb : packed_pdbs) {
+        max_pattern_size = max(max_pattern_size,
+                               static_cast<int>(pdb->get_pattern().regular.size()));
+    }
+    hash_variables.assign(max_pattern_size * num_packed_pdbs, 0);
+    hash_multipliers.assign(max_pattern_size * num_packed_pdbs, 0);
+    for (int i = 0; i < num_packed_pdbs; ++i) {
+        const vector<int> &pattern = packed_pdbs[i]->get_pattern().regular;
+        const vector<size_t> &multipliers = packed_pdbs[i]->get_hash_multipliers();
+        for (size_t k = 0; k < pattern.size(); ++k) {
+            hash_variables[k * num_packed_pdbs + i] = pattern[k];
+            hash_multipliers[k * num_packed_pdbs + i] = multipliers[k];
+        }
+    }
+
+    pack_distance_tables(packed_pdbs);
+
+    indices.resize(num_packed_pdbs);
+    h_values.resize(num_packed_pdbs + numeric_pdbs.size());
+}
+
+void PackedPDBCollection::pack_distance_tables(const PDBCollection &packed_pdbs) {
+    size_t table_size = 0;
+    for (const shared_ptr<PatternDatabase> &pdb : packed_pdbs) {
+        table_offsets.push_back(table_size);
+        table_size += pdb->get_size();
+    }
+    if (packed_pdbs.empty())
+        return;
+
+    if (can_quantize<uint8_t>(packed_pdbs)) {
+        distances_8.reserve(table_size);
+        append_distances(packed_pdbs, distances_8);
+    } else if (can_quantize<uint16_t>(packed_pdbs)) {
+        distances_16.reserve(table_size);
+        append_distances(packed_pdbs, distances_16);
+    } else {
+        distances.reserve(table_size);
+        append_distances(packed_pdbs, distances);
+    }
+}
+
+template<typename T>
+void PackedPDBCollection::look_up_packed_pdbs(const vector<T> &table) const {
+    const int num_pdbs = num_packed_pdbs;
+    size_t *pdb_indices = indices.data();
+    const int *values = state_values.data();
+    fill(indices.begin(), indices.end(), 0);
+    for (int k = 0; k < max_pattern_size; ++k) {
+        const int *variables = &hash_variables[k * num_pdbs];
+        const size_t *multipliers = &hash_multipliers[k * num_pdbs];
+        for (int i = 0; i < num_pdbs; ++i)
+            pdb_indices[i] += multipliers[i] * values[variables[i]];
+    }
+    const T *entries = table.data();
+    const size_t *offsets = table_offsets.data();
+    ap_float *h = h_values.data();
+    for (int i = 0; i < num_pdbs; ++i)
+        h[i] = to_distance(entries[offsets[i] + pdb_indices[i]]);
+}
+
+ap_float PackedPDBCollection::get_value(const State &state, bool &found_state) const {
+    found_state = num_packed_pdbs > 0;
+    if (num_packed_pdbs > 0) {
+        int num_variables = state.size();
+        state_values.resize(num_variables);
+        for (int var = 0; var < num_variables; ++var)
+            state_values[var] = state[var].get_value();
+
+        if (!distances_8.empty())
+            look_up_packed_pdbs(distances_8);
+        else if (!distances_16.empty())
+            look_up_packed_pdbs(distances_16);
+        else
+            look_up_packed_pdbs(distances);
+    }
+
+    for (size_t i = 0; i < numeric_pdbs.size(); ++i) {
+        auto [found_state_pdb, h] = numeric_pdbs[i]->get_value(state);
+        if (found_state_pdb)
+            found_state = true;
+        h_values[num_packed_pdbs + i] = to_distance(h);
+    }
+
+    // If we have an empty collection, then max_additive_subsets = { \emptyset }.
+    assert(subset_offsets.size() > 1);
+    ap_float max_h = 0;
+    int num_subsets = subset_offsets.size() - 1;
+    for (int subset = 0; subset < num_subsets; ++subset) {
+        ap_float subset_h = 0;
+        for (int i = subset_offsets[subset]; i < subset_offsets[subset + 1]; ++i)
+            subset_h += h_values[subset_members[i]];
+        max_h = max(max_h, subset_h);
+    }
+    if (max_h == INFINITE_DISTANCE)
+        return numeric_limits<ap_float>::max();
+    return max_h;
+}
+}
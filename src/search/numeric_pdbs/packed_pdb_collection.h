@@ -0,0 +1,83 @@
+#ifndef NUMERIC_PDBS_PACKED_PDB_COLLECTION_H
+#define NUMERIC_PDBS_PACKED_PDB_COLLECTION_H
+
+#include "types.h"
+
+#include "../globals.h"
+
+#include <cstdint>
+#include <vector>
+
+class State;
+
+namespace numeric_pdbs {
+/*
+  Evaluates the canonical heuristic for a fixed collection of maximal
+  additive PDB subsets.
+
+  The distance tables of all purely propositional PDBs are copied into one
+  contiguous table. If all their finite distances are small non-negative
+  integers, the table is stored with 8 or 16 bits per entry, using the
+  largest representable value for dead ends, so the compression is
+  lossless. The hash multipliers are stored as a structure of arrays, such
+  that the indices of all propositional PDBs are computed together in
+  tight loops the compiler can vectorize. PDBs with numeric variables are
+  looked up individually.
+
+  The heuristic values of all PDBs are then combined with the additive
+  subsets without branching: dead ends are represented by infinity while
+  summing and taking the maximum.
+*/
+class PackedPDBCollection {
+    int num_packed_pdbs;
+    int max_pattern_size;
+
+    /*
+      The k-th variable of the pattern of packed PDB i and its hash
+      multiplier are stored at position k * num_packed_pdbs + i. Shorter
+      patterns are padded with variable 0 and multiplier 0.
+    */
+    std::vector<int> hash_variables;
+    std::vector<std::size_t> hash_multipliers;
+    // The table of packed PDB i starts at table_offsets[i].
+    std::vector<std::size_t> table_offsets;
+
+    // Exactly one of the distance tables is used.
+    std::vector<ap_float> distances;
+    std::vector<uint16_t> distances_16;
+    std::vector<uint8_t> distances_8;
+
+    // PDBs with numeric variables, evaluated after the packed ones.
+    PDBCollection numeric_pdbs;
+
+    /*
+      The additive subsets as indices into h_values, in compressed sparse
+      row format.
+    */
+    std::vector<int> subset_offsets;
+    std::vector<int> subset_members;
+
+    // Avoid reallocation.
+    mutable std::vector<int> state_values;
+    mutable std::vector<std::size_t> indices;
+    mutable std::vector<ap_float> h_values;
+
+    void pack_distance_tables(const PDBCollection &packed_pdbs);
+
+    template<typename T>
+    void look_up_packed_pdbs(const std::vector<T> &table) const;
+public:
+    explicit PackedPDBCollection(const MaxAdditivePDBSubsets &max_additive_subsets);
+    ~PackedPDBCollection() = default;
+
+    /*
+      Returns the maximum over all additive subsets of the sum of their
+      heuristic values, or numeric_limits<ap_float>::max() if any PDB
+      detects a dead end. found_state is set to true iff some PDB contains
+      an abstract state for the given state.
+    */
+    ap_float get_value(const State &state, bool &found_state) const;
+};
+}
+
+#endif
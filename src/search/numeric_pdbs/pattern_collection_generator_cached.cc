@@ -0,0 +1,207 @@
+#include "pattern_collection_generator_cached.h"
+
+#include "validation.h"
+
+#include "../option_parser.h"
+#include "../plugin.h"
+#include "../task_tools.h"
+
+#include "../utils/system.h"
+#include "../utils/timer.h"
+
+#include <cstdio>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+
+using namespace std;
+using numeric_pdb_helper::NumericTaskProxy;
+
+namespace numeric_pdbs {
+static const int CACHE_FILE_VERSION = 1;
+
+static void read_int_list(istream &in, vector<int> &values) {
+    int size;
+    in >> size;
+    if (!in || size < 0) {
+        in.setstate(ios::failbit);
+        return;
+    }
+    values.resize(size);
+    for (int &value : values)
+        in >> value;
+}
+
+static void write_int_list(ostream &out, const vector<int> &values) {
+    out << values.size();
+    for (int value : values)
+        out << " " << value;
+}
+
+PatternCollectionGeneratorCached::PatternCollectionGeneratorCached(
+    const Options &opts)
+    : PatternCollectionGenerator(
+          opts.get<shared_ptr<PatternCollectionGenerator>>("generator")
+          ->get_max_number_pdb_states()),
+      generator(opts.get<shared_ptr<PatternCollectionGenerator>>("generator")),
+      cache_dir(opts.get<string>("cache_dir")),
+      match_initial_state(opts.get<bool>("match_initial_state")),
+      config(opts.get_unparsed_config()) {
+}
+
+string PatternCollectionGeneratorCached::get_cache_file(uint64_t key) const {
+    ostringstream filename;
+    filename << cache_dir << "/numeric_patterns_"
+             << hex << setw(16) << setfill('0') << key << ".txt";
+    return filename.str();
+}
+
+bool PatternCollectionGeneratorCached::load_patterns(
+    const string &filename, uint64_t key, PatternCollection &patterns) const {
+    ifstream in(filename);
+    if (!in)
+        return false;
+    string word;
+    int version;
+    in >> word >> version;
+    if (!in || word != "numeric_patterns" || version != CACHE_FILE_VERSION) {
+        cout << "Ignoring pattern cache file with unknown format: "
+             << filename << endl;
+        return false;
+    }
+    uint64_t file_key;
+    string file_config;
+    in >> word >> hex >> file_key >> dec;
+    in >> ws;
+    getline(in, file_config);
+    /*
+      The key is part of the file name, so a different key or configuration
+      means that the file was modified or that two tasks collide.
+    */
+    if (!in || file_key != key || file_config != "config " + config) {
+        cout << "Ignoring pattern cache file of another task or "
+             << "configuration: " << filename << endl;
+        return false;
+    }
+    int num_patterns;
+    in >> word >> num_patterns;
+    if (!in || word != "patterns" || num_patterns < 0) {
+        cout << "Ignoring corrupted pattern cache file: " << filename << endl;
+        return false;
+    }
+    patterns.resize(num_patterns);
+    for (Pattern &pattern : patterns) {
+        read_int_list(in, pattern.regular);
+        read_int_list(in, pattern.numeric);
+    }
+    if (!in) {
+        cout << "Ignoring corrupted pattern cache file: " << filename << endl;
+        patterns.clear();
+        return false;
+    }
+    return true;
+}
+
+void PatternCollectionGeneratorCached::save_patterns(
+    const string &filename, uint64_t key,
+    const PatternCollection &patterns) const {
+    /*
+      Write to a temporary file first, so that planners that run at the same
+      time never read a partially written cache file. The name of the
+      temporary file contains the process ID, so that these planners do not
+      write to the same temporary file.
+    */
+    string tmp_filename =
+        filename + "." + to_string(utils::get_process_id()) + ".tmp";
+    {
+        ofstream out(tmp_filename);
+        out << "numeric_patterns " << CACHE_FILE_VERSION << endl;
+        out << "key " << hex << key << dec << endl;
+        out << "config " << config << endl;
+        out << "patterns " << patterns.size() << endl;
+        for (const Pattern &pattern : patterns) {
+            write_int_list(out, pattern.regular);
+            out << " ";
+            write_int_list(out, pattern.numeric);
+            out << endl;
+        }
+        if (!out) {
+            cout << "Could not write pattern cache file " << filename << endl;
+            remove(tmp_filename.c_str());
+            return;
+        }
+    }
+    if (rename(tmp_filename.c_str(), filename.c_str()) != 0) {
+        cout << "Could not write pattern cache file " << filename << endl;
+        remove(tmp_filename.c_str());
+        return;
+    }
+    cout << "Stored patterns in cache file " << filename << endl;
+}
+
+PatternCollectionInformation PatternCollectionGeneratorCached::generate(
+    shared_ptr<AbstractTask> task) {
+    utils::Timer timer;
+    TaskProxy task_proxy(*task);
+    uint64_t key = extend_stable_hash(
+        compute_static_task_hash(task_proxy), config);
+    if (match_initial_state)
+        key = extend_stable_hash(key, compute_initial_state_hash(task_proxy));
+    string filename = get_cache_file(key);
+
+    shared_ptr<PatternCollection> patterns = make_shared<PatternCollection>();
+    if (load_patterns(filename, key, *patterns)) {
+        auto numeric_task_proxy = make_shared<NumericTaskProxy>(task);
+        validate_and_normalize_patterns(*numeric_task_proxy, *patterns);
+        cout << "Loaded " << patterns->size() << " patterns from cache file "
+             << filename << " in " << timer << endl;
+        return {numeric_task_proxy, patterns, max_number_pdb_states};
+    }
+
+    cout << "No pattern cache file " << filename
+         << ", running the pattern generator" << endl;
+    PatternCollectionInformation pattern_collection_info =
+        generator->generate(task);
+    save_patterns(filename, key, *pattern_collection_info.get_patterns());
+    return pattern_collection_info;
+}
+
+static shared_ptr<PatternCollectionGenerator> _parse(OptionParser &parser) {
+    parser.document_synopsis(
+        "Cached patterns",
+        "Runs the given pattern collection generator once and stores the "
+        "patterns in a file in cache_dir. Later runs on a task with the same "
+        "variables, operators, axioms and goal load the patterns from this "
+        "file instead of running the generator again. This is useful when "
+        "the same task is solved many times from different initial states, "
+        "e.g. when replanning.");
+    parser.document_note(
+        "Initial states",
+        "By default, the patterns are reused for all initial states. They "
+        "are valid for every initial state, but generators that evaluate "
+        "patterns on samples (e.g. numeric_hillclimbing) might find better "
+        "patterns for the new initial state. Use match_initial_state=true to "
+        "only reuse patterns for the initial state they were computed for. "
+        "The PDBs are always computed for the current task.");
+    parser.add_option<shared_ptr<PatternCollectionGenerator>>(
+        "generator",
+        "pattern collection generator whose patterns are cached");
+    parser.add_option<string>(
+        "cache_dir",
+        "directory for the cache files",
+        ".");
+    parser.add_option<bool>(
+        "match_initial_state",
+        "include the initial state in the key of the cache file",
+        "false");
+
+    Options opts = parser.parse();
+    if (parser.dry_run())
+        return nullptr;
+
+    return make_shared<PatternCollectionGeneratorCached>(opts);
+}
+
+static PluginShared<PatternCollectionGenerator> _plugin("numeric_cached_patterns", _parse);
+}
@@ -0,0 +1,46 @@
+#ifndef NUMERIC_PDBS_PATTERN_COLLECTION_GENERATOR_CACHED_H
+#define NUMERIC_PDBS_PATTERN_COLLECTION_GENERATOR_CACHED_H
+
+#include "pattern_generator.h"
+#include "types.h"
+
+#include <memory>
+#include <string>
+
+namespace options {
+class Options;
+}
+
+namespace numeric_pdbs {
+/*
+  Stores the patterns computed by another pattern collection generator in a
+  file and loads them instead of running the generator again when the same
+  task (up to its initial state) is solved with the same configuration. The
+  file name contains a hash of the static structure of the task (see
+  compute_static_task_hash) and of the configuration of this generator.
+
+  Only the patterns are stored. The PDBs are always built from scratch,
+  because their distances depend on the initial state of the numeric
+  variables.
+*/
+class PatternCollectionGeneratorCached : public PatternCollectionGenerator {
+    const std::shared_ptr<PatternCollectionGenerator> generator;
+    const std::string cache_dir;
+    const bool match_initial_state;
+    const std::string config;
+
+    std::string get_cache_file(uint64_t key) const;
+    bool load_patterns(const std::string &filename, uint64_t key,
+                       PatternCollection &patterns) const;
+    void save_patterns(const std::string &filename, uint64_t key,
+                       const PatternCollection &patterns) const;
+public:
+    explicit PatternCollectionGeneratorCached(const options::Options &opts);
+    virtual ~PatternCollectionGeneratorCached() = default;
+
+    virtual PatternCollectionInformation generate(
+        std::shared_ptr<AbstractTask> task) override;
+};
+}
+
+#endif
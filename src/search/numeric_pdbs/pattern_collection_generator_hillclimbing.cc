@@ -18,13 +18,16 @@
 #include "../utils/markup.h"
 #include "../utils/math.h"
 #include "../utils/memory.h"
+#include "../utils/parallel.h"
 #include "../utils/timer.h"
 
 #include <algorithm>
+#include <atomic>
 #include <cassert>
 #include <exception>
 #include <iostream>
 #include <limits>
+#include <unordered_map>
 
 using namespace std;
 using namespace numeric_pdb_helper;
@@ -39,7 +42,10 @@ PatternCollectionGeneratorHillclimbing::PatternCollectionGeneratorHillclimbing(c
       min_improvement(opts.get<int>("min_improvement")),
       max_time(opts.get<double>("max_time")),
       max_pdb_size(opts.get<int>("max_pdb_size")),
+      pdb_threads(opts.get<int>("pdb_threads")),
+      num_threads(opts.get<int>("num_threads")),
       num_rejected(0),
+      pdb_construction_time(0),
       hill_climbing_timer(nullptr) {
 }
 
@@ -151,22 +157,33 @@ void PatternCollectionGeneratorHillclimbing::generate_candidate_patterns(
 
 size_t PatternCollectionGeneratorHillclimbing::generate_pdbs_for_candidates(
     const shared_ptr<NumericTaskProxy> &task_proxy, set<Pattern> &generated_patterns,
-    PatternCollection &new_candidates, PDBCollection &candidate_pdbs) const {
+    PatternCollection &new_candidates, PDBCollection &candidate_pdbs) {
     /*
       For the new candidate patterns check whether they already have been
       candidates before and thus already a PDB has been created an inserted into
       candidate_pdbs.
     */
-    size_t max_pdb_size = 0;
+    PatternCollection new_patterns;
     for (const Pattern &new_candidate : new_candidates) {
-        if (generated_patterns.count(new_candidate) == 0) {
-            candidate_pdbs.push_back(
-                make_shared<PatternDatabase>(task_proxy, new_candidate, max_number_pdb_states));
-            max_pdb_size = max(max_pdb_size,
-                               candidate_pdbs.back()->get_size());
-            generated_patterns.insert(new_candidate);
+        if (generated_patterns.insert(new_candidate).second) {
+            new_patterns.push_back(new_candidate);
         }
     }
+
+    utils::Timer pdb_timer;
+    PDBCollection new_pdbs(new_patterns.size());
+    utils::parallel_for(new_patterns.size(), num_threads, [&](size_t i) {
+            new_pdbs[i] = make_shared<PatternDatabase>(
+                task_proxy, new_patterns[i], max_number_pdb_states,
+                false, vector<ap_float>(), pdb_threads);
+        });
+    pdb_construction_time += pdb_timer();
+
+    size_t max_pdb_size = 0;
+    for (const shared_ptr<PatternDatabase> &pdb : new_pdbs) {
+        max_pdb_size = max(max_pdb_size, pdb->get_size());
+        candidate_pdbs.push_back(pdb);
+    }
     return max_pdb_size;
 }
 
@@ -189,6 +206,25 @@ void PatternCollectionGeneratorHillclimbing::sample_states(
     }
 }
 
+PatternCollectionGeneratorHillclimbing::SampleValues
+PatternCollectionGeneratorHillclimbing::compute_sample_values(
+    const vector<State> &samples) const {
+    SampleValues sample_values;
+    sample_values.collection.reserve(samples.size());
+    for (const State &sample : samples) {
+        sample_values.collection.push_back(current_pdbs->get_value(sample));
+    }
+    for (const shared_ptr<PatternDatabase> &pdb : *current_pdbs->get_pattern_databases()) {
+        vector<ap_float> pdb_values;
+        pdb_values.reserve(samples.size());
+        for (const State &sample : samples) {
+            pdb_values.push_back(pdb->get_value(sample).second);
+        }
+        sample_values.pdbs.push_back(move(pdb_values));
+    }
+    return sample_values;
+}
+
 std::pair<int, int> PatternCollectionGeneratorHillclimbing::find_best_improving_pdb(
     vector<State> &samples, PDBCollection &candidate_pdbs) {
     /*
@@ -198,14 +234,8 @@ std::pair<int, int> PatternCollectionGeneratorHillclimbing::find_best_improving_
       We require that a pattern must have an improvement of at least one in
       order to be taken into account.
     */
-    int improvement = 0;
-    int best_pdb_index = -1;
-
-    // Iterate over all candidates and search for the best improving pattern/pdb
+    vector<size_t> candidates;
     for (size_t i = 0; i < candidate_pdbs.size(); ++i) {
-        if (hill_climbing_timer->is_expired())
-            throw HillClimbingTimeout();
-
         const shared_ptr<PatternDatabase> &pdb = candidate_pdbs[i];
         if (!pdb) {
             /* candidate pattern is too large or has already been added to
@@ -221,26 +251,72 @@ std::pair<int, int> PatternCollectionGeneratorHillclimbing::find_best_improving_
             candidate_pdbs[i] = nullptr;
             continue;
         }
+        candidates.push_back(i);
+    }
 
-        /*
-          Calculate the "counting approximation" for all sample states: count
-          the number of samples for which the current pattern collection
-          heuristic would be improved if the new pattern was included into it.
-        */
-        /*
-          TODO: The original implementation by Haslum et al. uses m/t as a
-          statistical confidence interval to stop the A*-search (which they use,
-          see above) earlier.
-        */
-        int count = 0;
-        MaxAdditivePDBSubsets max_additive_subsets =
-            current_pdbs->get_max_additive_subsets(pdb->get_pattern());
-        for (const State &sample : samples) {
-            if (is_heuristic_improved(*pdb, sample, max_additive_subsets))
-                ++count;
-        }
-        if (count > improvement) {
-            improvement = count;
+    SampleValues sample_values = compute_sample_values(samples);
+    unordered_map<const PatternDatabase *, int> pdb_ids;
+    const PDBCollection &current_collection = *current_pdbs->get_pattern_databases();
+    for (size_t i = 0; i < current_collection.size(); ++i) {
+        pdb_ids[current_collection[i].get()] = i;
+    }
+
+    // -1 for candidates whose evaluation stopped early
+    vector<int> counts(candidate_pdbs.size(), -1);
+    atomic<int> improvement(0);
+    utils::parallel_for(candidates.size(), num_threads, [&](size_t candidate) {
+            if (hill_climbing_timer->is_expired())
+                throw HillClimbingTimeout();
+
+            size_t i = candidates[candidate];
+            const PatternDatabase &pdb = *candidate_pdbs[i];
+            vector<vector<int>> max_additive_subsets;
+            for (const PDBCollection &subset :
+                 current_pdbs->get_max_additive_subsets(pdb.get_pattern())) {
+                vector<int> subset_ids;
+                for (const shared_ptr<PatternDatabase> &additive_pdb : subset) {
+                    subset_ids.push_back(pdb_ids.at(additive_pdb.get()));
+                }
+                max_additive_subsets.push_back(move(subset_ids));
+            }
+
+            /*
+              Calculate the "counting approximation" for all sample states:
+              count the number of samples for which the current pattern
+              collection heuristic would be improved if the new pattern was
+              included into it. We stop once the candidate cannot reach the
+              best improvement found so far. Candidates that can only tie
+              are evaluated completely, so the chosen candidate does not
+              depend on the order in which the candidates are evaluated.
+            */
+            /*
+              TODO: The original implementation by Haslum et al. uses m/t as a
+              statistical confidence interval to stop the A*-search (which they use,
+              see above) earlier.
+            */
+            int count = 0;
+            for (size_t sample_id = 0; sample_id < samples.size(); ++sample_id) {
+                int num_remaining = samples.size() - sample_id;
+                if (count + num_remaining < improvement.load()) {
+                    return;
+                }
+                if (is_heuristic_improved(pdb, samples[sample_id], sample_id,
+                                          sample_values, max_additive_subsets))
+                    ++count;
+            }
+            counts[i] = count;
+            int best_count = improvement.load();
+            while (count > best_count &&
+                   !improvement.compare_exchange_weak(best_count, count)) {
+            }
+        });
+
+    int best_improvement = 0;
+    int best_pdb_index = -1;
+    for (size_t i : candidates) {
+        int count = counts[i];
+        if (count > best_improvement) {
+            best_improvement = count;
             best_pdb_index = i;
         }
         if (count > 0) {
@@ -250,12 +326,13 @@ std::pair<int, int> PatternCollectionGeneratorHillclimbing::find_best_improving_
         }
     }
 
-    return make_pair(improvement, best_pdb_index);
+    return make_pair(best_improvement, best_pdb_index);
 }
 
 bool PatternCollectionGeneratorHillclimbing::is_heuristic_improved(
-    const PatternDatabase &pdb, const State &sample,
-    const MaxAdditivePDBSubsets &max_additive_subsets) {
+    const PatternDatabase &pdb, const State &sample, size_t sample_id,
+    const SampleValues &sample_values,
+    const vector<vector<int>> &max_additive_subsets) const {
     // h_pattern: h-value of the new pattern
     ap_float h_pattern = pdb.get_value(sample).second;
 
@@ -264,17 +341,15 @@ bool PatternCollectionGeneratorHillclimbing::is_heuristic_improved(
     }
 
     // h_collection: h-value of the current collection heuristic
-    ap_float h_collection = current_pdbs->get_value(sample);
+    ap_float h_collection = sample_values.collection[sample_id];
     if (h_collection == numeric_limits<ap_float>::max()){
         return false;
     }
 
-    for (const auto &subset : max_additive_subsets) {
+    for (const vector<int> &subset : max_additive_subsets) {
         ap_float h_subset = 0;
-        for (const shared_ptr<PatternDatabase> &additive_pdb : subset) {
-            /* Experiments showed that it is faster to recompute the
-               h values than to cache them in an unordered_map. */
-            ap_float h = additive_pdb->get_value(sample).second;
+        for (int pdb_id : subset) {
+            ap_float h = sample_values.pdbs[pdb_id][sample_id];
             if (h == numeric_limits<ap_float>::max()) {
                 return false;
             }
@@ -348,7 +423,7 @@ void PatternCollectionGeneratorHillclimbing::hill_climbing(
             cout << "found a better pattern with improvement " << improvement
                  << endl;
             cout << "pattern: " << best_pattern.regular << best_pattern.numeric << endl;
-            current_pdbs->add_pattern(best_pattern);
+            current_pdbs->add_pdb(best_pdb);
 
             /* Clear current new_candidates and get successors for next
                iteration. */
@@ -372,6 +447,7 @@ void PatternCollectionGeneratorHillclimbing::hill_climbing(
     cout << "iPDB: generated = " << generated_patterns.size() << endl;
     cout << "iPDB: rejected = " << num_rejected << endl;
     cout << "iPDB: maximum pdb size = " << max_pdb_size << endl;
+    cout << "iPDB: candidate PDB construction time: " << pdb_construction_time << "s" << endl;
     cout << "iPDB: hill climbing time: " << *hill_climbing_timer << endl;
 
     delete hill_climbing_timer;
@@ -444,6 +520,20 @@ void add_hillclimbing_options(OptionParser &parser) {
             "bound on the domain-size product of variables in a pattern",
             "1000000",
             Bounds("1", "infinity"));
+    parser.add_option<int>(
+            "pdb_threads",
+            "number of threads used to generate the successors of the abstract "
+            "states when building a candidate PDB with numeric variables; "
+            "the resulting PDBs do not depend on this number",
+            "1",
+            Bounds("1", "infinity"));
+    parser.add_option<int>(
+            "num_threads",
+            "number of threads used to build and evaluate the candidate PDBs "
+            "of an iteration; the resulting pattern collection does not "
+            "depend on this number",
+            "1",
+            Bounds("1", "infinity"));
     parser.add_option<int>(
             "collection_max_size",
             "maximal number of states in the pattern collection",
@@ -39,11 +39,16 @@ class PatternCollectionGeneratorHillclimbing : public PatternCollectionGenerator
     const double max_time;
 
     const int max_pdb_size;
+    // number of threads used to construct each candidate PDB
+    const int pdb_threads;
+    // number of threads used to construct and evaluate the candidate PDBs
+    const int num_threads;
 
     std::unique_ptr<IncrementalCanonicalPDBs> current_pdbs;
 
     // for stats only
     int num_rejected;
+    double pdb_construction_time;
     utils::CountdownTimer *hill_climbing_timer;
 
     /*
@@ -64,7 +69,7 @@ class PatternCollectionGeneratorHillclimbing : public PatternCollectionGenerator
             const std::shared_ptr<numeric_pdb_helper::NumericTaskProxy> &num_task_proxy,
             std::set<Pattern> &generated_patterns,
             PatternCollection &new_candidates,
-            PDBCollection &candidate_pdbs) const;
+            PDBCollection &candidate_pdbs);
 
     /*
       Performs num_samples random walks with a length (different for each
@@ -82,10 +87,26 @@ class PatternCollectionGeneratorHillclimbing : public PatternCollectionGenerator
             std::vector<State> &samples,
             ap_float average_operator_cost);
 
+    /*
+      The h-values of the current pattern collection and of each of its PDBs
+      for the samples of one iteration. They are the same for all candidates,
+      so we compute them once per iteration instead of once per candidate.
+    */
+    struct SampleValues {
+        std::vector<ap_float> collection;
+        // pdbs[i][j]: h-value of the i-th PDB of the collection for sample j
+        std::vector<std::vector<ap_float>> pdbs;
+    };
+
+    SampleValues compute_sample_values(const std::vector<State> &samples) const;
+
     /*
       Searches for the best improving pdb in candidate_pdbs according to the
       counting approximation and the given samples. Returns the improvement and
-      the index of the best pdb in candidate_pdbs.
+      the index of the best pdb in candidate_pdbs. The candidates are evaluated
+      in parallel. The evaluation of a candidate stops as soon as it cannot
+      reach the best improvement found so far; among the candidates with the
+      best improvement, the one with the smallest index is chosen.
     */
     std::pair<int, int> find_best_improving_pdb(
         std::vector<State> &samples,
@@ -95,12 +116,15 @@ class PatternCollectionGeneratorHillclimbing : public PatternCollectionGenerator
       Returns true iff the h-value of the new pattern (from pdb) plus the
       h-value of all maximal additive subsets from the current pattern
       collection heuristic if the new pattern was added to it is greater than
-      the h-value of the current pattern collection.
+      the h-value of the current pattern collection. The subsets are given
+      by the indices of their PDBs in the current collection.
     */
     bool is_heuristic_improved(
         const PatternDatabase &pdb,
         const State &sample,
-        const MaxAdditivePDBSubsets &max_additive_subsets);
+        std::size_t sample_id,
+        const SampleValues &sample_values,
+        const std::vector<std::vector<int>> &max_additive_subsets) const;
 
     /*
       This is the core algorithm of this class. As soon as after an iteration,
@@ -109,12 +133,8 @@ class PatternCollectionGeneratorHillclimbing : public PatternCollectionGenerator
       uses a vector to store PDBs to avoid re-computation of the same PDBs
       later. This is quite a large time gain, but may use too much memory. Also
       a set is used to store all patterns in their "normal form" for duplicate
-      detection.
-      TODO: This method computes all PDBs already for candidate iteration, but
-      for each call of add_pattern for the current CanonicalPDBsHeuristic, only
-      the pattern is passed as an argument and in CanonicalPDBsHeuristic, the
-      PDB is *again* built. One could possibly avoid this by passing the PDB and
-      adapt CanonicalPDBsHeuristic accordingly.
+      detection. The PDB of the best candidate is added to the current
+      collection directly, so it is not built again.
     */
     void hill_climbing(
         const std::shared_ptr<numeric_pdb_helper::NumericTaskProxy> &num_task_proxy,
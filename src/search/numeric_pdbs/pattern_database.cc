@@ -9,6 +9,7 @@
 
 #include "../utils/logging.h"
 #include "../utils/math.h"
+#include "../utils/parallel.h"
 
 #include <algorithm>
 #include <cassert>
@@ -23,6 +24,59 @@ using namespace numeric_condition;
 using namespace numeric_pdb_helper;
 
 namespace numeric_pdbs {
+/*
+  Layers with fewer states than this per thread are expanded sequentially,
+  because starting the threads would take longer than the expansion.
+*/
+static const size_t MIN_STATES_PER_THREAD = 256;
+
+/*
+  The successors of a contiguous range of states of one layer, stored in
+  flat vectors. The successors of the i-th state are the entries
+  begin[i], ..., begin[i + 1] - 1.
+*/
+struct LayerSuccessors {
+    int num_numeric_vars;
+    vector<bool> is_goal;
+    vector<size_t> begin;
+    vector<int> op_ids;
+    vector<ap_float> costs;
+    vector<size_t> prop_hashes;
+    vector<ap_float> numeric_values;
+
+    explicit LayerSuccessors(int num_numeric_vars)
+        : num_numeric_vars(num_numeric_vars) {
+    }
+
+    void clear() {
+        is_goal.clear();
+        begin.clear();
+        op_ids.clear();
+        costs.clear();
+        prop_hashes.clear();
+        numeric_values.clear();
+    }
+
+    size_t get_num_states() const {
+        return is_goal.size();
+    }
+
+    void add_successor(int op_id, ap_float cost, size_t prop_hash,
+                       const vector<ap_float> &num_state) {
+        op_ids.push_back(op_id);
+        costs.push_back(cost);
+        prop_hashes.push_back(prop_hash);
+        numeric_values.insert(numeric_values.end(),
+                              num_state.begin(), num_state.end());
+    }
+
+    ArrayView<const ap_float> get_numeric_values(size_t successor) const {
+        return ArrayView<const ap_float>(
+            numeric_values.data() + successor * num_numeric_vars,
+            num_numeric_vars);
+    }
+};
+
 AbstractOperator::AbstractOperator(const vector<pair<int, int>> &prev_pairs,
                                    const vector<pair<int, int>> &pre_pairs,
                                    const vector<pair<int, int>> &eff_pairs,
@@ -93,7 +147,8 @@ PatternDatabase::PatternDatabase(
         const Pattern &pattern,
         size_t max_number_states,
         bool dump,
-        const vector<ap_float> &operator_costs)
+        const vector<ap_float> &operator_costs,
+        int num_threads)
         : task_proxy(task_proxy),
           pattern(pattern),
           min_action_cost(numeric_limits<ap_float>::max()),
@@ -123,10 +178,13 @@ PatternDatabase::PatternDatabase(
     if (pattern.numeric.empty()){
         create_pdb_propositional(domain_size_product, operator_costs);
     } else {
-        create_pdb(max_number_states, operator_costs, dump);
+        create_pdb(max_number_states, operator_costs, dump, num_threads);
     }
-    if (dump)
+    if (dump) {
         cout << "PDB construction time: " << timer << endl;
+        cout << "PDB size: " << get_size() << " abstract states with "
+             << distances.get_bytes_per_entry() << " bytes per entry" << endl;
+    }
 }
 
 void PatternDatabase::multiply_out(
@@ -241,21 +299,22 @@ bool PatternDatabase::is_applicable(const NumericState &state,
     return true;
 }
 
-vector<ap_float> PatternDatabase::get_numeric_successor(vector<ap_float> state,
-                                                        const NumericOperatorProxy &op,
-                                                        const vector<int> &num_variable_to_index) const {
+void PatternDatabase::get_numeric_successor(const NumericState &state,
+                                            const NumericOperatorProxy &op,
+                                            const vector<int> &num_variable_to_index,
+                                            vector<ap_float> &successor) const {
+    successor.assign(state.num_state.begin(), state.num_state.end());
     const vector<ap_float> &num_effs = task_proxy->get_action_eff_list(op.get_id());
     for (int var: pattern.numeric) {
         int num_index = num_variable_to_index[var];
-        state[num_index] += num_effs[task_proxy->get_regular_var_id(var)];
+        successor[num_index] += num_effs[task_proxy->get_regular_var_id(var)];
     }
     for (auto &[var_id, value] : op.get_assign_effects()){
         int pattern_id = num_variable_to_index[var_id];
         if (pattern_id != -1){
-            state[pattern_id] = value;
+            successor[pattern_id] = value;
         }
     }
-    return state;
 }
 
 void PatternDatabase::build_goals(const vector<int> &variable_to_index,
@@ -279,7 +338,8 @@ void PatternDatabase::build_goals(const vector<int> &variable_to_index,
 
 void PatternDatabase::create_pdb(size_t max_number_states,
                                  const std::vector<ap_float> &operator_costs,
-                                 bool dump) {
+                                 bool dump,
+                                 int num_threads) {
 
     // TODO: implement specialized efficient variants for the nice cases, e.g.
     //  all numeric variables have an equality goal => we can do regression in this case,
@@ -293,7 +353,8 @@ void PatternDatabase::create_pdb(size_t max_number_states,
     //  is as dense as possible, and only having it just large enough to fit the abstract state with highest ID that has
     //  a finite heuristic value, with all others being deadends or mapped to min_action_cost by convention.
 
-    auto tmp_state_registry = new NumericStateRegistry();
+    auto tmp_state_registry = make_unique<NumericStateRegistry>(pattern.numeric.size());
+    vector<ap_float> search_distances;
 
     VariablesProxy vars = task_proxy->get_variables();
     vector<int> variable_to_index(vars.size(), -1);
@@ -372,7 +433,7 @@ void PatternDatabase::create_pdb(size_t max_number_states,
         for (int var: pattern.numeric) {
             num_init[num_variable_to_index[var]] = num_vars[var].get_initial_state_value();
         }
-        size_t init_state_id = tmp_state_registry->insert_state(NumericState(prop_init, std::move(num_init)));
+        size_t init_state_id = tmp_state_registry->insert_state(prop_init, num_init);
         open.push(0, init_state_id);
 
         /*
@@ -402,108 +463,148 @@ void PatternDatabase::create_pdb(size_t max_number_states,
          *
          */
 
-        while (!open.empty() && num_reached_states < max_number_states) {
-            auto [cost, state_id] = open.pop();
-            assert(cost >= 0 && cost < numeric_limits<ap_float>::max());
-
-            if (state_id >= closed.size()) {
-                closed.resize(state_id + 1, false);
-            } else if (closed[state_id]) {
-                // we don't do duplicate checking in the open list
-                continue;
-            }
-            closed[state_id] = true;
-
-            const NumericState &state = tmp_state_registry->lookup_state(state_id);
-
-            if (is_goal_state(state, num_variable_to_index)) {
-                goal_states.push_back(state_id);
-            }
-
+        /*
+          Generates the successors of the given states. This only reads the
+          registry, so it can run concurrently for different ranges of a
+          layer.
+        */
+        auto expand = [&](const size_t *states, size_t num_states,
+                          LayerSuccessors &successors) {
+            successors.clear();
             vector<const AbstractOperator *> applicable_operators;
-            match_tree.get_applicable_operators(state.prop_hash, applicable_operators);
-
-            for (auto abs_op: applicable_operators) {
-                const auto &op = task_proxy->get_operators()[abs_op->get_op_id()];
-                if (!is_applicable(state, op, num_variable_to_index)) {
-                    continue;
-                }
-
-                size_t prop_successor = state.prop_hash + abs_op->get_hash_effect();
-
-                vector<ap_float> num_successor = get_numeric_successor(state.num_state,
-                                                                       op,
-                                                                       num_variable_to_index);
-
-                size_t succ_id = tmp_state_registry->insert_state(NumericState(prop_successor, std::move(num_successor)));
-
-                if (succ_id == state_id) {
-                    // no need to keep self-loops
-                    continue;
+            vector<ap_float> num_successor;
+            for (size_t i = 0; i < num_states; ++i) {
+                NumericState state = tmp_state_registry->lookup_state(states[i]);
+                successors.is_goal.push_back(is_goal_state(state, num_variable_to_index));
+                successors.begin.push_back(successors.op_ids.size());
+
+                applicable_operators.clear();
+                match_tree.get_applicable_operators(state.prop_hash, applicable_operators);
+                for (auto abs_op: applicable_operators) {
+                    const auto &op = task_proxy->get_operators()[abs_op->get_op_id()];
+                    if (!is_applicable(state, op, num_variable_to_index)) {
+                        continue;
+                    }
+                    get_numeric_successor(state, op, num_variable_to_index, num_successor);
+                    successors.add_successor(abs_op->get_op_id(), abs_op->get_cost(),
+                                             state.prop_hash + abs_op->get_hash_effect(),
+                                             num_successor);
                 }
 
-                if (parent_pointers.size() <= succ_id) {
-                    parent_pointers.resize(succ_id + 1);
-                }
-                parent_pointers[succ_id].emplace_back(abs_op->get_op_id(), state_id);
-                if (succ_id >= closed.size() || !closed[succ_id]) {
-                    if (succ_id >= is_open_or_closed.size()){
-                        is_open_or_closed.resize(succ_id + 1, false);
+                for (auto op_id: num_operators) {
+                    const auto &op = task_proxy->get_operators()[op_id];
+                    if (!is_applicable(state, op, num_variable_to_index)) {
+                        continue;
                     }
-                    if (!is_open_or_closed[succ_id]) {
-                        is_open_or_closed[succ_id] = true;
-                        ++num_reached_states;
+                    get_numeric_successor(state, op, num_variable_to_index, num_successor);
+                    ap_float op_cost;
+                    if (operator_costs.empty()) {
+                        op_cost = op.get_cost();
+                    } else {
+                        op_cost = operator_costs[op_id];
                     }
-                    open.push(cost + abs_op->get_cost(), succ_id);
+                    successors.add_successor(op_id, op_cost, state.prop_hash, num_successor);
                 }
             }
-
-            for (auto op_id: num_operators) {
-                const auto &op = task_proxy->get_operators()[op_id];
-                if (!is_applicable(state, op, num_variable_to_index)) {
+            successors.begin.push_back(successors.op_ids.size());
+        };
+
+        num_threads = max(num_threads, 1);
+        vector<LayerSuccessors> layer_successors(num_threads,
+                                                 LayerSuccessors(pattern.numeric.size()));
+        vector<size_t> layer;
+        size_t num_layers = 0;
+        while (!open.empty() && num_reached_states < max_number_states) {
+            // collect all open states with minimal cost
+            layer.clear();
+            ap_float cost = 0;
+            while (!open.empty()) {
+                auto [state_cost, state_id] = open.pop();
+                assert(state_cost >= 0 && state_cost < numeric_limits<ap_float>::max());
+                if (state_id < closed.size() && closed[state_id]) {
+                    // we don't do duplicate checking in the open list
                     continue;
                 }
-
-                vector<ap_float> num_successor = get_numeric_successor(state.num_state,
-                                                                       op,
-                                                                       num_variable_to_index);
-
-                size_t succ_id = tmp_state_registry->insert_state(NumericState(state.prop_hash, std::move(num_successor)));
-
-                if (succ_id == state_id) {
-                    // no need to keep self-loops
-                    continue;
+                if (layer.empty()) {
+                    cost = state_cost;
+                } else if (state_cost != cost) {
+                    open.push(state_cost, state_id);
+                    break;
                 }
-
-                if (parent_pointers.size() <= succ_id) {
-                    parent_pointers.resize(succ_id + 1);
+                if (state_id >= closed.size()) {
+                    closed.resize(state_id + 1, false);
                 }
-                parent_pointers[succ_id].emplace_back(op_id, state_id);
-                if (succ_id >= closed.size() || !closed[succ_id]) {
-                    if (succ_id >= is_open_or_closed.size()){
-                        is_open_or_closed.resize(succ_id + 1, false);
+                closed[state_id] = true;
+                layer.push_back(state_id);
+            }
+            if (layer.empty()) {
+                break;
+            }
+            ++num_layers;
+
+            size_t num_chunks = max<size_t>(
+                min<size_t>(num_threads, layer.size() / MIN_STATES_PER_THREAD), 1);
+            size_t chunk_size = (layer.size() + num_chunks - 1) / num_chunks;
+            // parallel_for passes exceptions (e.g. of exit_with) to this thread.
+            utils::parallel_for(num_chunks, num_chunks, [&](size_t chunk) {
+                size_t chunk_begin = min(chunk * chunk_size, layer.size());
+                size_t chunk_end = min(chunk_begin + chunk_size, layer.size());
+                expand(layer.data() + chunk_begin, chunk_end - chunk_begin,
+                       layer_successors[chunk]);
+            });
+
+            // register the successors in the order of the layer
+            size_t layer_index = 0;
+            for (size_t chunk = 0; chunk < num_chunks; ++chunk) {
+                const LayerSuccessors &successors = layer_successors[chunk];
+                for (size_t i = 0; i < successors.get_num_states(); ++i) {
+                    size_t state_id = layer[layer_index++];
+                    if (num_reached_states >= max_number_states) {
+                        // the remaining states of the layer stay open
+                        closed[state_id] = false;
+                        open.push(cost, state_id);
+                        continue;
                     }
-                    if (!is_open_or_closed[succ_id]) {
-                        is_open_or_closed[succ_id] = true;
-                        ++num_reached_states;
+
+                    if (successors.is_goal[i]) {
+                        goal_states.push_back(state_id);
                     }
-                    ap_float op_cost;
-                    if (operator_costs.empty()) {
-                        op_cost = task_proxy->get_operators()[op_id].get_cost();
-                    } else {
-                        op_cost = operator_costs[op_id];
+
+                    for (size_t succ = successors.begin[i]; succ < successors.begin[i + 1]; ++succ) {
+                        size_t succ_id = tmp_state_registry->insert_state(
+                            successors.prop_hashes[succ], successors.get_numeric_values(succ));
+
+                        if (succ_id == state_id) {
+                            // no need to keep self-loops
+                            continue;
+                        }
+
+                        if (parent_pointers.size() <= succ_id) {
+                            parent_pointers.resize(succ_id + 1);
+                        }
+                        parent_pointers[succ_id].emplace_back(successors.op_ids[succ], state_id);
+                        if (succ_id >= closed.size() || !closed[succ_id]) {
+                            if (succ_id >= is_open_or_closed.size()){
+                                is_open_or_closed.resize(succ_id + 1, false);
+                            }
+                            if (!is_open_or_closed[succ_id]) {
+                                is_open_or_closed[succ_id] = true;
+                                ++num_reached_states;
+                            }
+                            open.push(cost + successors.costs[succ], succ_id);
+                        }
                     }
-                    open.push(cost + op_cost, succ_id);
                 }
             }
+            assert(layer_index == layer.size());
         }
 
         if (num_reached_states < max_number_states) {
             exhausted_abstract_state_space = true;
         }
 
-        assert(distances.empty());
-        distances.resize(tmp_state_registry->size(), numeric_limits<ap_float>::max());
+        assert(search_distances.empty());
+        search_distances.resize(tmp_state_registry->size(), numeric_limits<ap_float>::max());
 
         for (const auto &goal_state_id: goal_states) {
             pq.push(0, goal_state_id);
@@ -517,7 +618,7 @@ void PatternDatabase::create_pdb(size_t max_number_states,
                 // open lists may contain closed states
                 continue;
             }
-            const NumericState &state = tmp_state_registry->lookup_state(state_id);
+            NumericState state = tmp_state_registry->lookup_state(state_id);
             num_open_states++;
             if (is_goal_state(state, num_variable_to_index)) {
                 // we have not checked this for states in open
@@ -530,6 +631,7 @@ void PatternDatabase::create_pdb(size_t max_number_states,
         }
 
         if (dump) {
+            cout << "Expanded layers: " << num_layers << endl;
             cout << "Generated abstract states: " << tmp_state_registry->size() + num_open_states << endl;
             cout << "Reached abstract goal states: " << goal_states.size() + num_open_goal_states << endl;
         }
@@ -541,11 +643,11 @@ void PatternDatabase::create_pdb(size_t max_number_states,
     while (!pq.empty()) {
         auto [distance, state_id] = pq.pop();
         assert(distance >= 0);
-        if (distance >= distances[state_id]) {
+        if (distance >= search_distances[state_id]) {
             continue;
         }
         ++num_bwd_reached_states;
-        distances[state_id] = distance;
+        search_distances[state_id] = distance;
 
         // regress state
         for (const auto &[op_id, parent_state_id] : parent_pointers[state_id]) {
@@ -555,7 +657,7 @@ void PatternDatabase::create_pdb(size_t max_number_states,
             } else {
                 alternative_cost += operator_costs[op_id];
             }
-            if (alternative_cost < distances[parent_state_id]) {
+            if (alternative_cost < search_distances[parent_state_id]) {
                 pq.push(alternative_cost, parent_state_id);
             }
         }
@@ -564,25 +666,33 @@ void PatternDatabase::create_pdb(size_t max_number_states,
         cout << "Number backwards reachable abstract states: " << num_bwd_reached_states << endl;
     }
 
-    if (num_bwd_reached_states < 0.75 * tmp_state_registry->size()) {
-        state_registry = make_unique<NumericStateRegistry>();
-        size_t state_id = 0;
-        for (size_t i = 0; i < distances.size(); ++i) {
-            ap_float dist = distances[i];
+    /*
+      If most states are dead ends, we only keep the registered states with
+      finite distance.
+    */
+    if (num_bwd_reached_states >= 0.75 * tmp_state_registry->size()) {
+        abstract_states = move(tmp_state_registry);
+    } else {
+        abstract_states = make_unique<NumericStateRegistry>(pattern.numeric.size());
+        size_t num_kept_states = 0;
+        for (size_t i = 0; i < search_distances.size(); ++i) {
+            ap_float dist = search_distances[i];
             if (dist != numeric_limits<ap_float>::max()) {
-                const NumericState &state = tmp_state_registry->lookup_state(i);
-                state_registry->insert_state(state);
-                distances[state_id++]  = dist;
+                NumericState state = tmp_state_registry->lookup_state(i);
+                abstract_states->insert_state(state.prop_hash, state.num_state);
+                search_distances[num_kept_states++] = dist;
             }
         }
-        distances.resize(state_id);
-        distances.shrink_to_fit();
+        search_distances.resize(num_kept_states);
         if (dump) {
-            cout << "Shrink size of state registry from " << tmp_state_registry->size() << " to " << distances.size() << endl;
+            cout << "Shrink size of state registry from " << tmp_state_registry->size() << " to " << search_distances.size() << endl;
         }
-        delete tmp_state_registry;
-    } else {
-        state_registry.reset(tmp_state_registry);
+        tmp_state_registry.reset();
+    }
+
+    distances = pdbs::CompressedDistances(search_distances);
+    if (dump) {
+        cout << "Bytes per PDB entry: " << distances.get_bytes_per_entry() << endl;
     }
 
     if (dump) {
@@ -621,7 +731,8 @@ void PatternDatabase::create_pdb_propositional(size_t size,
 
     build_goals(variable_to_index, vector<int>());
 
-    distances.reserve(size);
+    vector<ap_float> search_distances;
+    search_distances.reserve(size);
     // first implicit entry: priority, second entry: index for an abstract state
     AdaptiveQueue<size_t> pq;
 
@@ -630,9 +741,9 @@ void PatternDatabase::create_pdb_propositional(size_t size,
         if (is_goal_state(NumericState(state_index, vector<ap_float>()),
                           vector<int>())) {
             pq.push(0, state_index);
-            distances.push_back(0);
+            search_distances.push_back(0);
         } else {
-            distances.push_back(numeric_limits<ap_float>::max());
+            search_distances.push_back(numeric_limits<ap_float>::max());
         }
     }
 
@@ -641,7 +752,7 @@ void PatternDatabase::create_pdb_propositional(size_t size,
         pair<ap_float, size_t> node = pq.pop();
         ap_float distance = node.first;
         size_t state_index = node.second;
-        if (distance > distances[state_index]) {
+        if (distance > search_distances[state_index]) {
             continue;
         }
 
@@ -650,13 +761,15 @@ void PatternDatabase::create_pdb_propositional(size_t size,
         match_tree.get_applicable_operators(state_index, applicable_operators);
         for (const AbstractOperator *op : applicable_operators) {
             size_t predecessor = state_index + op->get_hash_effect();
-            ap_float alternative_cost = distances[state_index] + op->get_cost();
-            if (alternative_cost < distances[predecessor]) {
-                distances[predecessor] = alternative_cost;
+            ap_float alternative_cost = search_distances[state_index] + op->get_cost();
+            if (alternative_cost < search_distances[predecessor]) {
+                search_distances[predecessor] = alternative_cost;
                 pq.push(alternative_cost, predecessor);
             }
         }
     }
+
+    distances = pdbs::CompressedDistances(search_distances);
 }
 
 bool PatternDatabase::is_goal_state(
@@ -721,8 +834,8 @@ pair<bool, ap_float> PatternDatabase::get_value(const State &state) const {
         // purely propositional pattern
         return {true, distances[prop_hash_index(state)]};
     }
-    size_t abs_state_id = state_registry->get_id(NumericState(prop_hash_index(state),
-                                                               get_abstract_numeric_state(state)));
+    size_t abs_state_id = abstract_states->get_id(prop_hash_index(state),
+                                                  get_abstract_numeric_state(state));
     if (abs_state_id == numeric_limits<size_t>::max()) {
         // we have not seen an abstract state that corresponds to state
         if (exhausted_abstract_state_space) {
@@ -7,6 +7,8 @@
 
 #include "../task_proxy.h" // TODO get rid of this
 
+#include "../pdbs/compressed_distances.h"
+
 #include <utility>
 #include <vector>
 
@@ -92,10 +94,11 @@ class PatternDatabase {
 
     Pattern pattern;
 
-    std::unique_ptr<NumericStateRegistry> state_registry;
+    // Abstract states of numeric patterns; ids are indices into distances.
+    std::unique_ptr<NumericStateRegistry> abstract_states;
 
     // final h-values for abstract-states
-    std::vector<ap_float> distances;
+    pdbs::CompressedDistances distances;
 
     // multipliers for each propositional variable for perfect hash function
     std::vector<std::size_t> prop_hash_multipliers;
@@ -142,9 +145,11 @@ class PatternDatabase {
                        const numeric_pdb_helper::NumericOperatorProxy &op,
                        const std::vector<int> &num_variable_to_index) const;
 
-    std::vector<ap_float> get_numeric_successor(std::vector<ap_float> state,
-                                                const numeric_pdb_helper::NumericOperatorProxy &op,
-                                                const std::vector<int> &num_variable_to_index) const;
+    // Writes the numeric part of the successor of state into successor.
+    void get_numeric_successor(const NumericState &state,
+                               const numeric_pdb_helper::NumericOperatorProxy &op,
+                               const std::vector<int> &num_variable_to_index,
+                               std::vector<ap_float> &successor) const;
 
     void build_goals(const std::vector<int> &variable_to_index,
                      const std::vector<int> &num_variable_to_index);
@@ -155,11 +160,15 @@ class PatternDatabase {
       all final h-values (stored in distances). operator_costs can
       specify individual operator costs for each operator for action
       cost partitioning. If left empty, default operator costs are used.
+      The forward exploration expands the abstract states layer by layer,
+      where a layer contains all open states of minimal cost, and generates
+      the successors of large layers with num_threads threads.
     */
     void create_pdb(
             std::size_t max_number_states,
             const std::vector<ap_float> &operator_costs = std::vector<ap_float>(),
-            bool dump = false);
+            bool dump = false,
+            int num_threads = 1);
 
     void create_pdb_propositional(
             size_t number_states,
@@ -202,17 +211,21 @@ public:
       sorted, contains no duplicates and is small enough so that the
       number of abstract states is below numeric_limits<int>::max()
       Parameters:
-       dump:           If set to true, prints the construction time.
+       dump:           If set to true, prints the construction time and size.
        operator_costs: Can specify individual operator costs for each
        operator. This is useful for action cost partitioning. If left
        empty, default operator costs are used.
+       num_threads:    Number of threads used to generate successors
+       during the exploration of numeric patterns. The result does not
+       depend on the number of threads.
     */
     PatternDatabase(
             const std::shared_ptr<numeric_pdb_helper::NumericTaskProxy> task_proxy,
             const Pattern &pattern,
             std::size_t max_number_states,
             bool dump = false,
-            const std::vector<ap_float> &operator_costs = std::vector<ap_float>());
+            const std::vector<ap_float> &operator_costs = std::vector<ap_float>(),
+            int num_threads = 1);
 
     ~PatternDatabase() = default;
 
@@ -223,11 +236,29 @@ public:
         return pattern;
     }
 
+    // Returns true iff the pattern contains no numeric variables.
+    bool is_propositional() const {
+        return pattern.numeric.empty();
+    }
+
     // Returns the size (number of abstract states) of the PDB
     std::size_t get_size() const {
         return distances.size();
     }
 
+    /*
+      Returns the h-values of all abstract states. For propositional
+      patterns, the h-value of a state is stored at the index given by the
+      sum of the hash multipliers times the values of the pattern variables.
+    */
+    const pdbs::CompressedDistances &get_distances() const {
+        return distances;
+    }
+
+    const std::vector<std::size_t> &get_hash_multipliers() const {
+        return prop_hash_multipliers;
+    }
+
     /*
       Returns the average h-value over all states, where dead-ends are
       ignored (they neither increase the sum of all h-values nor the
@@ -6,6 +6,8 @@
 
 #include "../evaluation_context.h"
 
+#include "../utils/profiler.h"
+
 class GlobalOperator;
 class Heuristic;
 class StateID;
@@ -153,6 +155,9 @@ void OpenList<Entry>::boost_preferred() {
 template<class Entry>
 void OpenList<Entry>::insert(
     EvaluationContext &eval_context, const Entry &entry) {
+    static utils::ProfileNode &profile_node =
+        utils::get_profile_node("search/open_list/insert");
+    utils::ProfileScope profile_scope(profile_node);
     if (only_preferred && !eval_context.is_preferred())
         return;
     if (!is_dead_end(eval_context))
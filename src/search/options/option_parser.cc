@@ -7,10 +7,14 @@
 #include "type_documenter.h"
 
 #include "../globals.h"
+#include "../heuristic.h"
 
 #include "../ext/tree_util.hh"
 
+#include "../utils/profiler.h"
 #include "../utils/rng.h"
+#include "../utils/search_trace.h"
+#include "../utils/segment_allocator.h"
 #include "../utils/system.h"
 
 #include <algorithm>
@@ -279,6 +283,31 @@ SearchEngine *OptionParser::parse_cmd_line(
 }
 
 
+void OptionParser::clear_predefinitions() {
+    Predefinitions<Heuristic *>::instance()->clear();
+    Predefinitions<landmarks::LandmarkGraph *>::instance()->clear();
+}
+
+static vector<Heuristic *> &get_parsed_heuristics() {
+    static vector<Heuristic *> parsed_heuristics;
+    return parsed_heuristics;
+}
+
+void OptionParser::add_parsed_heuristic(Heuristic *heuristic) {
+    // Plugins return no object in dry runs.
+    if (heuristic)
+        get_parsed_heuristics().push_back(heuristic);
+}
+
+void OptionParser::delete_parsed_heuristics() {
+    // Heuristics are created after the heuristics they get as options.
+    vector<Heuristic *> &parsed_heuristics = get_parsed_heuristics();
+    for (auto it = parsed_heuristics.rbegin(); it != parsed_heuristics.rend(); ++it)
+        delete *it;
+    parsed_heuristics.clear();
+}
+
+
 int OptionParser::parse_int_arg(const string &name, const string &value) {
     try {
         return stoi(value);
@@ -348,7 +377,48 @@ SearchEngine *OptionParser::parse_cmd_line_aux(
             }
             dp->print_all();
             cout << "Help output finished." << endl;
-            exit(0);
+            // Only ends the current request in the planner service.
+            utils::exit_with(utils::ExitCode::PLAN_FOUND);
+        } else if (arg.compare("--search-trace") == 0) {
+            if (is_last)
+                throw ArgError("missing argument after --search-trace");
+            ++i;
+            if (!dry_run) {
+                delete g_search_trace;
+                g_search_trace = new utils::SearchTraceWriter(args[i], 64);
+            }
+        } else if (arg.compare("--convert-search-trace") == 0) {
+            if (is_last)
+                throw ArgError("missing argument after --convert-search-trace");
+            ++i;
+            if (dry_run) {
+                utils::convert_search_trace(args[i], "plan_vis.data");
+                utils::exit_with(utils::ExitCode::PLAN_FOUND);
+            }
+        } else if (arg.compare("--segment-memory") == 0) {
+            if (is_last)
+                throw ArgError("missing argument after --segment-memory");
+            ++i;
+            try {
+                utils::set_segment_memory(utils::parse_segment_memory(args[i]));
+            } catch (invalid_argument &) {
+                throw ArgError("argument for --segment-memory must be heap, "
+                               "huge_pages or huge_pages_numa_local");
+            }
+        } else if (arg.compare("--profile") == 0) {
+            if (is_last)
+                throw ArgError("missing argument after --profile");
+            ++i;
+            int sample_rate = parse_int_arg(arg, args[i]);
+            if (sample_rate < 1)
+                throw ArgError("argument for --profile must be positive");
+            if (!dry_run)
+                utils::enable_profiling(sample_rate);
+        } else if (arg.compare("--profile-json") == 0) {
+            if (is_last)
+                throw ArgError("missing argument after --profile-json");
+            ++i;
+            utils::set_profile_json_filename(args[i]);
         } else if (arg.compare("--internal-plan-file") == 0) {
             if (is_last)
                 throw ArgError("missing argument after --internal-plan-file");
@@ -387,6 +457,29 @@ string OptionParser::usage(string progname) {
         "    by the name that is specified in the definition.\n"
         "--random-seed SEED\n"
         "    Use random seed SEED\n\n"
+        "--search-trace FILENAME\n"
+        "    Write a binary trace of all generated search nodes to FILENAME\n"
+        "    (currently only supported by eager search)\n\n"
+        "--segment-memory {heap, huge_pages, huge_pages_numa_local}\n"
+        "    Backing of the segments that store states and per-state\n"
+        "    information. The huge page modes map large arenas with\n"
+        "    transparent huge pages (optionally NUMA-local) to reduce TLB\n"
+        "    misses on large state spaces. Default: heap\n\n"
+        "--profile N\n"
+        "    Attribute time and calls to successor generation, state\n"
+        "    registry, axioms, heuristics, open lists and pruning. Every Nth\n"
+        "    call of each component is timed; the profile is printed with\n"
+        "    the search statistics\n\n"
+        "--profile-json FILENAME\n"
+        "    Also write the profile to FILENAME in JSON format\n\n"
+        "--convert-search-trace FILENAME\n"
+        "    Convert the binary search trace FILENAME of the given task into\n"
+        "    the plan visualizer format (plan_vis.data) and exit\n\n"
+        "--service\n"
+        "    Solve a sequence of tasks read from standard input in one\n"
+        "    process. Each request consists of the planner options and the\n"
+        "    preprocessor output (see planner_service.h); this must be the\n"
+        "    only option\n\n"
         "--internal-plan-file FILENAME\n"
         "    Plan will be output to a file called FILENAME\n\n"
         "--internal-previous-portfolio-plans COUNTER\n"
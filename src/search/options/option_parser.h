@@ -13,6 +13,7 @@
 #include <string>
 #include <vector>
 
+class Heuristic;
 class SearchEngine;
 
 namespace options {
@@ -40,6 +41,18 @@ public:
 
     static std::string usage(std::string progname);
 
+    // Forgets all predefined heuristics and landmark graphs.
+    static void clear_predefinitions();
+
+    /*
+      The heuristics created by the parser are not owned by the objects
+      that use them and are usually never deleted. The parser keeps track
+      of them, so that the planner service can delete the heuristics of a
+      request once the search engine of the request is destroyed.
+    */
+    static void add_parsed_heuristic(Heuristic *heuristic);
+    static void delete_parsed_heuristics();
+
     //this function initiates parsing of T (the root node of parse_tree
     //will be parsed as T). Usually T=SearchEngine*, ScalarEvaluator* or LandmarkGraph*
     template<typename T>
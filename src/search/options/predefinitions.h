@@ -31,6 +31,10 @@ public:
         return predefined[k];
     }
 
+    void clear() {
+        predefined.clear();
+    }
+
 private:
     Predefinitions<T>() = default;
     std::map<std::string, T> predefined;
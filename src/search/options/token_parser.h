@@ -154,13 +154,26 @@ inline ScalarEvaluator *TokenParser<ScalarEvaluator *>::parse(OptionParser &p) {
     } else if (Registry<ScalarEvaluator *>::instance()->contains(pt->value)) {
         return Registry<ScalarEvaluator *>::instance()->get(pt->value) (p);
     } else if (Registry<Heuristic *>::instance()->contains(pt->value)) {
-        return (ScalarEvaluator *)
-               Registry<Heuristic *>::instance()->get(pt->value) (p);
+        Heuristic *heuristic =
+            Registry<Heuristic *>::instance()->get(pt->value) (p);
+        OptionParser::add_parsed_heuristic(heuristic);
+        return (ScalarEvaluator *) heuristic;
     }
     p.error("ScalarEvaluator " + pt->value + " not found");
     return 0;
 }
 
+template<>
+inline Heuristic *TokenParser<Heuristic *>::parse(OptionParser &p) {
+    bool predefined;
+    Heuristic *result = lookup_in_predefinitions<Heuristic>(p, predefined);
+    if (predefined)
+        return result;
+    result = lookup_in_registry<Heuristic>(p);
+    OptionParser::add_parsed_heuristic(result);
+    return result;
+}
+
 // TODO: The following method can go away once we use shared pointers for all plugins.
 template<typename T>
 inline T *TokenParser<T *>::parse(OptionParser &p) {
@@ -0,0 +1,102 @@
+#include "compressed_distances.h"
+
+#include <cmath>
+
+using namespace std;
+
+namespace pdbs {
+static const ap_float INFINITE_DISTANCE = numeric_limits<ap_float>::max();
+
+/*
+  Returns a unit such that all finite distances are integer multiples of it,
+  or 0 if we cannot find one. For integer distances, this is their greatest
+  common divisor, otherwise we try the smallest positive distance.
+*/
+static ap_float compute_unit(const vector<ap_float> &distances) {
+    bool all_integer = true;
+    uint64_t divisor = 0;
+    ap_float min_positive_distance = INFINITE_DISTANCE;
+    for (ap_float distance : distances) {
+        if (distance == INFINITE_DISTANCE || distance == 0)
+            continue;
+        if (distance < 0)
+            return 0;
+        min_positive_distance = min(min_positive_distance, distance);
+        if (all_integer) {
+            if (distance != floor(distance) ||
+                distance > numeric_limits<uint32_t>::max()) {
+                all_integer = false;
+            } else {
+                uint64_t value = static_cast<uint64_t>(distance);
+                while (value != 0) {
+                    uint64_t remainder = divisor % value;
+                    divisor = value;
+                    value = remainder;
+                }
+            }
+        }
+    }
+    if (min_positive_distance == INFINITE_DISTANCE) {
+        // All distances are 0 or infinite.
+        return 1;
+    }
+    if (all_integer)
+        return divisor;
+    return min_positive_distance;
+}
+
+CompressedDistances::CompressedDistances()
+    : scale(1),
+      bytes_per_entry(sizeof(ap_float)) {
+}
+
+CompressedDistances::CompressedDistances(const vector<ap_float> &distances)
+    : scale(compute_unit(distances)),
+      bytes_per_entry(sizeof(ap_float)) {
+    if (scale > 0) {
+        if (try_to_compress(distances, distances_8))
+            bytes_per_entry = 1;
+        else if (try_to_compress(distances, distances_16))
+            bytes_per_entry = 2;
+        else if (try_to_compress(distances, distances_32))
+            bytes_per_entry = 4;
+    }
+    if (bytes_per_entry == sizeof(ap_float)) {
+        scale = 1;
+        uncompressed_distances = distances;
+    }
+}
+
+template<typename T>
+bool CompressedDistances::try_to_compress(const vector<ap_float> &distances,
+                                          vector<T> &table) {
+    const ap_float max_units = numeric_limits<T>::max() - 1;
+    table.reserve(distances.size());
+    for (ap_float distance : distances) {
+        if (distance == INFINITE_DISTANCE) {
+            table.push_back(numeric_limits<T>::max());
+            continue;
+        }
+        ap_float units = round(distance / scale);
+        if (units > max_units || units * scale != distance) {
+            vector<T>().swap(table);
+            return false;
+        }
+        table.push_back(static_cast<T>(units));
+    }
+    return true;
+}
+
+size_t CompressedDistances::size() const {
+    switch (bytes_per_entry) {
+    case 1:
+        return distances_8.size();
+    case 2:
+        return distances_16.size();
+    case 4:
+        return distances_32.size();
+    default:
+        return uncompressed_distances.size();
+    }
+}
+}
@@ -0,0 +1,71 @@
+#ifndef PDBS_COMPRESSED_DISTANCES_H
+#define PDBS_COMPRESSED_DISTANCES_H
+
+#include "../globals.h"
+
+#include <cassert>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+namespace pdbs {
+/*
+  Stores the distances of a pattern database compactly. If all finite
+  distances are integer multiples of a common unit, they are divided by
+  this unit (the scale factor) and stored in the smallest unsigned integer
+  type with 8, 16 or 32 bits that can represent them, using the largest
+  value of the type for infinity. Otherwise, the distances are stored
+  uncompressed. Only units that reproduce every distance exactly are used,
+  so the compression is lossless.
+
+  Infinite distances are represented by numeric_limits<ap_float>::max()
+  both in the input and in the output.
+*/
+class CompressedDistances {
+    ap_float scale;
+    // Exactly one of the tables is used.
+    std::vector<uint8_t> distances_8;
+    std::vector<uint16_t> distances_16;
+    std::vector<uint32_t> distances_32;
+    std::vector<ap_float> uncompressed_distances;
+    int bytes_per_entry;
+
+    template<typename T>
+    ap_float decode(T value) const {
+        return value == std::numeric_limits<T>::max() ?
+               std::numeric_limits<ap_float>::max() : value * scale;
+    }
+
+    template<typename T>
+    bool try_to_compress(const std::vector<ap_float> &distances,
+                         std::vector<T> &table);
+public:
+    CompressedDistances();
+    explicit CompressedDistances(const std::vector<ap_float> &distances);
+
+    ap_float operator[](std::size_t index) const {
+        switch (bytes_per_entry) {
+        case 1:
+            return decode(distances_8[index]);
+        case 2:
+            return decode(distances_16[index]);
+        case 4:
+            return decode(distances_32[index]);
+        default:
+            return uncompressed_distances[index];
+        }
+    }
+
+    std::size_t size() const;
+
+    int get_bytes_per_entry() const {
+        return bytes_per_entry;
+    }
+
+    ap_float get_scale() const {
+        return scale;
+    }
+};
+}
+
+#endif
@@ -237,7 +237,8 @@ void PatternDatabase::create_pdb(const std::vector<ap_float> &operator_costs) {
         }
     }
 
-    distances.reserve(num_states);
+    vector<ap_float> search_distances;
+    search_distances.reserve(num_states);
     // first implicit entry: priority, second entry: index for an abstract state
     AdaptiveQueue<size_t> pq;
 
@@ -245,9 +246,9 @@ void PatternDatabase::create_pdb(const std::vector<ap_float> &operator_costs) {
     for (size_t state_index = 0; state_index < num_states; ++state_index) {
         if (is_goal_state(state_index, abstract_goals)) {
             pq.push(0, state_index);
-            distances.push_back(0);
+            search_distances.push_back(0);
         } else {
-            distances.push_back(numeric_limits<ap_float>::max());
+            search_distances.push_back(numeric_limits<ap_float>::max());
         }
     }
 
@@ -256,7 +257,7 @@ void PatternDatabase::create_pdb(const std::vector<ap_float> &operator_costs) {
         pair<ap_float, size_t> node = pq.pop();
         ap_float distance = node.first;
         size_t state_index = node.second;
-        if (distance > distances[state_index]) {
+        if (distance > search_distances[state_index]) {
             continue;
         }
 
@@ -265,13 +266,15 @@ void PatternDatabase::create_pdb(const std::vector<ap_float> &operator_costs) {
         match_tree.get_applicable_operators(state_index, applicable_operators);
         for (const AbstractOperator *op : applicable_operators) {
             size_t predecessor = state_index + op->get_hash_effect();
-            ap_float alternative_cost = distances[state_index] + op->get_cost();
-            if (alternative_cost < distances[predecessor]) {
-                distances[predecessor] = alternative_cost;
+            ap_float alternative_cost = search_distances[state_index] + op->get_cost();
+            if (alternative_cost < search_distances[predecessor]) {
+                search_distances[predecessor] = alternative_cost;
                 pq.push(alternative_cost, predecessor);
             }
         }
     }
+
+    distances = CompressedDistances(search_distances);
 }
 
 bool PatternDatabase::is_goal_state(
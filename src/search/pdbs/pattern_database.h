@@ -1,6 +1,7 @@
 #ifndef PDBS_PATTERN_DATABASE_H
 #define PDBS_PATTERN_DATABASE_H
 
+#include "compressed_distances.h"
 #include "types.h"
 
 #include "../task_proxy.h"
@@ -80,9 +81,9 @@ class PatternDatabase {
 
     /*
       final h-values for abstract-states.
-      dead-ends are represented by numeric_limits<int>::max()
+      dead-ends are represented by numeric_limits<ap_float>::max()
     */
-    std::vector<ap_float> distances;
+    CompressedDistances distances;
 
     // multipliers for each variable for perfect hash function
     std::vector<std::size_t> hash_multipliers;
@@ -0,0 +1,67 @@
+#ifndef PER_STATE_ARRAY_H
+#define PER_STATE_ARRAY_H
+
+#include "array_view.h"
+#include "per_state_information.h"
+#include "segmented_vector.h"
+
+#include <vector>
+
+/*
+  PerStateArray associates an array of T of the same size with every state.
+  It works like PerStateInformation<std::vector<T>>, but the arrays are
+  stored inline in a ConcurrentSegmentedArrayVector per registry instead of
+  one heap-allocated vector per state, and lookups return ArrayViews into
+  this storage. Arrays never move, so views stay valid while new states are
+  added. States that have not been accessed before get a copy of the
+  default array. See PerStateStorage for using the object from several
+  threads.
+
+  The array size is fixed at construction or, for global objects that are
+  created before the task is read, with set_default_array before the
+  first access.
+*/
+template<class T>
+class PerStateArray : public PerStateStorage<T> {
+    std::vector<T> default_array;
+
+    // No implementation to forbid copies and assignment
+    PerStateArray(const PerStateArray<T> &);
+    PerStateArray &operator=(const PerStateArray<T> &);
+public:
+    explicit PerStateArray(const std::vector<T> &default_array = std::vector<T>())
+        : PerStateStorage<T>(default_array.size(), nullptr),
+          default_array(default_array) {
+        PerStateStorage<T>::set_default_array(
+            this->default_array.size(), this->default_array.data());
+    }
+
+    void set_default_array(const std::vector<T> &new_default_array) {
+        default_array = new_default_array;
+        PerStateStorage<T>::set_default_array(
+            default_array.size(), default_array.data());
+    }
+
+    std::size_t get_array_size() const {
+        return default_array.size();
+    }
+
+    ArrayView<T> operator[](const GlobalState &state) {
+        // ConcurrentSegmentedArrayVector does not support empty arrays.
+        if (default_array.empty())
+            return ArrayView<T>(0, 0);
+        return ArrayView<T>(this->get_array(state), default_array.size());
+    }
+
+    ArrayView<const T> operator[](const GlobalState &state) const {
+        if (default_array.empty())
+            return ArrayView<const T>(0, 0);
+        const T *array = this->find_array(state);
+        if (!array) {
+            return ArrayView<const T>(default_array);
+        }
+        return ArrayView<const T>(array, default_array.size());
+    }
+};
+
+#endif
@@ -0,0 +1,41 @@
+#include "per_state_bitset.h"
+
+#include <algorithm>
+
+using namespace std;
+
+void BitsetView::reset() {
+    fill(blocks, blocks + get_num_blocks(), Block(0));
+}
+
+void BitsetView::copy_from(const BitsetView &other) {
+    assert(num_bits == other.num_bits);
+    copy(other.blocks, other.blocks + get_num_blocks(), blocks);
+}
+
+void BitsetView::intersect(const BitsetView &other) {
+    assert(num_bits == other.num_bits);
+    int num_blocks = get_num_blocks();
+    for (int i = 0; i < num_blocks; ++i)
+        blocks[i] &= other.blocks[i];
+}
+
+void BitsetView::unite(const BitsetView &other) {
+    assert(num_bits == other.num_bits);
+    int num_blocks = get_num_blocks();
+    for (int i = 0; i < num_blocks; ++i)
+        blocks[i] |= other.blocks[i];
+}
+
+
+PerStateBitset::PerStateBitset(int num_bits, bool default_value)
+    : num_bits(num_bits),
+      // Empty bitsets still get one block to keep the rows addressable.
+      rows(vector<BitsetView::Block>(
+               max(BitsetView::compute_num_blocks(num_bits), 1),
+               default_value ? ~BitsetView::Block(0) : BitsetView::Block(0))) {
+}
+
+BitsetView PerStateBitset::operator[](const GlobalState &state) {
+    return BitsetView(rows[state].data(), num_bits);
+}
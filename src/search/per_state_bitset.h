@@ -0,0 +1,92 @@
+#ifndef PER_STATE_BITSET_H
+#define PER_STATE_BITSET_H
+
+#include "per_state_array.h"
+
+#include <cassert>
+#include <cstdint>
+#include <limits>
+
+/*
+  BitsetView gives access to a fixed-width row of bits owned by someone
+  else, e.g. a PerStateBitset. The bits are stored in blocks, so that rows
+  can be copied, intersected and united a word at a time. The value of bits
+  at positions >= size() in the last block is unspecified.
+*/
+class BitsetView {
+public:
+    typedef uint64_t Block;
+    static const int bits_per_block = std::numeric_limits<Block>::digits;
+
+    static int compute_num_blocks(int num_bits) {
+        return (num_bits + bits_per_block - 1) / bits_per_block;
+    }
+
+private:
+    Block *blocks;
+    int num_bits;
+
+    static Block bit_mask(int index) {
+        return Block(1) << (index % bits_per_block);
+    }
+
+public:
+    BitsetView(Block *blocks, int num_bits)
+        : blocks(blocks), num_bits(num_bits) {
+    }
+
+    void set(int index) {
+        assert(index >= 0 && index < num_bits);
+        blocks[index / bits_per_block] |= bit_mask(index);
+    }
+
+    void reset(int index) {
+        assert(index >= 0 && index < num_bits);
+        blocks[index / bits_per_block] &= ~bit_mask(index);
+    }
+
+    bool test(int index) const {
+        assert(index >= 0 && index < num_bits);
+        return (blocks[index / bits_per_block] & bit_mask(index)) != 0;
+    }
+
+    // Reset all bits.
+    void reset();
+    void copy_from(const BitsetView &other);
+    void intersect(const BitsetView &other);
+    void unite(const BitsetView &other);
+
+    int size() const {
+        return num_bits;
+    }
+
+    int get_num_blocks() const {
+        return compute_num_blocks(num_bits);
+    }
+
+    Block *get_blocks() {
+        return blocks;
+    }
+
+    const Block *get_blocks() const {
+        return blocks;
+    }
+};
+
+/*
+  PerStateBitset associates a bitset of the same size with every state, like
+  PerStateInformation<std::vector<bool>>, but stores the bitsets inline as
+  rows of blocks in a PerStateArray instead of one heap-allocated vector per
+  state. States that have not been accessed before get a row with all bits
+  set to the given default value.
+*/
+class PerStateBitset {
+    const int num_bits;
+    PerStateArray<BitsetView::Block> rows;
+public:
+    PerStateBitset(int num_bits, bool default_value);
+
+    BitsetView operator[](const GlobalState &state);
+};
+
+#endif
@@ -8,9 +8,13 @@
 #include "state_registry.h"
 
 #include "utils/collections.h"
+#include "utils/memory.h"
 
+#include <atomic>
 #include <cassert>
 #include <iterator>
+#include <memory>
+#include <mutex>
 #include <unordered_map>
 
 class PerStateInformationBase {
@@ -22,6 +26,133 @@ public:
     virtual ~PerStateInformationBase() {}
 };
 
+/*
+  PerStateStorage is the common implementation of PerStateInformation and
+  PerStateArray: it associates an array of Elements of a fixed size with
+  every state and stores these arrays in a ConcurrentSegmentedArrayVector
+  per registry. Arrays of states that have not been accessed before are
+  copies of the default array.
+
+  It is common in many use cases that we look up information for states from
+  the same registry in sequence. Therefore, we remember the storage of the
+  registry used in the previous lookup (in "cached_storage") and reuse it on
+  consecutive lookups for the same registry.
+
+  Several threads can look up (and thereby create) the arrays of states at
+  the same time. Accesses to the same array must be synchronized by the
+  caller, and registries must not be destroyed while other threads use the
+  object.
+*/
+template<class Element>
+class PerStateStorage : public PerStateInformationBase {
+    struct RegistryStorage {
+        const StateRegistry *registry;
+        ConcurrentSegmentedArrayVector<Element> arrays;
+
+        RegistryStorage(const StateRegistry *registry_, std::size_t array_size,
+                        const Element *default_array)
+            : registry(registry_),
+              arrays(array_size, default_array) {
+        }
+    };
+
+    std::size_t array_size;
+    // Owned by the derived class.
+    const Element *default_array;
+
+    std::unordered_map<const StateRegistry *,
+                       std::unique_ptr<RegistryStorage>> storage_by_registry;
+    // Protects storage_by_registry.
+    mutable std::mutex storage_mutex;
+    mutable std::atomic<RegistryStorage *> cached_storage;
+
+    /*
+      Returns the storage associated with the given StateRegistry. If no
+      storage is associated with this registry yet, an empty one is created.
+    */
+    RegistryStorage *get_storage(const StateRegistry *registry) {
+        RegistryStorage *storage = cached_storage.load(std::memory_order_acquire);
+        if (storage && storage->registry == registry)
+            return storage;
+        std::lock_guard<std::mutex> lock(storage_mutex);
+        std::unique_ptr<RegistryStorage> &entry = storage_by_registry[registry];
+        if (!entry) {
+            entry = utils::make_unique_ptr<RegistryStorage>(
+                registry, array_size, default_array);
+            registry->subscribe(this);
+        }
+        cached_storage.store(entry.get(), std::memory_order_release);
+        return entry.get();
+    }
+
+    /*
+      Returns the storage associated with the given StateRegistry.
+      Returns 0, if no storage is associated with this registry yet.
+    */
+    const RegistryStorage *find_storage(const StateRegistry *registry) const {
+        RegistryStorage *storage = cached_storage.load(std::memory_order_acquire);
+        if (storage && storage->registry == registry)
+            return storage;
+        std::lock_guard<std::mutex> lock(storage_mutex);
+        auto it = storage_by_registry.find(registry);
+        if (it == storage_by_registry.end())
+            return 0;
+        cached_storage.store(it->second.get(), std::memory_order_release);
+        return it->second.get();
+    }
+
+    virtual void remove_state_registry(StateRegistry *registry) override {
+        std::lock_guard<std::mutex> lock(storage_mutex);
+        auto it = storage_by_registry.find(registry);
+        if (it == storage_by_registry.end())
+            return;
+        if (cached_storage.load() == it->second.get())
+            cached_storage.store(0);
+        storage_by_registry.erase(it);
+    }
+
+    // No implementation to forbid copies and assignment
+    PerStateStorage(const PerStateStorage<Element> &);
+    PerStateStorage &operator=(const PerStateStorage<Element> &);
+protected:
+    PerStateStorage(std::size_t array_size, const Element *default_array)
+        : array_size(array_size),
+          default_array(default_array),
+          cached_storage(0) {
+    }
+
+    // Must be called before the first access.
+    void set_default_array(std::size_t new_array_size,
+                           const Element *new_default_array) {
+        assert(storage_by_registry.empty());
+        array_size = new_array_size;
+        default_array = new_default_array;
+    }
+
+    Element *get_array(const GlobalState &state) {
+        const StateRegistry *registry = &state.get_registry();
+        int state_id = state.get_id().value;
+        assert(utils::in_bounds(state_id, *registry));
+        return get_storage(registry)->arrays.get(state_id);
+    }
+
+    // Returns 0 if the array of the state does not exist yet.
+    const Element *find_array(const GlobalState &state) const {
+        const StateRegistry *registry = &state.get_registry();
+        const RegistryStorage *storage = find_storage(registry);
+        if (!storage)
+            return 0;
+        int state_id = state.get_id().value;
+        assert(utils::in_bounds(state_id, *registry));
+        return storage->arrays.find(state_id);
+    }
+public:
+    virtual ~PerStateStorage() override {
+        for (const auto &entry : storage_by_registry)
+            entry.first->unsubscribe(this);
+    }
+};
+
 /*
   PerStateInformation is used to associate information with states.
   PerStateInformation<Entry> logically behaves somewhat like an unordered map
@@ -35,13 +166,11 @@ public:
 
   Implementation notes: PerStateInformation is essentially implemented as a
   kind of two-level map:
-    1. Find the correct SegmentedVector for the registry of the given state.
-    2. Look up the associated entry in the SegmentedVector based on the ID of
+    1. Find the correct storage for the registry of the given state.
+    2. Look up the associated entry in the storage based on the ID of
        the state.
-  It is common in many use cases that we look up information for states from
-  the same registry in sequence. Therefore, to make step 1. more efficient, we
-  remember (in "cached_registry" and "cached_entries") the results of the
-  previous lookup and reuse it on consecutive lookups for the same registry.
+  See PerStateStorage for details, also on using the object from several
+  threads.
 
   A PerStateInformation object subscribes to every StateRegistry for which it
   stores information. Once a StateRegistry is destroyed, it notifies all
@@ -49,56 +178,8 @@ public:
   in that registry.
 */
 template<class Entry>
-class PerStateInformation : public PerStateInformationBase {
+class PerStateInformation : public PerStateStorage<Entry> {
     const Entry default_value;
-    typedef std::unordered_map<const StateRegistry *,
-                               SegmentedVector<Entry> * > EntryVectorMap;
-    EntryVectorMap entries_by_registry;
-
-    mutable const StateRegistry *cached_registry;
-    mutable SegmentedVector<Entry> *cached_entries;
-
-    /*
-      Returns the SegmentedVector associated with the given StateRegistry.
-      If no vector is associated with this registry yet, an empty one is created.
-      Both the registry and the returned vector are cached to speed up
-      consecutive calls with the same registry.
-    */
-    SegmentedVector<Entry> *get_entries(const StateRegistry *registry) {
-        if (cached_registry != registry) {
-            cached_registry = registry;
-            typename EntryVectorMap::const_iterator it = entries_by_registry.find(registry);
-            if (it == entries_by_registry.end()) {
-                cached_entries = new SegmentedVector<Entry>();
-                entries_by_registry[registry] = cached_entries;
-                registry->subscribe(this);
-            } else {
-                cached_entries = it->second;
-            }
-        }
-        assert(cached_registry == registry && cached_entries == entries_by_registry[registry]);
-        return cached_entries;
-    }
-
-    /*
-      Returns the SegmentedVector associated with the given StateRegistry.
-      Returns 0, if no vector is associated with this registry yet.
-      Otherwise, both the registry and the returned vector are cached to speed
-      up consecutive calls with the same registry.
-    */
-    const SegmentedVector<Entry> *get_entries(const StateRegistry *registry) const {
-        if (cached_registry != registry) {
-            typename EntryVectorMap::const_iterator it = entries_by_registry.find(registry);
-            if (it == entries_by_registry.end()) {
-                return 0;
-            } else {
-                cached_registry = registry;
-                cached_entries = const_cast<SegmentedVector<Entry> *>(it->second);
-            }
-        }
-        assert(cached_registry == registry);
-        return cached_entries;
-    }
 
     // No implementation to forbid copies and assignment
     PerStateInformation(const PerStateInformation<Entry> &);
@@ -158,59 +239,25 @@ public:
     }
 
     PerStateInformation()
-        : default_value(),
-          cached_registry(0),
-          cached_entries(0) {
+        : PerStateStorage<Entry>(1, &default_value),
+          default_value() {
     }
 
     explicit PerStateInformation(const Entry &default_value_)
-        : default_value(default_value_),
-          cached_registry(0),
-          cached_entries(0) {
-    }
-
-    ~PerStateInformation() {
-        for (typename EntryVectorMap::iterator it = entries_by_registry.begin();
-             it != entries_by_registry.end(); ++it) {
-            it->first->unsubscribe(this);
-            delete it->second;
-        }
+        : PerStateStorage<Entry>(1, &default_value),
+          default_value(default_value_) {
     }
 
     Entry &operator[](const GlobalState &state) {
-        const StateRegistry *registry = &state.get_registry();
-        SegmentedVector<Entry> *entries = get_entries(registry);
-        int state_id = state.get_id().value;
-        size_t virtual_size = registry->size();
-        assert(utils::in_bounds(state_id, *registry));
-        if (entries->size() < virtual_size) {
-            entries->resize(virtual_size, default_value);
-        }
-        return (*cached_entries)[state_id];
+        return *this->get_array(state);
     }
 
     const Entry &operator[](const GlobalState &state) const {
-        const StateRegistry *registry = &state.get_registry();
-        const SegmentedVector<Entry> *entries = get_entries(registry);
-        if (!entries) {
-            return default_value;
-        }
-        int state_id = state.get_id().value;
-        assert(utils::in_bounds(state_id, *registry));
-        int num_entries = entries->size();
-        if (state_id >= num_entries) {
+        const Entry *entry = this->find_array(state);
+        if (!entry) {
             return default_value;
         }
-        return (*entries)[state_id];
-    }
-
-    void remove_state_registry(StateRegistry *registry) {
-        delete entries_by_registry[registry];
-        entries_by_registry.erase(registry);
-        if (registry == cached_registry) {
-            cached_registry = 0;
-            cached_entries = 0;
-        }
+        return *entry;
     }
 };
 
@@ -1,12 +1,17 @@
 #include "option_parser.h"
+#include "planner_service.h"
 #include "search_engine.h"
 
+#include "utils/profiler.h"
+#include "utils/search_trace.h"
+#include "utils/segment_allocator.h"
 #include "utils/timer.h"
 #include "utils/system.h"
 
 // #include <boost/static_assert.hpp>
 // #include <cstdlib> // 32 bit / 64 bit bucktet assertions
 #include <climits> // bitsize limits
+#include <cstdlib>
 #include <fstream> // eclipse run
 #include <iostream>
 #include <unistd.h>
@@ -16,6 +21,11 @@ using namespace std;
 using utils::ExitCode;
 
 
+static void close_search_trace() {
+    // Flushes the remaining records and waits for the writer thread.
+    delete g_search_trace;
+    g_search_trace = nullptr;
+}
 
 int main(int argc, const char **argv) {
 
@@ -27,12 +37,19 @@ int main(int argc, const char **argv) {
 	// BOOST_STATIC_ASSERT(sizeof(unsigned long long) * CHAR_BIT == 64);
 
     utils::register_event_handlers();
+    // Also write the buffered trace records if the planner exits early.
+    atexit(close_search_trace);
 
     if (argc < 2) {
         cout << OptionParser::usage(argv[0]) << endl;
         utils::exit_with(ExitCode::INPUT_ERROR);
     }
 
+    if (string(argv[1]) == "--service") {
+        run_planner_service(cin);
+        utils::exit_with(ExitCode::PLAN_FOUND);
+    }
+
     if (string(argv[1]) != "--help")
         read_everything(cin);
 
@@ -54,12 +71,20 @@ int main(int argc, const char **argv) {
     }
 
     utils::Timer search_timer;
-    engine->search();
+    {
+        utils::ProfileScope profile_scope(utils::get_profile_node("search"));
+        engine->search();
+    }
     search_timer.stop();
     utils::g_timer.stop();
 
+    close_search_trace();
+
     engine->save_plan_if_necessary();
     engine->print_statistics();
+    utils::print_profile();
+    if (utils::get_segment_memory() != utils::SegmentMemory::HEAP)
+        utils::print_segment_memory_statistics();
     cout << "Search time: " << search_timer << endl;
     cout << "Total time: " << utils::g_timer << endl;
 
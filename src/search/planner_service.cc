@@ -0,0 +1,192 @@
+#include "planner_service.h"
+
+#include "globals.h"
+#include "option_parser.h"
+#include "search_engine.h"
+
+#include "utils/search_trace.h"
+#include "utils/system.h"
+#include "utils/timer.h"
+
+#include <cstdio>
+#include <iostream>
+#include <limits>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <unistd.h>
+#include <vector>
+
+using namespace std;
+using utils::ExitCode;
+
+static vector<string> read_arguments(istream &in) {
+    int num_args;
+    in >> num_args;
+    if (!in || num_args < 0) {
+        cerr << "Expected the number of arguments of the request." << endl;
+        utils::exit_with(ExitCode::INPUT_ERROR);
+    }
+    in.ignore(numeric_limits<streamsize>::max(), '\n');
+    vector<string> args;
+    args.reserve(num_args);
+    for (int i = 0; i < num_args; ++i) {
+        string arg;
+        getline(in, arg);
+        args.push_back(arg);
+    }
+    return args;
+}
+
+static SearchEngine *parse_arguments(const vector<string> &args) {
+    // parse_cmd_line expects the program name as first argument.
+    vector<const char *> argv(1, "downward");
+    for (const string &arg : args)
+        argv.push_back(arg.c_str());
+    int argc = argv.size();
+    bool unit_cost = is_unit_cost();
+    try {
+        OptionParser::parse_cmd_line(argc, argv.data(), true, unit_cost);
+        return OptionParser::parse_cmd_line(argc, argv.data(), false, unit_cost);
+    } catch (ArgError &error) {
+        cerr << error << endl;
+    } catch (ParseError &error) {
+        cerr << error << endl;
+    }
+    utils::exit_with(ExitCode::INPUT_ERROR);
+}
+
+/*
+  Reads the lines of the next request up to and including "end_request", so
+  that a malformed request does not affect the following ones. Returns false
+  if the input ends before a request starts.
+*/
+static bool read_request(istream &in, string &request) {
+    request.clear();
+    string line;
+    while (getline(in, line)) {
+        request += line;
+        request += '\n';
+        istringstream line_in(line);
+        string word;
+        if (line_in >> word && word == "end_request")
+            return true;
+    }
+    if (request.find_first_not_of(" \t\r\n") != string::npos) {
+        cerr << "Input ended in the middle of a request." << endl;
+        return true;
+    }
+    return false;
+}
+
+static const char *get_error_status(ExitCode exitcode) {
+    switch (exitcode) {
+    case ExitCode::PLAN_FOUND:
+        // The request ended without a search, e.g. with --help.
+        return "no_search";
+    case ExitCode::UNSOLVABLE:
+    case ExitCode::UNSOLVED_INCOMPLETE:
+        return "unsolved";
+    case ExitCode::INPUT_ERROR:
+        return "input_error";
+    case ExitCode::UNSUPPORTED:
+        return "unsupported";
+    default:
+        return "critical_error";
+    }
+}
+
+static void write_response(ostream &response, const SearchEngine &engine,
+                           double search_time) {
+    response << "begin_response" << endl;
+    if (engine.found_solution()) {
+        const SearchEngine::Plan &plan = engine.get_plan();
+        response << "status plan_found" << endl;
+        response << "plan_cost " << calculate_plan_cost(plan) << endl;
+        response << "plan_length " << plan.size() << endl;
+        for (const GlobalOperator *op : plan)
+            response << op->get_name() << endl;
+    } else {
+        response << "status unsolved" << endl;
+    }
+    const SearchStatistics &statistics = engine.get_statistics();
+    response << "expanded " << statistics.get_expanded() << endl;
+    response << "evaluated " << statistics.get_evaluated_states() << endl;
+    response << "generated " << statistics.get_generated() << endl;
+    response << "search_time " << search_time << endl;
+    response << "end_response" << endl;
+}
+
+static void solve_request(istream &in, ostream &response) {
+    string word;
+    in >> word;
+    if (word != "begin_request") {
+        cerr << "Expected 'begin_request', got '" << word << "'." << endl;
+        utils::exit_with(ExitCode::INPUT_ERROR);
+    }
+    vector<string> args = read_arguments(in);
+    utils::g_timer.reset();
+    read_everything(in);
+    check_magic(in, "end_request");
+
+    unique_ptr<SearchEngine> engine(parse_arguments(args));
+    utils::Timer search_timer;
+    engine->search();
+    double search_time = search_timer.stop();
+
+    // Flushes the remaining records and waits for the writer thread.
+    delete g_search_trace;
+    g_search_trace = nullptr;
+
+    engine->save_plan_if_necessary();
+    engine->print_statistics();
+    write_response(response, *engine, search_time);
+}
+
+static void release_request() {
+    delete g_search_trace;
+    g_search_trace = nullptr;
+    // The search engine of the request has already been destroyed.
+    OptionParser::delete_parsed_heuristics();
+    OptionParser::clear_predefinitions();
+    release_everything();
+}
+
+void run_planner_service(istream &in) {
+    /*
+      Responses are written to the original stdout. Everything else that
+      the planner writes to stdout, including output written directly to
+      the file descriptor, goes to stderr.
+    */
+    cout.flush();
+    int response_fd = dup(STDOUT_FILENO);
+    FILE *response_file = response_fd == -1 ? nullptr : fdopen(response_fd, "w");
+    if (!response_file || dup2(STDERR_FILENO, STDOUT_FILENO) == -1) {
+        cerr << "Could not separate the responses from the output." << endl;
+        utils::exit_with(ExitCode::CRITICAL_ERROR);
+    }
+    fputs("planner service ready\n", response_file);
+    fflush(response_file);
+
+    // Errors end the current request instead of the service.
+    utils::set_exit_throws(true);
+    string request;
+    while (read_request(in, request)) {
+        istringstream request_in(request);
+        ostringstream response;
+        try {
+            solve_request(request_in, response);
+        } catch (const utils::ExitException &exception) {
+            response.str("");
+            response << "begin_response" << endl
+                     << "status " << get_error_status(exception.get_exit_code())
+                     << endl << "end_response" << endl;
+        }
+        release_request();
+        cout.flush();
+        fputs(response.str().c_str(), response_file);
+        fflush(response_file);
+    }
+    utils::set_exit_throws(false);
+    fclose(response_file);
+}
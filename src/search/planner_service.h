@@ -0,0 +1,42 @@
+#ifndef PLANNER_SERVICE_H
+#define PLANNER_SERVICE_H
+
+#include <istream>
+
+/*
+  The planner service solves a sequence of tasks in one process, so that
+  process startup and plugin registration are paid only once. Requests are
+  read from in, and each request is answered on stdout:
+
+    begin_request
+    <number of arguments>
+    <argument>            (one per line, e.g. "--search" and "astar(blind())")
+    ...
+    <task in the output format of the preprocessor>
+    end_request
+
+    begin_response
+    status plan_found|unsolved|no_search|input_error|unsupported|critical_error
+    plan_cost <cost>      (only if a plan was found)
+    plan_length <length>  (only if a plan was found)
+    <operator name>       (one per step of the plan)
+    ...
+    expanded <number>     (only if the search ran to its end)
+    evaluated <number>
+    generated <number>
+    search_time <seconds>
+    end_response
+
+  The status no_search means that the request ended without a search,
+  e.g. because its arguments contain --help.
+
+  The service writes "planner service ready" to stdout when it starts. All
+  other output of the planner goes to stderr, so stdout only contains the
+  responses. Errors that make the planner exit (e.g. invalid plugin options
+  or unsupported tasks) only end the current request, except for running
+  out of memory. After each request, the heuristics, the cached data of the
+  task and the global task data are released.
+*/
+extern void run_planner_service(std::istream &in);
+
+#endif
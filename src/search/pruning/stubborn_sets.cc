@@ -1,8 +1,11 @@
 #include "stubborn_sets.h"
 
+#include "../axioms.h"
 #include "../global_operator.h"
 #include "../globals.h"
 
+#include "../utils/system.h"
+
 #include <algorithm>
 #include <cassert>
 
@@ -23,7 +26,24 @@ static inline int get_op_index(const GlobalOperator *op) {
     return op_index;
 }
 
-// Relies on both fact sets being sorted by variable.
+void EpochSet::clear() {
+    ++epoch;
+    if (epoch == 0) {
+        // The epoch counter wrapped around, so old stamps could become valid.
+        fill(stamps.begin(), stamps.end(), 0);
+        epoch = 1;
+    }
+}
+
+void OperatorRelation::add_row(const vector<int> &row) {
+    targets.insert(targets.end(), row.begin(), row.end());
+    offsets.push_back(targets.size());
+}
+
+/*
+  Relies on both fact sets being sorted by variable. Effects with value
+  ANY_VALUE conflict with every precondition on the same variable.
+*/
 bool contain_conflicting_fact(const vector<Fact> &facts1,
                               const vector<Fact> &facts2) {
     auto facts1_it = facts1.begin();
@@ -53,35 +73,225 @@ vector<Fact> get_sorted_fact_set(const vector<T> &facts) {
     return result;
 }
 
+static void verify_supported_task() {
+    verify_no_conditional_effects();
+    for (const GlobalOperator &op : g_operators) {
+        for (const AssignEffect &effect : op.get_assign_effects()) {
+            if (effect.is_conditional_effect) {
+                cerr << "Stubborn sets do not support conditional numeric "
+                     << "effects (operator " << op.get_name() << ")" << endl
+                     << "Terminating." << endl;
+                utils::exit_with(utils::ExitCode::UNSUPPORTED);
+            }
+        }
+    }
+}
+
+static void collect_base_variables(
+    int var, const vector<const AssignmentAxiom *> &defining_axiom,
+    vector<vector<int>> &base_vars, vector<bool> &collected) {
+    if (collected[var])
+        return;
+    collected[var] = true;
+    const AssignmentAxiom *axiom = defining_axiom[var];
+    if (!axiom) {
+        base_vars[var].push_back(var);
+        return;
+    }
+    vector<int> &result = base_vars[var];
+    for (int operand : {axiom->var_lhs, axiom->var_rhs}) {
+        collect_base_variables(operand, defining_axiom, base_vars, collected);
+        result.insert(result.end(),
+                      base_vars[operand].begin(), base_vars[operand].end());
+    }
+    sort(result.begin(), result.end());
+    result.erase(unique(result.begin(), result.end()), result.end());
+}
+
+/*
+  Returns for every numeric variable the sorted numeric variables that are
+  not derived by assignment axioms and that its value depends on.
+  Assignment axioms are acyclic, so the recursion terminates.
+*/
+static vector<vector<int>> compute_base_variables() {
+    int num_numeric_vars = g_numeric_var_names.size();
+    vector<const AssignmentAxiom *> defining_axiom(num_numeric_vars, nullptr);
+    for (const AssignmentAxiom &axiom : g_ass_axioms)
+        defining_axiom[axiom.affected_variable] = &axiom;
+    vector<vector<int>> base_vars(num_numeric_vars);
+    vector<bool> collected(num_numeric_vars, false);
+    for (int var = 0; var < num_numeric_vars; ++var)
+        collect_base_variables(var, defining_axiom, base_vars, collected);
+    return base_vars;
+}
+
+// Relies on both sequences being sorted by variable.
+template<typename T>
+static bool writes_read_variable(const vector<T> &effects,
+                                 const vector<int> &reads) {
+    auto effects_it = effects.begin();
+    auto reads_it = reads.begin();
+    while (effects_it != effects.end() && reads_it != reads.end()) {
+        if (effects_it->var < *reads_it)
+            ++effects_it;
+        else if (effects_it->var > *reads_it)
+            ++reads_it;
+        else
+            return true;
+    }
+    return false;
+}
+
 StubbornSets::StubbornSets()
     : num_unpruned_successors_generated(0),
-      num_pruned_successors_generated(0) {
-    verify_no_axioms_no_conditional_effects();
+      num_pruned_successors_generated(0),
+      stubborn(g_operators.size()) {
+    verify_supported_task();
     compute_sorted_operators();
     compute_achievers();
+
+    single_logic_axiom.assign(g_variable_domain.size(), -1);
+    vector<int> num_logic_axioms(g_variable_domain.size(), 0);
+    for (size_t i = 0; i < g_logic_axioms.size(); ++i) {
+        int var = g_logic_axioms[i].affected_variable;
+        if (++num_logic_axioms[var] == 1)
+            single_logic_axiom[var] = i;
+        else
+            single_logic_axiom[var] = -1;
+    }
+}
+
+Fact StubbornSets::get_unsatisfied_enabling_fact(
+    Fact fact, const GlobalState &state) const {
+    assert((int) state[fact.var] != fact.value);
+    // Bound the number of steps, since axioms can be cyclic within a layer.
+    int num_steps = g_variable_domain.size();
+    for (int step = 0; step < num_steps; ++step) {
+        int axiom_no = single_logic_axiom[fact.var];
+        if (axiom_no == -1)
+            break;
+        const PropositionalAxiom &axiom = g_logic_axioms[axiom_no];
+        if ((int) axiom.get_effects()[0].val != fact.value)
+            break;
+        /* The axiom has not fired, so one of its conditions is false, and
+           all of them have to become true before the fact can. */
+        bool found = false;
+        for (const GlobalCondition &condition : axiom.get_preconditions()) {
+            if ((int) state[condition.var] != (int) condition.val) {
+                fact = Fact(condition.var, condition.val);
+                found = true;
+                break;
+            }
+        }
+        if (!found)
+            break;
+    }
+    return fact;
 }
 
 // Relies on op_preconds and op_effects being sorted by variable.
-bool StubbornSets::can_disable(int op1_no, int op2_no) {
+bool StubbornSets::can_disable(int op1_no, int op2_no) const {
     return contain_conflicting_fact(sorted_op_effects[op1_no],
                                     sorted_op_preconditions[op2_no]);
 }
 
 // Relies on op_effect being sorted by variable.
-bool StubbornSets::can_conflict(int op1_no, int op2_no) {
+bool StubbornSets::can_conflict(int op1_no, int op2_no) const {
     return contain_conflicting_fact(sorted_op_effects[op1_no],
-                                    sorted_op_effects[op2_no]);
+                                    sorted_op_effects[op2_no]) ||
+           can_conflict_numerically(op1_no, op2_no);
+}
+
+bool StubbornSets::can_conflict_numerically(int op1_no, int op2_no) const {
+    const vector<NumericEffect> &effects1 = sorted_op_numeric_effects[op1_no];
+    const vector<NumericEffect> &effects2 = sorted_op_numeric_effects[op2_no];
+    if (effects1.empty() || effects2.empty())
+        return false;
+    auto effects1_it = effects1.begin();
+    auto effects2_it = effects2.begin();
+    while (effects1_it != effects1.end() && effects2_it != effects2.end()) {
+        if (effects1_it->var < effects2_it->var) {
+            ++effects1_it;
+        } else if (effects1_it->var > effects2_it->var) {
+            ++effects2_it;
+        } else {
+            // Increasing and decreasing commute with each other.
+            if (!effects1_it->additive || !effects2_it->additive)
+                return true;
+            ++effects1_it;
+            ++effects2_it;
+        }
+    }
+    return writes_read_variable(effects1, sorted_op_numeric_reads[op2_no]) ||
+           writes_read_variable(effects2, sorted_op_numeric_reads[op1_no]);
 }
 
 void StubbornSets::compute_sorted_operators() {
     assert(sorted_op_preconditions.empty());
     assert(sorted_op_effects.empty());
 
+    vector<vector<int>> base_vars = compute_base_variables();
+    vector<vector<int>> dependent_comparison_vars(base_vars.size());
+    for (const ComparisonAxiom &axiom : g_comp_axioms) {
+        for (int operand : {axiom.var_lhs, axiom.var_rhs}) {
+            for (int var : base_vars[operand])
+                dependent_comparison_vars[var].push_back(axiom.affected_variable);
+        }
+    }
+
+    // dependent_derived_vars[var] contains the variables of the logic axioms
+    // with a condition on var.
+    vector<vector<int>> dependent_derived_vars(g_variable_domain.size());
+    for (const PropositionalAxiom &axiom : g_logic_axioms) {
+        for (const GlobalCondition &condition : axiom.get_preconditions())
+            dependent_derived_vars[condition.var].push_back(axiom.affected_variable);
+    }
+    EpochSet written_vars(g_variable_domain.size());
+
     for (const GlobalOperator &op : g_operators) {
         sorted_op_preconditions.push_back(
             get_sorted_fact_set(op.get_preconditions()));
-        sorted_op_effects.push_back(
-            get_sorted_fact_set(op.get_effects()));
+
+        vector<Fact> effects;
+        for (const GlobalEffect &effect : op.get_effects())
+            effects.emplace_back(effect.var, effect.val);
+        vector<NumericEffect> numeric_effects;
+        vector<int> numeric_reads;
+        for (const AssignEffect &effect : op.get_assign_effects()) {
+            for (int var : dependent_comparison_vars[effect.aff_var])
+                effects.emplace_back(var, ANY_VALUE);
+            bool additive = effect.fop == increase || effect.fop == decrease;
+            numeric_effects.emplace_back(effect.aff_var, additive);
+            numeric_reads.insert(numeric_reads.end(),
+                                 base_vars[effect.ass_var].begin(),
+                                 base_vars[effect.ass_var].end());
+        }
+
+        // Add the derived variables that depend on the written variables.
+        written_vars.clear();
+        for (const Fact &effect : effects)
+            written_vars.insert(effect.var);
+        for (size_t i = 0; i < effects.size(); ++i) {
+            for (int var : dependent_derived_vars[effects[i].var]) {
+                if (written_vars.insert(var))
+                    effects.emplace_back(var, ANY_VALUE);
+            }
+        }
+
+        sort(effects.begin(), effects.end(), SortFactsByVariable());
+        effects.erase(unique(effects.begin(), effects.end()), effects.end());
+        sorted_op_effects.push_back(move(effects));
+
+        sort(numeric_effects.begin(), numeric_effects.end(),
+             [](const NumericEffect &lhs, const NumericEffect &rhs) {
+                 return lhs.var < rhs.var;
+             });
+        sorted_op_numeric_effects.push_back(move(numeric_effects));
+
+        sort(numeric_reads.begin(), numeric_reads.end());
+        numeric_reads.erase(unique(numeric_reads.begin(), numeric_reads.end()),
+                            numeric_reads.end());
+        sorted_op_numeric_reads.push_back(move(numeric_reads));
     }
 }
 
@@ -92,16 +302,20 @@ void StubbornSets::compute_achievers() {
     }
 
     for (size_t op_no = 0; op_no < g_operators.size(); ++op_no) {
-        const GlobalOperator &op = g_operators[op_no];
-        for (const GlobalEffect &effect : op.get_effects()) {
-            achievers[effect.var][effect.val].push_back(op_no);
+        for (const Fact &effect : sorted_op_effects[op_no]) {
+            vector<vector<int>> &var_achievers = achievers[effect.var];
+            if (effect.value == ANY_VALUE) {
+                for (vector<int> &value_achievers : var_achievers)
+                    value_achievers.push_back(op_no);
+            } else {
+                var_achievers[effect.value].push_back(op_no);
+            }
         }
     }
 }
 
 bool StubbornSets::mark_as_stubborn(int op_no) {
-    if (!stubborn[op_no]) {
-        stubborn[op_no] = true;
+    if (stubborn.insert(op_no)) {
         stubborn_queue.push_back(op_no);
         return true;
     }
@@ -114,7 +328,6 @@ void StubbornSets::prune_operators(
 
     // Clear stubborn set from previous call.
     stubborn.clear();
-    stubborn.assign(g_operators.size(), false);
     assert(stubborn_queue.empty());
 
     initialize_stubborn_set(state);
@@ -131,7 +344,7 @@ void StubbornSets::prune_operators(
     remaining_ops.reserve(ops.size());
     for (const GlobalOperator *op : ops) {
         int op_no = get_op_index(op);
-        if (stubborn[op_no])
+        if (stubborn.contains(op_no))
             remaining_ops.push_back(op);
     }
     if (remaining_ops.size() != ops.size()) {
@@ -2,16 +2,84 @@
 #define PRUNING_STUBBORN_SETS_H
 
 #include "../abstract_task.h"
+#include "../array_view.h"
 #include "../pruning_method.h"
 
+#include <cstdint>
+
 namespace stubborn_sets {
+/*
+  A set of integers in [0, size) that can be cleared in constant time:
+  an element is contained iff its stamp equals the current epoch, so
+  clearing only increments the epoch.
+*/
+class EpochSet {
+    std::vector<uint32_t> stamps;
+    uint32_t epoch;
+public:
+    explicit EpochSet(int size = 0)
+        : stamps(size, 0), epoch(1) {
+    }
+
+    void resize(int size) {
+        stamps.assign(size, 0);
+        epoch = 1;
+    }
+
+    void clear();
+
+    bool contains(int element) const {
+        return stamps[element] == epoch;
+    }
+
+    // Returns true iff the element was not contained before.
+    bool insert(int element) {
+        if (stamps[element] == epoch)
+            return false;
+        stamps[element] = epoch;
+        return true;
+    }
+};
+
+/*
+  A fixed binary relation over operators stored in compressed sparse row
+  format: the operators related to op_no are stored contiguously in
+  targets[offsets[op_no]], ..., targets[offsets[op_no + 1] - 1].
+*/
+class OperatorRelation {
+    std::vector<int> offsets;
+    std::vector<int> targets;
+public:
+    OperatorRelation()
+        : offsets(1, 0) {
+    }
+
+    // Rows have to be added in order of operator indices.
+    void add_row(const std::vector<int> &row);
+
+    ArrayView<const int> operator[](int op_no) const {
+        return ArrayView<const int>(targets.data() + offsets[op_no],
+                                    offsets[op_no + 1] - offsets[op_no]);
+    }
+};
+
+/*
+  Numeric conditions and axioms are supported by treating derived
+  variables conservatively: an operator writes a derived variable (with the
+  unknown value ANY_VALUE) if it writes a variable the derived variable
+  depends on. The variables of comparison axioms depend on the numeric
+  variables occurring in the compared expressions, the variables of logic
+  axioms on the variables in their conditions. Two operators additionally
+  conflict if one of them writes a numeric variable the other one reads or
+  writes, unless both only increase or decrease it.
+*/
 class StubbornSets : public PruningMethod {
     long num_unpruned_successors_generated;
     long num_pruned_successors_generated;
 
-    /* stubborn[op_no] is true iff the operator with operator index
-       op_no is contained in the stubborn set */
-    std::vector<bool> stubborn;
+    /* stubborn.contains(op_no) is true iff the operator with operator
+       index op_no is contained in the stubborn set */
+    EpochSet stubborn;
 
     /*
       stubborn_queue contains the operator indices of operators that
@@ -21,10 +89,33 @@ class StubbornSets : public PruningMethod {
     */
     std::vector<int> stubborn_queue;
 
+    struct NumericEffect {
+        int var;
+        bool additive;
+        NumericEffect(int var, bool additive)
+            : var(var), additive(additive) {
+        }
+    };
+
+    // Sorted by variable, at most one entry per variable.
+    std::vector<std::vector<NumericEffect>> sorted_op_numeric_effects;
+    // Sorted numeric variables read by the numeric effects of an operator.
+    std::vector<std::vector<int>> sorted_op_numeric_reads;
+
+    // The index of the only logic axiom deriving a variable, or -1.
+    std::vector<int> single_logic_axiom;
+
     void compute_sorted_operators();
     void compute_achievers();
 
+    bool can_conflict_numerically(int op1_no, int op2_no) const;
+
 protected:
+    static constexpr int ANY_VALUE = -1;
+
+    /* Preconditions and effects of each operator sorted by variable.
+       The effects include facts (var, ANY_VALUE) for the derived
+       variables the operator can change. */
     std::vector<std::vector<Fact>> sorted_op_preconditions;
     std::vector<std::vector<Fact>> sorted_op_effects;
 
@@ -32,8 +123,16 @@ protected:
        operators that achieve the fact (var, value). */
     std::vector<std::vector<std::vector<int>>> achievers;
 
-    bool can_disable(int op1_no, int op2_no);
-    bool can_conflict(int op1_no, int op2_no);
+    /*
+      Returns a fact that has to become true before the given unsatisfied
+      fact can become true. For derived variables set by a single logic
+      axiom, this is an unsatisfied condition of the axiom, whose necessary
+      enabling set is usually much smaller. Otherwise it is fact itself.
+    */
+    Fact get_unsatisfied_enabling_fact(Fact fact, const GlobalState &state) const;
+
+    bool can_disable(int op1_no, int op2_no) const;
+    bool can_conflict(int op1_no, int op2_no) const;
 
     // Returns true iff the operators was enqueued.
     // TODO: rename to enqueue_stubborn_operator?
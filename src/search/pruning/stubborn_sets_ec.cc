@@ -34,7 +34,7 @@ static inline Fact find_unsatisfied_goal(const GlobalState &state) {
     return Fact(-1, -1);
 }
 
-vector<StubbornDTG> build_dtgs() {
+vector<StubbornDTG> StubbornSetsEC::build_dtgs() const {
     /*
       NOTE: Code lifted and adapted from M&S atomic abstraction code.
       We need a more general mechanism for creating data structures of
@@ -46,6 +46,10 @@ vector<StubbornDTG> build_dtgs() {
       self-loops from d to d if there is an operator that sets the
       value of v to d and has no precondition on v. This is different
       from the usual DTG definition.
+
+      Operators that can change a derived variable have an effect with
+      ANY_VALUE on it, which we represent by arcs from
+      every value to every value.
      */
 
     // Create the empty DTG nodes.
@@ -56,15 +60,21 @@ vector<StubbornDTG> build_dtgs() {
     }
 
     // Add DTG arcs.
-    for (const GlobalOperator &op : g_operators) {
-        for (const GlobalEffect &effect : op.get_effects()) {
+    vector<bool> fully_connected(num_variables, false);
+    int num_operators = g_operators.size();
+    for (int op_no = 0; op_no < num_operators; ++op_no) {
+        for (const Fact &effect : sorted_op_effects[op_no]) {
             int eff_var = effect.var;
-            int eff_val = effect.val;
+            int eff_val = effect.value;
+            if (eff_val == ANY_VALUE) {
+                fully_connected[eff_var] = true;
+                continue;
+            }
             int pre_val = -1;
 
-            for (const GlobalCondition &precondition : op.get_preconditions()) {
+            for (const Fact &precondition : sorted_op_preconditions[op_no]) {
                 if (precondition.var == eff_var) {
-                    pre_val = precondition.val;
+                    pre_val = precondition.value;
                     break;
                 }
             }
@@ -79,15 +89,26 @@ vector<StubbornDTG> build_dtgs() {
             }
         }
     }
+
+    for (int var_no = 0; var_no < num_variables; ++var_no) {
+        if (fully_connected[var_no]) {
+            StubbornDTG &dtg = dtgs[var_no];
+            for (vector<int> &successors : dtg) {
+                successors.clear();
+                for (int value = 0; value < (int) dtg.size(); ++value)
+                    successors.push_back(value);
+            }
+        }
+    }
     return dtgs;
 }
 
 void recurse_forwards(const StubbornDTG &dtg,
                       int start_value,
                       int current_value,
-                      vector<bool> &reachable) {
-    if (!reachable[current_value]) {
-        reachable[current_value] = true;
+                      BitsetView &reachable) {
+    if (!reachable.test(current_value)) {
+        reachable.set(current_value);
         for (int successor_value : dtg[current_value])
             recurse_forwards(dtg, start_value, successor_value, reachable);
     }
@@ -116,16 +137,20 @@ void get_conflicting_vars(const vector<Fact> &facts1,
     }
 }
 
-StubbornSetsEC::StubbornSetsEC() {
+StubbornSetsEC::StubbornSetsEC()
+    : active_ops(g_operators.size()),
+      written_vars(g_variable_domain.size()) {
+    int num_facts = 0;
+    for (int domain_size : g_variable_domain) {
+        fact_offsets.push_back(num_facts);
+        num_facts += domain_size;
+    }
+    nes_computed.resize(num_facts);
+
     compute_operator_preconditions();
     compute_conflicts_and_disabling();
     build_reachability_map();
 
-    int num_variables = g_variable_domain.size();
-    for (int var = 0; var < num_variables; var++) {
-        nes_computed.push_back(vector<bool>(g_variable_domain[var], false));
-    }
-
     cout << "pruning method: stubborn sets ec" << endl;
 }
 
@@ -142,19 +167,29 @@ void StubbornSetsEC::compute_operator_preconditions() {
     }
 }
 
+bool StubbornSetsEC::is_reachable(int var, int from_value, int to_value) const {
+    const BitsetView::Block *reachable = &reachability_blocks[
+        reachability_offsets[get_fact_index(var, from_value)]];
+    BitsetView::Block block = reachable[to_value / BitsetView::bits_per_block];
+    return (block >> (to_value % BitsetView::bits_per_block)) & 1;
+}
+
 void StubbornSetsEC::build_reachability_map() {
     vector<StubbornDTG> dtgs = build_dtgs();
     int num_variables = g_variable_domain.size();
-    reachability_map.resize(num_variables);
     for (int var = 0; var < num_variables; ++var) {
-        StubbornDTG &dtg = dtgs[var];
-        int num_values = dtg.size();
-        reachability_map[var].resize(num_values);
-        for (int val = 0; val < num_values; ++val) {
-            reachability_map[var][val].assign(num_values, false);
+        int num_blocks = BitsetView::compute_num_blocks(g_variable_domain[var]);
+        for (int value = 0; value < (int) g_variable_domain[var]; ++value) {
+            reachability_offsets.push_back(reachability_blocks.size());
+            reachability_blocks.resize(reachability_blocks.size() + num_blocks, 0);
         }
+    }
+
+    for (int var = 0; var < num_variables; ++var) {
+        StubbornDTG &dtg = dtgs[var];
         for (int start_value = 0; start_value < (int) g_variable_domain[var]; start_value++) {
-            vector<bool> &reachable = reachability_map[var][start_value];
+            int offset = reachability_offsets[get_fact_index(var, start_value)];
+            BitsetView reachable(&reachability_blocks[offset], dtg.size());
             recurse_forwards(dtg, start_value, start_value, reachable);
         }
     }
@@ -170,23 +205,22 @@ void StubbornSetsEC::compute_active_operators(const GlobalState &state) {
             int var = precondition.var;
             int value = precondition.val;
             int current_value = state[var];
-            const vector<bool> &reachable_values = reachability_map[var][current_value];
-            if (!reachable_values[value]) {
+            if (!is_reachable(var, current_value, value)) {
                 all_preconditions_are_active = false;
                 break;
             }
         }
 
         if (all_preconditions_are_active) {
-            active_ops[op_no] = true;
+            active_ops.insert(op_no);
         }
     }
 }
 
 void StubbornSetsEC::compute_conflicts_and_disabling() {
     int num_operators = g_operators.size();
-    conflicting_and_disabling.resize(num_operators);
-    disabled.resize(num_operators);
+    vector<vector<int>> conflicting_and_disabling_ops(num_operators);
+    vector<vector<int>> disabled_ops(num_operators);
 
     for (int op1_no = 0; op1_no < num_operators; ++op1_no) {
         for (int op2_no = 0; op2_no < num_operators; ++op2_no) {
@@ -194,14 +228,19 @@ void StubbornSetsEC::compute_conflicts_and_disabling() {
                 bool conflict = can_conflict(op1_no, op2_no);
                 bool disable = can_disable(op2_no, op1_no);
                 if (conflict || disable) {
-                    conflicting_and_disabling[op1_no].push_back(op2_no);
+                    conflicting_and_disabling_ops[op1_no].push_back(op2_no);
                 }
                 if (disable) {
-                    disabled[op2_no].push_back(op1_no);
+                    disabled_ops[op2_no].push_back(op1_no);
                 }
             }
         }
     }
+
+    for (int op_no = 0; op_no < num_operators; ++op_no) {
+        conflicting_and_disabling.add_row(conflicting_and_disabling_ops[op_no]);
+        disabled.add_row(disabled_ops[op_no]);
+    }
 }
 
 // TODO: find a better name.
@@ -210,8 +249,8 @@ void StubbornSetsEC::mark_as_stubborn_and_remember_written_vars(
     if (mark_as_stubborn(op_no)) {
         const GlobalOperator &op = g_operators[op_no];
         if (op.is_applicable(state)) {
-            for (const GlobalEffect &effect : op.get_effects()) {
-                written_vars[effect.var] = true;
+            for (const Fact &effect : sorted_op_effects[op_no]) {
+                written_vars.insert(effect.var);
             }
         }
     }
@@ -221,18 +260,18 @@ void StubbornSetsEC::mark_as_stubborn_and_remember_written_vars(
    better from the corresponding method for simple stubborn sets */
 void StubbornSetsEC::add_nes_for_fact(Fact fact, const GlobalState &state) {
     for (int achiever : achievers[fact.var][fact.value]) {
-        if (active_ops[achiever]) {
+        if (active_ops.contains(achiever)) {
             mark_as_stubborn_and_remember_written_vars(achiever, state);
         }
     }
 
-    nes_computed[fact.var][fact.value] = true;
+    nes_computed.insert(get_fact_index(fact.var, fact.value));
 }
 
 void StubbornSetsEC::add_conflicting_and_disabling(int op_no,
                                                    const GlobalState &state) {
     for (int conflict : conflicting_and_disabling[op_no]) {
-        if (active_ops[conflict])
+        if (active_ops.contains(conflict))
             mark_as_stubborn_and_remember_written_vars(conflict, state);
     }
 }
@@ -253,8 +292,8 @@ void StubbornSetsEC::apply_s5(const GlobalOperator &op, const GlobalState &state
         int value = precondition.val;
 
         if ((int) state[var] != value) {
-            if (written_vars[var]) {
-                if (!nes_computed[var][value]) {
+            if (written_vars.contains(var)) {
+                if (!nes_computed.contains(get_fact_index(var, value))) {
                     add_nes_for_fact(Fact(var, value), state);
                 }
                 return;
@@ -266,26 +305,24 @@ void StubbornSetsEC::apply_s5(const GlobalOperator &op, const GlobalState &state
     }
 
     assert(violated_precondition.var != -1);
-    if (!nes_computed[violated_precondition.var][violated_precondition.value]) {
+    if (!nes_computed.contains(get_fact_index(violated_precondition.var,
+                                              violated_precondition.value))) {
         add_nes_for_fact(violated_precondition, state);
     }
 }
 
 void StubbornSetsEC::initialize_stubborn_set(const GlobalState &state) {
     active_ops.clear();
-    active_ops.assign(g_operators.size(), false);
-    for (size_t i = 0; i < nes_computed.size(); i++) {
-        nes_computed[i].clear();
-        nes_computed[i].assign(g_variable_domain[i], false);
-    }
-    written_vars.assign(g_variable_domain.size(), false);
+    nes_computed.clear();
+    written_vars.clear();
 
     compute_active_operators(state);
 
     //rule S1
     Fact unsatisfied_goal = find_unsatisfied_goal(state);
     assert(unsatisfied_goal.var != -1);
-    add_nes_for_fact(unsatisfied_goal, state);     // active operators used
+    add_nes_for_fact(get_unsatisfied_enabling_fact(unsatisfied_goal, state),
+                     state);     // active operators used
 }
 
 void StubbornSetsEC::handle_stubborn_operator(const GlobalState &state, int op_no) {
@@ -296,7 +333,7 @@ void StubbornSetsEC::handle_stubborn_operator(const GlobalState &state, int op_n
         //Rule S4'
         vector<int> disabled_vars;
         for (int disabled_op_no : disabled[op_no]) {
-            if (active_ops[disabled_op_no]) {
+            if (active_ops.contains(disabled_op_no)) {
                 get_disabled_vars(op_no, disabled_op_no, disabled_vars);
                 if (!disabled_vars.empty()) {     // == can_disable(op1_no, op2_no)
                     bool v_applicable_op_found = false;
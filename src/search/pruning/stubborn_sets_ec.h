@@ -3,18 +3,33 @@
 
 #include "stubborn_sets.h"
 
+#include "../per_state_bitset.h"
+
 namespace stubborn_sets_ec {
 class StubbornSetsEC : public stubborn_sets::StubbornSets {
 private:
-    std::vector<std::vector<std::vector<bool>>> reachability_map;
+    // fact_offsets[var] + value is the index of the fact (var, value).
+    std::vector<int> fact_offsets;
+    /* The values reachable from (var, value) in the DTG of var are stored
+       as a bitset of g_variable_domain[var] bits starting at block
+       reachability_offsets[fact index] of reachability_blocks. */
+    std::vector<BitsetView::Block> reachability_blocks;
+    std::vector<int> reachability_offsets;
     std::vector<std::vector<int>> op_preconditions_on_var;
-    std::vector<bool> active_ops;
-    std::vector<std::vector<int>> conflicting_and_disabling;
-    std::vector<std::vector<int>> disabled;
-    std::vector<bool> written_vars;
-    std::vector<std::vector<bool>> nes_computed;
+    stubborn_sets::EpochSet active_ops;
+    stubborn_sets::OperatorRelation conflicting_and_disabling;
+    stubborn_sets::OperatorRelation disabled;
+    stubborn_sets::EpochSet written_vars;
+    // Indexed by fact index.
+    stubborn_sets::EpochSet nes_computed;
+
+    int get_fact_index(int var, int value) const {
+        return fact_offsets[var] + value;
+    }
+    bool is_reachable(int var, int from_value, int to_value) const;
 
     void get_disabled_vars(int op1_no, int op2_no, std::vector<int> &disabled_vars);
+    std::vector<std::vector<std::vector<int>>> build_dtgs() const;
     void build_reachability_map();
     void compute_operator_preconditions();
     void compute_conflicts_and_disabling();
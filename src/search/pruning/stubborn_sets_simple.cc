@@ -44,21 +44,20 @@ StubbornSetsSimple::StubbornSetsSimple() {
 
 void StubbornSetsSimple::compute_interference_relation() {
     int num_operators = g_operators.size();
-    interference_relation.resize(num_operators);
+    vector<vector<int>> interfering_ops(num_operators);
 
-    /*
-       TODO: as interference is symmetric, we only need to compute the
-       relation for operators (o1, o2) with (o1 < o2) and add a lookup
-       method that looks up (i, j) if i < j and (j, i) otherwise.
-    */
+    // Interference is symmetric, so we only test pairs with op1 < op2.
     for (int op1_no = 0; op1_no < num_operators; ++op1_no) {
-        vector<int> &interfere_op1 = interference_relation[op1_no];
-        for (int op2_no = 0; op2_no < num_operators; ++op2_no) {
-            if (op1_no != op2_no && interfere(op1_no, op2_no)) {
-                interfere_op1.push_back(op2_no);
+        for (int op2_no = op1_no + 1; op2_no < num_operators; ++op2_no) {
+            if (interfere(op1_no, op2_no)) {
+                interfering_ops[op1_no].push_back(op2_no);
+                interfering_ops[op2_no].push_back(op1_no);
             }
         }
     }
+
+    for (const vector<int> &row : interfering_ops)
+        interference_relation.add_row(row);
 }
 
 // Add all operators that achieve the fact (var, value) to stubborn set.
@@ -79,7 +78,8 @@ void StubbornSetsSimple::initialize_stubborn_set(const GlobalState &state) {
     // Add a necessary enabling set for an unsatisfied goal.
     Fact unsatisfied_goal = find_unsatisfied_goal(state);
     assert(unsatisfied_goal.var != -1);
-    add_necessary_enabling_set(unsatisfied_goal);
+    add_necessary_enabling_set(
+        get_unsatisfied_enabling_fact(unsatisfied_goal, state));
 }
 
 void StubbornSetsSimple::handle_stubborn_operator(const GlobalState &state,
@@ -94,7 +94,8 @@ void StubbornSetsSimple::handle_stubborn_operator(const GlobalState &state,
     } else {
         /* unsatisfied precondition found
            => add a necessary enabling set for it */
-        add_necessary_enabling_set(unsatisfied_precondition);
+        add_necessary_enabling_set(
+            get_unsatisfied_enabling_fact(unsatisfied_precondition, state));
     }
 }
 
@@ -7,12 +7,12 @@ namespace stubborn_sets_simple {
 class StubbornSetsSimple : public stubborn_sets::StubbornSets {
     /* interference_relation[op1_no] contains all operator indices
        of operators that interfere with op1. */
-    std::vector<std::vector<int>> interference_relation;
+    stubborn_sets::OperatorRelation interference_relation;
 
     void add_necessary_enabling_set(Fact fact);
     void add_interfering(int op_no);
 
-    inline bool interfere(int op1_no, int op2_no) {
+    inline bool interfere(int op1_no, int op2_no) const {
         return can_disable(op1_no, op2_no) ||
                can_conflict(op1_no, op2_no) ||
                can_disable(op2_no, op1_no);
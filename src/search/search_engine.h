@@ -28,7 +28,7 @@ protected:
     SearchSpace search_space;
     SearchProgress search_progress;
     SearchStatistics statistics;
-    int bound;
+    ap_float bound;
     OperatorCost cost_type;
     double max_time;
 
@@ -49,8 +49,10 @@ public:
     const Plan &get_plan() const;
     void search();
     const SearchStatistics &get_statistics() const {return statistics; }
-    void set_bound(int b) {bound = b; }
-    int get_bound() {return bound; }
+    void set_bound(ap_float b) {bound = b; }
+    ap_float get_bound() {return bound; }
+    void set_max_time(double t) {max_time = t; }
+    double get_max_time() const {return max_time; }
     static void add_options_to_parser(options::OptionParser &parser);
 };
 
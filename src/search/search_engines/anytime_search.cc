@@ -0,0 +1,289 @@
+#include "anytime_search.h"
+
+#include "../evaluation_context.h"
+#include "../globals.h"
+#include "../heuristic.h"
+#include "../option_parser.h"
+#include "../plugin.h"
+#include "../successor_generator.h"
+
+#include <algorithm>
+#include <cassert>
+#include <iostream>
+#include <limits>
+#include <set>
+
+using namespace std;
+
+namespace anytime_search {
+struct OpenEntryCompare {
+    // std::push_heap builds a max-heap, so this is "worse than".
+    bool operator()(const OpenEntry &lhs, const OpenEntry &rhs) const {
+        if (lhs.f != rhs.f)
+            return lhs.f > rhs.f;
+        if (lhs.h != rhs.h)
+            return lhs.h > rhs.h;
+        return lhs.g < rhs.g;
+    }
+};
+
+AnytimeSearch::AnytimeSearch(const Options &opts)
+    : SearchEngine(opts),
+      evaluator(opts.get<ScalarEvaluator *>("eval")),
+      weights(opts.get_list<double>("weights")),
+      iteration(0),
+      cost_bound(bound),
+      f_bound(numeric_limits<ap_float>::infinity()),
+      found_plan(false) {
+}
+
+void AnytimeSearch::push(StateID id, ap_float g, ap_float h) {
+    open_list.emplace_back(g + weights[iteration] * h, h, g, id);
+    push_heap(open_list.begin(), open_list.end(), OpenEntryCompare());
+}
+
+void AnytimeSearch::initialize() {
+    cout << "Conducting anytime repairing A* with weights";
+    for (double weight : weights)
+        cout << " " << weight;
+    cout << ", (real) bound = " << bound << endl;
+
+    set<Heuristic *> hset;
+    evaluator->get_involved_heuristics(hset);
+    heuristics.assign(hset.begin(), hset.end());
+
+    const GlobalState &initial_state = g_initial_state();
+    EvaluationContext eval_context(initial_state, 0, true, &statistics);
+    statistics.inc_evaluated_states();
+    if (eval_context.is_heuristic_infinite(evaluator)) {
+        cout << "Initial state is a dead end." << endl;
+    } else {
+        ap_float h = eval_context.get_heuristic_value(evaluator);
+        node_infos[initial_state].h = h;
+        SearchNode node = search_space.get_node(initial_state);
+        node.open_initial();
+        push(initial_state.get_id(), 0, h);
+    }
+    print_initial_h_values(eval_context);
+    cout << "Starting iteration with weight " << weights[iteration] << endl;
+}
+
+void AnytimeSearch::start_iteration() {
+    ++iteration;
+    cout << "Starting iteration with weight " << weights[iteration]
+         << " [expanded " << statistics.get_expanded() << " state(s)]"
+         << endl;
+
+    /*
+      Re-sort the open list with the new weight. Entries of states that
+      were closed or reached with a lower g-value since they were inserted
+      are dropped here instead of when they are removed.
+    */
+    vector<OpenEntry> old_entries;
+    old_entries.swap(open_list);
+    open_list.reserve(old_entries.size() + inconsistent_states.size());
+    for (const OpenEntry &entry : old_entries) {
+        SearchNode node = search_space.get_node(
+            g_state_registry->lookup_state(entry.id));
+        if (node.is_open() && node.get_g() == entry.g)
+            open_list.emplace_back(
+                entry.g + weights[iteration] * entry.h, entry.h, entry.g,
+                entry.id);
+    }
+    for (StateID id : inconsistent_states) {
+        GlobalState state = g_state_registry->lookup_state(id);
+        SearchNode node = search_space.get_node(state);
+        ap_float h = node_infos[state].h;
+        open_list.emplace_back(
+            node.get_g() + weights[iteration] * h, h, node.get_g(), id);
+    }
+    inconsistent_states.clear();
+    make_heap(open_list.begin(), open_list.end(), OpenEntryCompare());
+}
+
+void AnytimeSearch::handle_solution(
+    const SearchNode &goal_node, const GlobalState &goal_state) {
+    Plan plan;
+    search_space.trace_path(goal_state, plan);
+    set_plan(plan);
+    save_plan(plan, true);
+    found_plan = true;
+    cost_bound = calculate_plan_cost(plan);
+    f_bound = goal_node.get_g();
+    cout << "Solution found with weight " << weights[iteration]
+         << ", cost " << cost_bound << endl;
+}
+
+void AnytimeSearch::expand(SearchNode &node, const GlobalState &state) {
+    vector<const GlobalOperator *> applicable_ops;
+    g_successor_generator->generate_applicable_ops(state, applicable_ops);
+    bool last_iteration = iteration == static_cast<int>(weights.size()) - 1;
+
+    for (const GlobalOperator *op : applicable_ops) {
+        if ((node.get_real_g() + op->get_cost()) >= cost_bound)
+            continue;
+
+        GlobalState succ_state = g_state_registry->get_successor_state(state, *op);
+        statistics.inc_generated();
+        SearchNode succ_node = search_space.get_node(succ_state);
+
+        // Previously encountered dead end. Don't re-evaluate.
+        if (succ_node.is_dead_end())
+            continue;
+
+        ap_float succ_g = node.get_g() + get_adjusted_cost(*op);
+        if (succ_node.is_new()) {
+            EvaluationContext eval_context(
+                succ_state, succ_g, false, &statistics);
+            statistics.inc_evaluated_states();
+            if (eval_context.is_heuristic_infinite(evaluator)) {
+                succ_node.mark_as_dead_end();
+                statistics.inc_dead_ends();
+                continue;
+            }
+            ap_float h = eval_context.get_heuristic_value(evaluator);
+            node_infos[succ_state].h = h;
+            succ_node.open(node, op);
+            push(succ_state.get_id(), succ_g, h);
+        } else if (succ_node.get_g() > succ_g) {
+            // The evaluator value of the state is cached.
+            AnytimeNodeInfo &info = node_infos[succ_state];
+            if (succ_node.is_closed())
+                statistics.inc_reopened();
+            succ_node.reopen(node, op);
+            /*
+              In all but the last iteration, each state is expanded at
+              most once. The last iteration reopens states like A*, so
+              that the final plan is optimal for admissible evaluators.
+            */
+            if (info.expanded_in_iteration == iteration && !last_iteration)
+                inconsistent_states.push_back(succ_state.get_id());
+            else
+                push(succ_state.get_id(), succ_g, info.h);
+        }
+    }
+}
+
+SearchStatus AnytimeSearch::step() {
+    /*
+      The iteration ends when no state in the open list has a smaller f-value
+      than the adjusted cost of the best plan. The remaining states stay in
+      the open list for the next iteration.
+    */
+    while (!open_list.empty() && open_list.front().f < f_bound) {
+        pop_heap(open_list.begin(), open_list.end(), OpenEntryCompare());
+        OpenEntry entry = open_list.back();
+        open_list.pop_back();
+
+        GlobalState state = g_state_registry->lookup_state(entry.id);
+        if (violates_global_constraint(state))
+            continue;
+        SearchNode node = search_space.get_node(state);
+        // Skip closed states and outdated entries of reopened states.
+        if (!node.is_open() || node.get_g() != entry.g)
+            continue;
+        // No plan through this state is cheaper than the best plan.
+        if (node.get_real_g() >= cost_bound)
+            continue;
+
+        node.close();
+        node_infos[state].expanded_in_iteration = iteration;
+        statistics.inc_expanded();
+
+        if (test_goal(state)) {
+            handle_solution(node, state);
+            if (iteration == static_cast<int>(weights.size()) - 1)
+                return SOLVED;
+            start_iteration();
+            return IN_PROGRESS;
+        }
+        expand(node, state);
+        return IN_PROGRESS;
+    }
+
+    if ((!open_list.empty() || !inconsistent_states.empty()) &&
+        iteration < static_cast<int>(weights.size()) - 1) {
+        start_iteration();
+        return IN_PROGRESS;
+    }
+    if (found_plan) {
+        cout << "No cheaper plan found with weight " << weights[iteration]
+             << "." << endl;
+        return SOLVED;
+    }
+    cout << "Completely explored state space -- no solution!" << endl;
+    return FAILED;
+}
+
+void AnytimeSearch::print_statistics() const {
+    statistics.print_detailed_statistics();
+    search_space.print_statistics();
+    for (const Heuristic *heuristic : heuristics)
+        heuristic->print_statistics();
+}
+
+void AnytimeSearch::save_plan_if_necessary() const {
+    // We don't need to save here, as we automatically save each plan
+    // when it is found.
+}
+
+static SearchEngine *_parse(OptionParser &parser) {
+    parser.document_synopsis(
+        "Anytime repairing A* (ARA*)",
+        "Weighted A* search with f = g + w * h for a decreasing sequence of "
+        "weights w. Every time a plan is found, the plan is saved, its cost "
+        "becomes the bound, and the search continues with the next weight. "
+        "In contrast to iterated searches, all weights share the search "
+        "space: the g-values, parents and evaluator values of the states "
+        "are kept, the open list is re-sorted with the new weight, and "
+        "states are only expanded again if they were reached on a cheaper "
+        "path. See\n\n"
+        " * Maxim Likhachev, Geoffrey J. Gordon and Sebastian Thrun.<<BR>>\n"
+        " [ARA*: Anytime A* with Provable Bounds on Sub-Optimality "
+        "http://papers.nips.cc/paper/2382-ara-anytime-a-with-provable-bounds-on-sub-optimality.pdf].<<BR>>\n"
+        " In //Advances in Neural Information Processing Systems 16 (NIPS "
+        "2003)//, pp. 767-774. 2004.\n\n");
+    parser.document_note(
+        "Plan quality",
+        "With an admissible evaluator, the cost of the plan found with "
+        "weight w is at most w times the optimal cost. An iteration ends "
+        "when it finds a plan or when no state in the open list has an "
+        "f-value below the cost of the best plan; the remaining states are "
+        "kept for the next iteration. The search stops "
+        "when a plan is found with the last weight or when the last "
+        "iteration ends, so the last plan is optimal if the last weight "
+        "is 1.");
+    parser.document_note(
+        "Evaluators",
+        "The evaluator is computed once per state. Path-dependent "
+        "heuristics (e.g. lmcount) and preferred operators are not "
+        "supported.");
+    parser.add_option<ScalarEvaluator *>("eval", "evaluator for h-value");
+    parser.add_list_option<double>(
+        "weights",
+        "decreasing weights of the iterations",
+        "[5, 3, 2, 1]");
+    SearchEngine::add_options_to_parser(parser);
+    Options opts = parser.parse();
+
+    opts.verify_list_non_empty<double>("weights");
+
+    if (parser.help_mode())
+        return nullptr;
+
+    vector<double> weights = opts.get_list<double>("weights");
+    for (size_t i = 0; i < weights.size(); ++i) {
+        if (weights[i] < 1)
+            parser.error("weights must be at least 1");
+        if (i > 0 && weights[i] >= weights[i - 1])
+            parser.error("weights must be decreasing");
+    }
+
+    if (parser.dry_run())
+        return nullptr;
+    else
+        return new AnytimeSearch(opts);
+}
+
+static Plugin<SearchEngine> _plugin("arastar", _parse);
+}
@@ -0,0 +1,97 @@
+#ifndef SEARCH_ENGINES_ANYTIME_SEARCH_H
+#define SEARCH_ENGINES_ANYTIME_SEARCH_H
+
+#include "../per_state_information.h"
+#include "../search_engine.h"
+
+#include <vector>
+
+class GlobalState;
+class Heuristic;
+class ScalarEvaluator;
+
+namespace options {
+class Options;
+}
+
+namespace anytime_search {
+struct AnytimeNodeInfo {
+    // Cached value of the evaluator, -1 if the state was not evaluated.
+    ap_float h;
+    // Weight iteration in which the state was last expanded, -1 if never.
+    int expanded_in_iteration;
+
+    AnytimeNodeInfo()
+        : h(-1), expanded_in_iteration(-1) {
+    }
+};
+
+struct OpenEntry {
+    ap_float f;
+    ap_float h;
+    ap_float g;
+    StateID id;
+
+    OpenEntry(ap_float f, ap_float h, ap_float g, StateID id)
+        : f(f), h(h), g(g), id(id) {
+    }
+};
+
+/*
+  Anytime repairing A* (ARA*, Likhachev et al., NIPS 2003). The search runs
+  weighted A* with f = g + w * h for a decreasing sequence of weights w.
+  In contrast to an iterated search with one weighted A* search per
+  weight, all weights share one search space: the registry, the g-values
+  and parents of the search nodes and the cached evaluator values are kept
+  when the weight decreases. States that were expanded in an earlier
+  iteration are only expanded again if they are reached with a lower
+  g-value, and the open list is re-sorted with the new weight instead of
+  starting over from the initial state.
+
+  An iteration ends when it finds a plan or when no state in the open
+  list has an f-value below the cost of the best plan. Within an
+  iteration, states that get cheaper after their expansion are not
+  reopened but collected in an inconsistency list that is merged into the
+  open list when the next iteration starts.
+*/
+class AnytimeSearch : public SearchEngine {
+    ScalarEvaluator *evaluator;
+    const std::vector<double> weights;
+
+    std::vector<Heuristic *> heuristics;
+    PerStateInformation<AnytimeNodeInfo> node_infos;
+
+    // Binary heap ordered by f, then h, then g (see OpenEntryCompare).
+    std::vector<OpenEntry> open_list;
+    // States that got cheaper after their expansion in this iteration.
+    std::vector<StateID> inconsistent_states;
+
+    int iteration;
+    // Real cost of the best plan found so far, or the bound.
+    ap_float cost_bound;
+    /*
+      Adjusted cost (see cost_type) of the best plan found so far, or
+      infinity. The f-values are adjusted costs, so the end of an
+      iteration is tested against this bound and not against cost_bound.
+    */
+    ap_float f_bound;
+    bool found_plan;
+
+    void push(StateID id, ap_float g, ap_float h);
+    void start_iteration();
+    void expand(SearchNode &node, const GlobalState &state);
+    void handle_solution(
+        const SearchNode &goal_node, const GlobalState &goal_state);
+
+    virtual void initialize() override;
+    virtual SearchStatus step() override;
+public:
+    explicit AnytimeSearch(const options::Options &opts);
+    virtual ~AnytimeSearch() override = default;
+
+    virtual void print_statistics() const override;
+    virtual void save_plan_if_necessary() const override;
+};
+}
+
+#endif
@@ -117,7 +117,7 @@ void DksEagerSearch::initialize() {
               initial_state.get_id(),
           initial_state.dump_plan_vis_log(),
           h_val,
-          h_time,
+          h_time(),
           search_space.get_node(initial_state).get_g(),
           initial_state.get_id(),
           test_goal(initial_state),
@@ -256,7 +256,7 @@ SearchStatus DksEagerSearch::step() {
                   succ_state.get_id(),
             succ_state.dump_plan_vis_log(s),
             succ_h,
-              h_time,
+              h_time(),
             succ_g,
             s.get_id(),
             test_goal(succ_state),
@@ -11,10 +11,13 @@
 #include "../successor_generator.h"
 #include "../utils/timer.h"
 #include "../utils/planvis.h"
+#include "../utils/profiler.h"
+#include "../utils/search_trace.h"
 
 #include "../open_lists/open_list_factory.h"
 
 #include <cassert>
+#include <chrono>
 #include <cstdlib>
 #include <memory>
 #include <set>
@@ -72,6 +75,9 @@ void EagerSearch::initialize() {
 
     statistics.inc_evaluated_states();
 
+    chrono::steady_clock::time_point h_start;
+    if (PLAN_VIS_LOG == plan_vis_log || g_search_trace)
+        h_start = chrono::steady_clock::now();
     if (open_list->is_dead_end(eval_context)) {
         cout << "Initial state is a dead end." << endl;
     } else {
@@ -83,14 +89,19 @@ void EagerSearch::initialize() {
 
         open_list->insert(eval_context, initial_state.get_id());
     }
+    double h_time = 0;
+    if (PLAN_VIS_LOG == plan_vis_log || g_search_trace)
+        h_time = utils::SearchTraceWriter::get_elapsed_seconds(h_start);
 
     print_initial_h_values(eval_context);
-    if (PLAN_VIS_LOG == plan_vis_log) {
-        utils::Timer h_time;
-        if (PLAN_VIS_LOG) h_time.reset();
+    if ((PLAN_VIS_LOG == plan_vis_log || g_search_trace) &&
+        !eval_context.is_heuristic_infinite(heuristics[0])) {
         ap_float h_val = eval_context.get_heuristic_value(heuristics[0]);
-        if (PLAN_VIS_LOG) {
-        	h_time.stop();
+        if (g_search_trace) {
+            g_search_trace->log_node(initial_state, nullptr, nullptr, 0, h_val,
+                                     h_time, test_goal(initial_state));
+        }
+        if (PLAN_VIS_LOG == plan_vis_log) {
         	g_plan_logger->log_node(
         			initial_state.get_id(),
 					initial_state.dump_plan_vis_log(),
@@ -144,7 +155,12 @@ SearchStatus EagerSearch::step() {
       TODO: When preferred operators are in use, a preferred operator will be
       considered by the preferred operator queues even when it is pruned.
     */
-    pruning_method->prune_operators(s, applicable_ops);
+    {
+        static utils::ProfileNode &profile_node =
+            utils::get_profile_node("search/pruning");
+        utils::ProfileScope profile_scope(profile_node);
+        pruning_method->prune_operators(s, applicable_ops);
+    }
 
     // This evaluates the expanded state (again) to get preferred ops
     EvaluationContext eval_context(s, node.get_g(), false, &statistics, true);
@@ -160,11 +176,19 @@ SearchStatus EagerSearch::step() {
         }
     }
 
+    vector<const GlobalOperator *> successor_ops;
+    successor_ops.reserve(applicable_ops.size());
     for (const GlobalOperator *op : applicable_ops) {
-        if ((node.get_real_g() + op->get_cost()) >= bound)
-            continue;
+        if ((node.get_real_g() + op->get_cost()) < bound)
+            successor_ops.push_back(op);
+    }
+    // Register all successors at once to overlap the cache misses of the registry.
+    vector<StateID> successor_ids;
+    g_state_registry->get_successor_states(s, successor_ops, successor_ids);
 
-        GlobalState succ_state = g_state_registry->get_successor_state(s, *op);
+    for (size_t i = 0; i < successor_ops.size(); ++i) {
+        const GlobalOperator *op = successor_ops[i];
+        GlobalState succ_state = g_state_registry->lookup_state(successor_ids[i]);
         statistics.inc_generated();
         bool is_preferred = (preferred_ops.find(op) != preferred_ops.end());
 
@@ -198,19 +222,18 @@ SearchStatus EagerSearch::step() {
                 succ_state, succ_g, is_preferred, &statistics);
             statistics.inc_evaluated_states();
 
+            // The heuristics are evaluated lazily by the dead end check.
+            chrono::steady_clock::time_point h_start;
+            if (PLAN_VIS_LOG == plan_vis_log || g_search_trace)
+                h_start = chrono::steady_clock::now();
             if (open_list->is_dead_end(eval_context)) {
                 succ_node.mark_as_dead_end();
                 statistics.inc_dead_ends();
                 continue;
             }
-            utils::Timer h_time;
-            if (PLAN_VIS_LOG == plan_vis_log) {h_time.reset();
-            assert(false); // todo: code changed here, have to fetch time somewhere else
-			}
-//            ap_float succ_h = 4;
-//  was before:
-            ap_float succ_h = eval_context.get_heuristic_value(heuristics[0]);
-            if (PLAN_VIS_LOG == plan_vis_log) h_time.stop();
+            double h_time = 0;
+            if (PLAN_VIS_LOG == plan_vis_log || g_search_trace)
+                h_time = utils::SearchTraceWriter::get_elapsed_seconds(h_start);
 
             succ_node.open(node, op);
 
@@ -219,7 +242,14 @@ SearchStatus EagerSearch::step() {
                 print_checkpoint_line(succ_node.get_g());
                 reward_progress();
             }
-            if (PLAN_VIS_LOG == plan_vis_log) {
+            if (PLAN_VIS_LOG == plan_vis_log || g_search_trace) {
+                ap_float succ_h = eval_context.is_heuristic_infinite(heuristics[0]) ?
+                    INF : eval_context.get_heuristic_value(heuristics[0]);
+                if (g_search_trace) {
+                    g_search_trace->log_node(succ_state, &s, op, succ_g, succ_h,
+                                             h_time, test_goal(succ_state));
+                }
+                if (PLAN_VIS_LOG == plan_vis_log)
             	g_plan_logger->log_node(
             			succ_state.get_id(),
 						succ_state.dump_plan_vis_log(s),
@@ -272,6 +302,10 @@ SearchStatus EagerSearch::step() {
                 // the g-value and the actual path that is traced back.
                 succ_node.update_parent(node, op);
             }
+            if (g_search_trace) {
+                g_search_trace->log_duplicate(
+                    succ_state, s, *op, node.get_g() + get_adjusted_cost(*op));
+            }
             if (PLAN_VIS_LOG == plan_vis_log)
             	g_plan_logger->log_duplicate(succ_state.get_id(),node.get_g() + get_adjusted_cost(*op),s.get_id());
         }
@@ -297,8 +331,14 @@ pair<SearchNode, bool> EagerSearch::fetch_next_node() {
             return make_pair(dummy_node, false);
         }
         vector<ap_float> last_key_removed;
-        StateID id = open_list->remove_min(
-            use_multi_path_dependence ? &last_key_removed : nullptr);
+        StateID id = StateID::no_state;
+        {
+            static utils::ProfileNode &profile_node =
+                utils::get_profile_node("search/open_list/remove_min");
+            utils::ProfileScope profile_scope(profile_node);
+            id = open_list->remove_min(
+                use_multi_path_dependence ? &last_key_removed : nullptr);
+        }
         // TODO is there a way we can avoid creating the state here and then
         //      recreate it outside of this function with node.get_state()?
         //      One way would be to store GlobalState objects inside SearchNodes
@@ -0,0 +1,443 @@
+#include "external_search.h"
+
+#include "../evaluation_context.h"
+#include "../global_operator.h"
+#include "../global_state.h"
+#include "../globals.h"
+#include "../option_parser.h"
+#include "../per_state_array.h"
+#include "../plugin.h"
+#include "../scalar_evaluator.h"
+#include "../state_registry.h"
+#include "../successor_generator.h"
+
+#include "../utils/system.h"
+#include "../utils/timer.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+#include <iostream>
+#include <numeric>
+#include <queue>
+
+using namespace std;
+using utils::ExitCode;
+
+namespace external_search {
+/*
+  Stored behind the packed state and the instrumentation variables of
+  each record. The packed state comes first because it is the sort key.
+*/
+struct NodeData {
+    ap_float g;
+    ap_float real_g;
+    long long parent_index;
+    int op_id;
+};
+
+static FILE *open_file(const string &filename, const char *mode) {
+    FILE *file = fopen(filename.c_str(), mode);
+    if (!file) {
+        cerr << "Could not open " << filename << endl;
+        utils::exit_with(ExitCode::CRITICAL_ERROR);
+    }
+    return file;
+}
+
+static void write_to_file(FILE *file, const char *data, size_t size) {
+    if (fwrite(data, 1, size, file) != size) {
+        cerr << "Could not write search layer to disk" << endl;
+        utils::exit_with(ExitCode::CRITICAL_ERROR);
+    }
+}
+
+static bool seek_record(FILE *file, long long index, size_t record_size) {
+#if OPERATING_SYSTEM == WINDOWS
+    return _fseeki64(file, index * record_size, SEEK_SET) == 0;
+#else
+    return fseeko(file, static_cast<off_t>(index * record_size), SEEK_SET) == 0;
+#endif
+}
+
+static int get_num_vars_of_type(numType type) {
+    return count(g_numeric_var_types.begin(), g_numeric_var_types.end(), type);
+}
+
+/*
+  Half of the memory goes to the successor buffer. The other half goes to
+  the expansion registry, where a state costs about twice its record size
+  (state data, hash set entry, instrumentation variables).
+*/
+static size_t get_max_buffered_records(int memory_limit_in_mb,
+                                       size_t record_size) {
+    size_t memory_bytes = static_cast<size_t>(memory_limit_in_mb) << 20;
+    return max(memory_bytes / 2 / (2 * record_size), size_t(1));
+}
+
+RecordReader::RecordReader(const string &filename, size_t record_size)
+    : file(open_file(filename, "rb")),
+      record(record_size),
+      has_record(false) {
+    advance();
+}
+
+RecordReader::~RecordReader() {
+    fclose(file);
+}
+
+void RecordReader::advance() {
+    has_record = fread(record.data(), record.size(), 1, file) == 1;
+}
+
+
+ExternalSearch::ExternalSearch(const Options &opts)
+    : SearchEngine(opts),
+      evaluator(opts.get<ScalarEvaluator *>("eval", nullptr)),
+      num_bins(g_state_packer->get_num_bins()),
+      num_instrumentation_vars(get_num_vars_of_type(instrumentation)),
+      record_size(num_bins * sizeof(PackedStateBin) +
+                  num_instrumentation_vars * sizeof(ap_float) +
+                  sizeof(NodeData)),
+      max_buffered_records(get_max_buffered_records(
+                               opts.get<int>("memory_limit"), record_size)),
+      file_prefix(opts.get<string>("directory") + "/external_search_" +
+                  to_string(utils::get_process_id()) + "_"),
+      depth(-1),
+      current_index(0),
+      num_duplicates(0),
+      max_layer_size(0),
+      disk_bytes(0) {
+}
+
+ExternalSearch::~ExternalSearch() {
+    remove_files();
+}
+
+void ExternalSearch::remove_files() {
+    current_layer = nullptr;
+    for (const string &filename : layer_filenames)
+        remove(filename.c_str());
+    layer_filenames.clear();
+    for (const string &filename : run_filenames)
+        remove(filename.c_str());
+    run_filenames.clear();
+    if (!closed_filename.empty())
+        remove(closed_filename.c_str());
+    closed_filename.clear();
+}
+
+string ExternalSearch::get_filename(const string &kind, int number) const {
+    return file_prefix + kind + "_" + to_string(number) + ".bin";
+}
+
+void ExternalSearch::reset_registry() {
+    registry = nullptr;
+    registry.reset(new StateRegistry(get_num_vars_of_type(constant)));
+    // Sets up where the registry stores numeric variables.
+    registry->get_initial_state();
+}
+
+static const char *get_key(const char *record) {
+    return record;
+}
+
+static NodeData get_node_data(const char *record, size_t record_size) {
+    NodeData data;
+    memcpy(&data, record + record_size - sizeof(NodeData), sizeof(NodeData));
+    return data;
+}
+
+void ExternalSearch::write_record(
+    const GlobalState &state, long long parent_index, int op_id,
+    ap_float g, ap_float real_g) {
+    if (successor_buffer.size() / record_size >= max_buffered_records)
+        write_run();
+    size_t offset = successor_buffer.size();
+    successor_buffer.resize(offset + record_size);
+    char *dest = &successor_buffer[offset];
+
+    size_t state_bytes = num_bins * sizeof(PackedStateBin);
+    memcpy(dest, state.get_packed_buffer(), state_bytes);
+    dest += state_bytes;
+    if (num_instrumentation_vars > 0) {
+        ArrayView<ap_float> instrumentation_vars = g_cost_information[state];
+        memcpy(dest, instrumentation_vars.data(),
+               num_instrumentation_vars * sizeof(ap_float));
+        dest += num_instrumentation_vars * sizeof(ap_float);
+    }
+    NodeData data = {g, real_g, parent_index, op_id};
+    memcpy(dest, &data, sizeof(NodeData));
+}
+
+void ExternalSearch::write_run() {
+    size_t key_bytes = num_bins * sizeof(PackedStateBin);
+    size_t num_records = successor_buffer.size() / record_size;
+    const char *records = successor_buffer.data();
+    vector<size_t> order(num_records);
+    iota(order.begin(), order.end(), 0);
+    sort(order.begin(), order.end(),
+         [&] (size_t lhs, size_t rhs) {
+             const char *lhs_record = records + lhs * record_size;
+             const char *rhs_record = records + rhs * record_size;
+             int cmp = memcmp(get_key(lhs_record), get_key(rhs_record), key_bytes);
+             if (cmp != 0)
+                 return cmp < 0;
+             return get_node_data(lhs_record, record_size).g <
+                    get_node_data(rhs_record, record_size).g;
+         });
+
+    string filename = get_filename("run", run_filenames.size());
+    FILE *file = open_file(filename, "wb");
+    const char *last_record = nullptr;
+    for (size_t index : order) {
+        const char *record = records + index * record_size;
+        // Sorting by g puts the cheapest copy of each state first.
+        if (last_record &&
+            memcmp(get_key(last_record), get_key(record), key_bytes) == 0) {
+            ++num_duplicates;
+            continue;
+        }
+        write_to_file(file, record, record_size);
+        last_record = record;
+    }
+    fclose(file);
+    run_filenames.push_back(filename);
+    successor_buffer.clear();
+}
+
+size_t ExternalSearch::merge_runs_into_next_layer() {
+    size_t key_bytes = num_bins * sizeof(PackedStateBin);
+    auto compare = [key_bytes] (const char *lhs, const char *rhs) {
+        return memcmp(get_key(lhs), get_key(rhs), key_bytes);
+    };
+
+    vector<unique_ptr<RecordReader>> runs;
+    for (const string &filename : run_filenames)
+        runs.emplace_back(new RecordReader(filename, record_size));
+    unique_ptr<RecordReader> closed;
+    if (!closed_filename.empty())
+        closed.reset(new RecordReader(closed_filename, key_bytes));
+
+    // Min-heap of runs ordered by their current record, cheapest first.
+    auto run_greater = [&] (int lhs, int rhs) {
+        int cmp = compare(runs[lhs]->get(), runs[rhs]->get());
+        if (cmp != 0)
+            return cmp > 0;
+        return get_node_data(runs[lhs]->get(), record_size).g >
+               get_node_data(runs[rhs]->get(), record_size).g;
+    };
+    priority_queue<int, vector<int>, decltype(run_greater)> heap(run_greater);
+    auto advance_run = [&] (int run) {
+        runs[run]->advance();
+        if (runs[run]->has_next())
+            heap.push(run);
+    };
+    for (size_t run = 0; run < runs.size(); ++run)
+        if (runs[run]->has_next())
+            heap.push(run);
+
+    string filename = get_filename("layer", depth + 1);
+    FILE *file = open_file(filename, "wb");
+    string next_closed_filename = get_filename("closed", depth + 1);
+    FILE *closed_file = open_file(next_closed_filename, "wb");
+    vector<char> record(record_size);
+    size_t layer_size = 0;
+    while (!heap.empty()) {
+        int run = heap.top();
+        heap.pop();
+        memcpy(record.data(), runs[run]->get(), record_size);
+        advance_run(run);
+        while (!heap.empty() && compare(runs[heap.top()]->get(), record.data()) == 0) {
+            int duplicate_run = heap.top();
+            heap.pop();
+            ++num_duplicates;
+            advance_run(duplicate_run);
+        }
+
+        /*
+          All files are sorted, so the closed file is scanned only once.
+          Its states are copied to the next closed file, and the new states
+          are inserted in between.
+        */
+        while (closed && closed->has_next() &&
+               compare(closed->get(), record.data()) < 0) {
+            write_to_file(closed_file, closed->get(), key_bytes);
+            closed->advance();
+        }
+        if (closed && closed->has_next() &&
+            compare(closed->get(), record.data()) == 0) {
+            ++num_duplicates;
+            continue;
+        }
+        write_to_file(file, record.data(), record_size);
+        write_to_file(closed_file, get_key(record.data()), key_bytes);
+        ++layer_size;
+    }
+    while (closed && closed->has_next()) {
+        write_to_file(closed_file, closed->get(), key_bytes);
+        closed->advance();
+    }
+    fclose(file);
+    fclose(closed_file);
+    closed = nullptr;
+    if (!closed_filename.empty())
+        remove(closed_filename.c_str());
+    closed_filename = next_closed_filename;
+
+    runs.clear();
+    for (const string &run_filename : run_filenames)
+        remove(run_filename.c_str());
+    run_filenames.clear();
+    layer_filenames.push_back(filename);
+    disk_bytes += layer_size * (record_size + key_bytes);
+    max_layer_size = max(max_layer_size, layer_size);
+    return layer_size;
+}
+
+void ExternalSearch::extract_plan(long long goal_index) {
+    Plan plan;
+    long long index = goal_index;
+    vector<char> record(record_size);
+    for (int layer = depth; layer > 0; --layer) {
+        FILE *file = open_file(layer_filenames[layer], "rb");
+        if (!seek_record(file, index, record_size) ||
+            fread(record.data(), record_size, 1, file) != 1) {
+            cerr << "Could not read search layer " << layer << endl;
+            utils::exit_with(ExitCode::CRITICAL_ERROR);
+        }
+        fclose(file);
+        NodeData data = get_node_data(record.data(), record_size);
+        plan.push_back(&g_operators[data.op_id]);
+        index = data.parent_index;
+    }
+    reverse(plan.begin(), plan.end());
+    set_plan(plan);
+}
+
+bool ExternalSearch::expand(const char *record) {
+    if (registry->size() >= max_buffered_records)
+        reset_registry();
+    vector<ap_float> instrumentation_vars(num_instrumentation_vars);
+    memcpy(instrumentation_vars.data(),
+           record + num_bins * sizeof(PackedStateBin),
+           num_instrumentation_vars * sizeof(ap_float));
+    GlobalState state = registry->register_packed_state(
+        reinterpret_cast<const PackedStateBin *>(record), instrumentation_vars);
+    NodeData node = get_node_data(record, record_size);
+
+    if (test_goal(state)) {
+        cout << "Solution found!" << endl;
+        extract_plan(current_index);
+        return true;
+    }
+
+    if (evaluator) {
+        EvaluationContext eval_context(state, node.g, false, &statistics);
+        statistics.inc_evaluated_states();
+        if (eval_context.is_heuristic_infinite(evaluator)) {
+            statistics.inc_dead_ends();
+            return false;
+        }
+    }
+
+    statistics.inc_expanded();
+    vector<const GlobalOperator *> applicable_ops;
+    g_successor_generator->generate_applicable_ops(state, applicable_ops);
+    statistics.inc_generated_ops(applicable_ops.size());
+    for (const GlobalOperator *op : applicable_ops) {
+        if (node.real_g + op->get_cost() >= bound)
+            continue;
+        GlobalState succ_state = registry->get_successor_state(state, *op);
+        statistics.inc_generated();
+        if (violates_global_constraint(succ_state))
+            continue;
+        write_record(succ_state, current_index, op - &g_operators[0],
+                     node.g + get_adjusted_cost(*op),
+                     node.real_g + op->get_cost());
+    }
+    return false;
+}
+
+void ExternalSearch::initialize() {
+    cout << "Conducting external breadth-first search, (real) bound = "
+         << bound << ", buffering up to " << max_buffered_records
+         << " states of " << record_size << " bytes in memory" << endl;
+    reset_registry();
+    write_record(registry->get_initial_state(), -1, -1, 0, 0);
+    write_run();
+    merge_runs_into_next_layer();
+    depth = 0;
+    current_layer.reset(new RecordReader(layer_filenames.back(), record_size));
+    current_index = 0;
+}
+
+SearchStatus ExternalSearch::step() {
+    if (current_layer->has_next()) {
+        if (expand(current_layer->get())) {
+            remove_files();
+            return SOLVED;
+        }
+        current_layer->advance();
+        ++current_index;
+        return IN_PROGRESS;
+    }
+
+    if (!successor_buffer.empty())
+        write_run();
+    size_t layer_size = merge_runs_into_next_layer();
+    ++depth;
+    cout << "Layer " << depth << ": " << layer_size << " states, "
+         << disk_bytes / 1024 << " KB on disk [t=" << utils::g_timer << "]"
+         << endl;
+    if (layer_size == 0) {
+        cout << "Completely explored state space -- no solution!" << endl;
+        remove_files();
+        return FAILED;
+    }
+    current_layer.reset(new RecordReader(layer_filenames.back(), record_size));
+    current_index = 0;
+    return IN_PROGRESS;
+}
+
+void ExternalSearch::print_statistics() const {
+    statistics.print_detailed_statistics();
+    cout << "Layers: " << depth + 1 << endl;
+    cout << "Largest layer: " << max_layer_size << " state(s)" << endl;
+    cout << "Delayed duplicates: " << num_duplicates << endl;
+    cout << "Closed states on disk: " << disk_bytes / 1024 << " KB" << endl;
+}
+
+static SearchEngine *_parse(OptionParser &parser) {
+    parser.document_synopsis(
+        "External breadth-first search",
+        "Breadth-first search with delayed duplicate detection that stores "
+        "closed states in sorted files on disk instead of the state "
+        "registry. Use it for state spaces that exceed the available "
+        "memory. Plans have the smallest number of operators, so they are "
+        "only optimal for unit-cost tasks.");
+    parser.add_option<ScalarEvaluator *>(
+        "eval",
+        "evaluator used to prune dead ends (optional)",
+        OptionParser::NONE);
+    parser.add_option<int>(
+        "memory_limit",
+        "memory in MB for buffering successors and registering the states "
+        "of the current expansion batch",
+        "1024",
+        Bounds("1", "infinity"));
+    parser.add_option<string>(
+        "directory",
+        "directory for the layer and run files, which are removed when "
+        "the search ends",
+        ".");
+    SearchEngine::add_options_to_parser(parser);
+    Options opts = parser.parse();
+
+    if (parser.dry_run())
+        return nullptr;
+    return new ExternalSearch(opts);
+}
+
+static Plugin<SearchEngine> _plugin("external_bfs", _parse);
+}
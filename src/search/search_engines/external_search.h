@@ -0,0 +1,119 @@
+#ifndef SEARCH_ENGINES_EXTERNAL_SEARCH_H
+#define SEARCH_ENGINES_EXTERNAL_SEARCH_H
+
+#include "../search_engine.h"
+
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <vector>
+
+class GlobalState;
+class ScalarEvaluator;
+class StateRegistry;
+
+namespace options {
+class Options;
+}
+
+namespace external_search {
+/*
+  Sequential reader for a file of fixed-size node records.
+*/
+class RecordReader {
+    FILE *file;
+    std::vector<char> record;
+    bool has_record;
+public:
+    RecordReader(const std::string &filename, std::size_t record_size);
+    ~RecordReader();
+    RecordReader(const RecordReader &) = delete;
+
+    bool has_next() const {
+        return has_record;
+    }
+
+    const char *get() const {
+        return record.data();
+    }
+
+    void advance();
+};
+
+/*
+  Breadth-first search with delayed duplicate detection that keeps its
+  closed states on disk, for state spaces that do not fit into memory.
+
+  The search proceeds in layers of equal depth. Each layer is a file of
+  records (packed state, instrumentation variables, g values, creating
+  operator and index of the parent in the previous layer) sorted by the
+  packed state. Expanding a layer streams its file and collects the
+  successors in a memory buffer; whenever the buffer is full, it is
+  sorted and written to disk as a run. When the layer is exhausted, all
+  runs are merged into the next layer, dropping duplicates within the
+  layer (keeping the cheapest one) and states that occur in any earlier
+  layer. The earlier layers are not scanned one by one for this: the
+  packed states of all layers so far are kept in one sorted closed file,
+  which the merge reads once and rewrites with the states of the new
+  layer. Plans are reconstructed by following the parent indices
+  backwards through the layer files.
+
+  Only the expansion buffer and a temporary StateRegistry, which is
+  cleared regularly, are kept in memory; both are bounded by
+  memory_limit. The search finds a plan with the fewest operators, which
+  is only cost-optimal for unit-cost tasks.
+*/
+class ExternalSearch : public SearchEngine {
+    ScalarEvaluator *evaluator;
+    const int num_bins;
+    const int num_instrumentation_vars;
+    const std::size_t record_size;
+    // Limit for the successor buffer and for the expansion registry.
+    const std::size_t max_buffered_records;
+    const std::string file_prefix;
+
+    // Registry for the states of the current expansion batch.
+    std::unique_ptr<StateRegistry> registry;
+
+    int depth;
+    std::vector<std::string> layer_filenames;
+    // Sorted packed states of all layers, empty before the first merge.
+    std::string closed_filename;
+    std::unique_ptr<RecordReader> current_layer;
+    long long current_index;
+
+    std::vector<char> successor_buffer;
+    std::vector<std::string> run_filenames;
+
+    long long num_duplicates;
+    std::size_t max_layer_size;
+    std::size_t disk_bytes;
+
+    std::string get_filename(const std::string &kind, int number) const;
+    /*
+      The planner exits without destroying the search engine, so the files
+      are removed as soon as the search ends, not only in the destructor.
+    */
+    void remove_files();
+    void reset_registry();
+    void write_record(const GlobalState &state, long long parent_index,
+                      int op_id, ap_float g, ap_float real_g);
+    void write_run();
+    std::size_t merge_runs_into_next_layer();
+    void extract_plan(long long goal_index);
+    // Returns true if the state is a goal state.
+    bool expand(const char *record);
+
+protected:
+    virtual void initialize() override;
+    virtual SearchStatus step() override;
+
+public:
+    explicit ExternalSearch(const options::Options &opts);
+    virtual ~ExternalSearch() override;
+
+    virtual void print_statistics() const override;
+};
+}
+
+#endif
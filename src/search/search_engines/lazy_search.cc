@@ -12,6 +12,7 @@
 
 #include "../utils/rng.h"
 #include "../utils/planvis.h"
+#include "../utils/profiler.h"
 
 #include <algorithm>
 #include <limits>
@@ -135,7 +136,13 @@ SearchStatus LazySearch::fetch_next_state() {
         return FAILED;
     }
 
-    EdgeOpenListEntry next = open_list->remove_min();
+    EdgeOpenListEntry next(StateID::no_state, nullptr);
+    {
+        static utils::ProfileNode &profile_node =
+            utils::get_profile_node("search/open_list/remove_min");
+        utils::ProfileScope profile_scope(profile_node);
+        next = open_list->remove_min();
+    }
 
     current_predecessor_id = next.first;
     current_operator = next.second;
@@ -113,7 +113,7 @@ void OrbitEagerSearch::initialize() {
               initial_state.get_id(),
           initial_state.dump_plan_vis_log(),
           h_val,
-          h_time,
+          h_time(),
           search_space.get_node(initial_state).get_g(),
           initial_state.get_id(),
           test_goal(initial_state),
@@ -239,7 +239,7 @@ SearchStatus OrbitEagerSearch::step() {
                   succ_state.get_id(),
             succ_state.dump_plan_vis_log(s),
             succ_h,
-              h_time,
+              h_time(),
             succ_g,
             s.get_id(),
             test_goal(succ_state),
@@ -0,0 +1,337 @@
+#include "parallel_greedy_search.h"
+
+#include "search_common.h"
+
+#include "../evaluation_context.h"
+#include "../globals.h"
+#include "../heuristic.h"
+#include "../option_parser.h"
+#include "../plugin.h"
+#include "../successor_generator.h"
+
+#include "../open_lists/open_list_factory.h"
+#include "../utils/countdown_timer.h"
+#include "../utils/memory.h"
+#include "../utils/parallel.h"
+#include "../utils/rng.h"
+#include "../utils/rng_options.h"
+#include "../utils/system.h"
+
+#include <algorithm>
+#include <cassert>
+#include <iostream>
+#include <limits>
+#include <set>
+#include <thread>
+
+using namespace std;
+
+namespace parallel_greedy_search {
+Worker::Worker(ScalarEvaluator *evaluator)
+    : evaluator(evaluator),
+      open_list(search_common::create_standard_scalar_open_list_factory(
+                    evaluator, false)->create_state_open_list()),
+      next_receiver(0) {
+}
+
+Worker::~Worker() {
+}
+
+ParallelGreedySearch::ParallelGreedySearch(const Options &opts)
+    : SearchEngine(opts),
+      evaluator_configs(opts.get_list<ParseTree>("evals")),
+      num_threads(opts.get<int>("threads")),
+      random_tie_breaking(opts.get<bool>("random_tie_breaking")),
+      random_seed(opts.get<int>("random_seed")),
+      num_open_states(0),
+      search_finished(false),
+      timed_out(false),
+      solving_worker(-1),
+      goal_id(StateID::no_state) {
+}
+
+ParallelGreedySearch::~ParallelGreedySearch() {
+}
+
+void ParallelGreedySearch::initialize() {
+    cout << "Conducting parallel greedy best first search with "
+         << num_threads << " threads, (real) bound = " << bound << endl;
+
+    set<Heuristic *> all_heuristics;
+    for (int i = 0; i < num_threads; ++i) {
+        // Parse the configuration for each thread to get separate objects.
+        OptionParser parser(evaluator_configs[i % evaluator_configs.size()], false);
+        ScalarEvaluator *evaluator = parser.start_parsing<ScalarEvaluator *>();
+        set<Heuristic *> heuristics;
+        evaluator->get_involved_heuristics(heuristics);
+        for (Heuristic *heuristic : heuristics) {
+            if (!all_heuristics.insert(heuristic).second) {
+                cerr << "The threads of a parallel search cannot share a "
+                     << "heuristic. Define the heuristics inside of evals "
+                     << "instead of predefining them." << endl;
+                utils::exit_with(utils::ExitCode::INPUT_ERROR);
+            }
+        }
+        workers.push_back(utils::make_unique_ptr<Worker>(evaluator));
+        workers.back()->next_receiver = i;
+        // The first thread keeps the deterministic tie-breaking.
+        if (random_tie_breaking && i > 0) {
+            int seed = random_seed;
+            if (seed == -1)
+                seed = (*g_rng())(numeric_limits<int>::max());
+            else
+                seed += i;
+            workers.back()->rng =
+                utils::make_unique_ptr<utils::RandomNumberGenerator>(seed);
+        }
+    }
+
+    /*
+      Evaluate the initial state with all evaluators before the threads are
+      started, so that the heuristics do their lazy initialization (and
+      subscribe their per-state information to the registry) one after the
+      other. Only the first thread starts with the initial state.
+    */
+    const GlobalState &initial_state = g_initial_state();
+    SearchNode node = search_space.get_node(initial_state);
+    node.open_initial();
+    for (size_t i = 0; i < workers.size(); ++i) {
+        Worker &worker = *workers[i];
+        EvaluationContext eval_context(initial_state, 0, true, &worker.statistics);
+        worker.statistics.inc_evaluated_states();
+        if (worker.open_list->is_dead_end(eval_context)) {
+            cout << "Initial state is a dead end." << endl;
+        } else if (i == 0) {
+            worker.open_list->insert(eval_context, initial_state.get_id());
+            ++num_open_states;
+        }
+        print_initial_h_values(eval_context);
+    }
+}
+
+mutex &ParallelGreedySearch::get_node_mutex(StateID id) {
+    return node_mutexes[hash<StateID>()(id) % NUM_NODE_MUTEXES];
+}
+
+void ParallelGreedySearch::report_solution(int worker_id, StateID id) {
+    lock_guard<mutex> lock(solution_mutex);
+    if (solving_worker == -1) {
+        solving_worker = worker_id;
+        goal_id = id;
+    }
+    search_finished = true;
+}
+
+void ParallelGreedySearch::insert(Worker &worker, StateID id, ap_float g) {
+    GlobalState state = g_state_registry->lookup_state(id);
+    EvaluationContext eval_context(state, g, false, &worker.statistics);
+    worker.statistics.inc_evaluated_states();
+    if (worker.open_list->is_dead_end(eval_context)) {
+        worker.statistics.inc_dead_ends();
+        --num_open_states;
+    } else {
+        worker.open_list->insert(eval_context, id);
+    }
+}
+
+void ParallelGreedySearch::process_inbox(Worker &worker) {
+    vector<pair<StateID, ap_float>> new_states;
+    {
+        lock_guard<mutex> lock(worker.inbox_mutex);
+        new_states.swap(worker.inbox);
+    }
+    for (const auto &new_state : new_states)
+        insert(worker, new_state.first, new_state.second);
+}
+
+void ParallelGreedySearch::expand(int worker_id, StateID id) {
+    Worker &worker = *workers[worker_id];
+    GlobalState state = g_state_registry->lookup_state(id);
+    if (violates_global_constraint(state))
+        return;
+    worker.statistics.inc_expanded();
+    if (test_goal(state)) {
+        report_solution(worker_id, id);
+        return;
+    }
+    vector<const GlobalOperator *> applicable_ops;
+    g_successor_generator->generate_applicable_ops(state, applicable_ops);
+    if (worker.rng)
+        worker.rng->shuffle(applicable_ops);
+
+    /*
+      Only this thread writes the node of the expanded state from now on,
+      so we can read it without locking. The registry is the closed list of
+      all threads: the first thread that finds a successor as a new node
+      opens it.
+    */
+    SearchNode node = search_space.get_node(state);
+    {
+        lock_guard<mutex> lock(get_node_mutex(id));
+        node.close();
+    }
+    vector<pair<StateID, ap_float>> new_states;
+    for (const GlobalOperator *op : applicable_ops) {
+        if ((node.get_real_g() + op->get_cost()) >= bound)
+            continue;
+        GlobalState succ_state = g_state_registry->get_successor_state(state, *op);
+        worker.statistics.inc_generated();
+        SearchNode succ_node = search_space.get_node(succ_state);
+        lock_guard<mutex> lock(get_node_mutex(succ_state.get_id()));
+        // Greedy search does not reopen states or update their parents.
+        if (!succ_node.is_new())
+            continue;
+        succ_node.open(node, op);
+        new_states.emplace_back(succ_state.get_id(), succ_node.get_g());
+    }
+
+    // Assign the new states to the threads in turn.
+    num_open_states += new_states.size();
+    vector<pair<StateID, ap_float>> own_states;
+    for (const auto &new_state : new_states) {
+        int receiver = worker.next_receiver;
+        worker.next_receiver = (worker.next_receiver + 1) % workers.size();
+        if (receiver == worker_id) {
+            own_states.push_back(new_state);
+        } else {
+            Worker &other = *workers[receiver];
+            lock_guard<mutex> lock(other.inbox_mutex);
+            other.inbox.push_back(new_state);
+        }
+    }
+    for (const auto &new_state : own_states)
+        insert(worker, new_state.first, new_state.second);
+}
+
+void ParallelGreedySearch::run_worker(
+    int worker_id, const utils::CountdownTimer &timer) {
+    Worker &worker = *workers[worker_id];
+    try {
+        while (!search_finished) {
+            if (timer.is_expired()) {
+                timed_out = true;
+                search_finished = true;
+                return;
+            }
+            process_inbox(worker);
+            if (worker.open_list->empty()) {
+                // Wait for states from other threads unless the search is over.
+                if (num_open_states == 0)
+                    return;
+                this_thread::yield();
+                continue;
+            }
+            StateID id = worker.open_list->remove_min();
+            expand(worker_id, id);
+            // The successors are counted, so this cannot end the search early.
+            --num_open_states;
+        }
+    } catch (...) {
+        /*
+          Stop the other threads, which would otherwise wait for the states
+          of this one. parallel_for rethrows the exception (e.g. of
+          exit_with) in the thread that runs the search.
+        */
+        search_finished = true;
+        throw;
+    }
+}
+
+SearchStatus ParallelGreedySearch::step() {
+    utils::CountdownTimer timer(max_time);
+    utils::parallel_for(
+        workers.size(), workers.size(),
+        [&](size_t worker_id) {
+            run_worker(worker_id, timer);
+        });
+
+    for (const auto &worker : workers) {
+        const SearchStatistics &worker_stats = worker->statistics;
+        statistics.inc_expanded(worker_stats.get_expanded());
+        statistics.inc_evaluated_states(worker_stats.get_evaluated_states());
+        statistics.inc_evaluations(worker_stats.get_evaluations());
+        statistics.inc_generated(worker_stats.get_generated());
+    }
+
+    if (solving_worker != -1) {
+        cout << "Solution found by thread " << solving_worker << "!" << endl;
+        GlobalState goal_state = g_state_registry->lookup_state(goal_id);
+        Plan plan;
+        search_space.trace_path(goal_state, plan);
+        set_plan(plan);
+        return SOLVED;
+    }
+    if (timed_out) {
+        cout << "Time limit reached. Abort search." << endl;
+        return TIMEOUT;
+    }
+    cout << "Completely explored state space -- no solution!" << endl;
+    return FAILED;
+}
+
+void ParallelGreedySearch::print_statistics() const {
+    for (size_t i = 0; i < workers.size(); ++i) {
+        cout << "Thread " << i << ": expanded "
+             << workers[i]->statistics.get_expanded() << " state(s), evaluated "
+             << workers[i]->statistics.get_evaluated_states() << " state(s)"
+             << endl;
+    }
+    statistics.print_detailed_statistics();
+}
+
+static SearchEngine *_parse(OptionParser &parser) {
+    parser.document_synopsis(
+        "Parallel greedy search (eager)",
+        "Greedy best-first search with several threads. Each thread has its "
+        "own open list, ordered by its own evaluator, and expands the states "
+        "of this open list. All threads share the state registry, so every "
+        "state is evaluated and expanded only once: the new successors of an "
+        "expanded state are assigned to the threads in turn. The search "
+        "stops as soon as one thread expands a goal state.");
+    parser.document_note(
+        "Evaluators",
+        "Thread i uses the evaluator evals[i mod len(evals)]. Each thread "
+        "builds its own copy of its evaluator, so evaluators must be "
+        "defined inside evals and not predefined with --heuristic. "
+        "Preferred operators and path-dependent heuristics (e.g. lmcount) "
+        "are not supported.");
+    parser.document_note(
+        "Determinism",
+        "The plan and the statistics depend on the scheduling of the "
+        "threads, so runs are not reproducible if threads > 1. With "
+        "random_tie_breaking, all threads but the first shuffle the "
+        "successors of the states they expand, which changes the order of "
+        "states with the same value in the open lists.");
+    parser.add_list_option<ParseTree>("evals", "scalar evaluators");
+    parser.add_option<int>(
+        "threads",
+        "number of search threads",
+        "2",
+        Bounds("1", "infinity"));
+    parser.add_option<bool>(
+        "random_tie_breaking",
+        "break ties randomly in all threads but the first",
+        "true");
+    utils::add_rng_options(parser);
+    SearchEngine::add_options_to_parser(parser);
+    Options opts = parser.parse();
+
+    opts.verify_list_non_empty<ParseTree>("evals");
+
+    if (parser.help_mode())
+        return nullptr;
+
+    if (parser.dry_run()) {
+        // Check that the evaluators can be parsed.
+        for (const ParseTree &config : opts.get_list<ParseTree>("evals")) {
+            OptionParser test_parser(config, true);
+            test_parser.start_parsing<ScalarEvaluator *>();
+        }
+        return nullptr;
+    } else {
+        return new ParallelGreedySearch(opts);
+    }
+}
+
+static Plugin<SearchEngine> _plugin("parallel_greedy", _parse);
+}
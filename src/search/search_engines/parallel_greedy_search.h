@@ -0,0 +1,102 @@
+#ifndef SEARCH_ENGINES_PARALLEL_GREEDY_SEARCH_H
+#define SEARCH_ENGINES_PARALLEL_GREEDY_SEARCH_H
+
+#include "../option_parser_util.h"
+#include "../search_engine.h"
+
+#include "../open_lists/open_list.h"
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+class ScalarEvaluator;
+
+namespace options {
+class Options;
+}
+
+namespace utils {
+class CountdownTimer;
+class RandomNumberGenerator;
+}
+
+namespace parallel_greedy_search {
+/*
+  Search data of one thread. Only the inbox is accessed by other threads:
+  every thread has its own evaluator objects (and thus its own heuristic
+  caches), open list and statistics.
+*/
+struct Worker {
+    ScalarEvaluator *evaluator;
+    std::unique_ptr<StateOpenList> open_list;
+    SearchStatistics statistics;
+    // Only used with random tie-breaking.
+    std::unique_ptr<utils::RandomNumberGenerator> rng;
+
+    // New states (with their g-values) that other threads assigned to
+    // this thread and that still have to be evaluated.
+    std::mutex inbox_mutex;
+    std::vector<std::pair<StateID, ap_float>> inbox;
+
+    // Thread that gets the next new state generated by this thread.
+    int next_receiver;
+
+    explicit Worker(ScalarEvaluator *evaluator);
+    ~Worker();
+};
+
+/*
+  Greedy best-first search with several threads. Each thread expands the
+  states of its own open list, which is ordered by its own evaluator. The
+  threads share g_state_registry and the search space, so every state is
+  registered, evaluated and expanded only once. New states are assigned
+  to the threads in turn. The search stops as soon as one thread expands
+  a goal state.
+
+  The registry and the per-state information of the search space can be
+  used by all threads at the same time. A search node is only opened by
+  the thread that finds it as a new node and only closed by the thread
+  that expands it, so the threads only have to synchronize the status of
+  the nodes.
+*/
+class ParallelGreedySearch : public SearchEngine {
+    const std::vector<ParseTree> evaluator_configs;
+    const int num_threads;
+    const bool random_tie_breaking;
+    const int random_seed;
+
+    std::vector<std::unique_ptr<Worker>> workers;
+
+    // Protect the status of the search nodes, by state ID.
+    static const int NUM_NODE_MUTEXES = 64;
+    std::mutex node_mutexes[NUM_NODE_MUTEXES];
+
+    // Number of states in all open lists and inboxes.
+    std::atomic<int> num_open_states;
+    std::atomic<bool> search_finished;
+    std::atomic<bool> timed_out;
+    std::mutex solution_mutex;
+    int solving_worker;
+    StateID goal_id;
+
+    std::mutex &get_node_mutex(StateID id);
+    void report_solution(int worker_id, StateID id);
+    void insert(Worker &worker, StateID id, ap_float g);
+    void process_inbox(Worker &worker);
+    void expand(int worker_id, StateID id);
+    void run_worker(int worker_id, const utils::CountdownTimer &timer);
+
+    virtual void initialize() override;
+    virtual SearchStatus step() override;
+public:
+    explicit ParallelGreedySearch(const options::Options &opts);
+    virtual ~ParallelGreedySearch() override;
+
+    virtual void print_statistics() const override;
+};
+}
+
+#endif
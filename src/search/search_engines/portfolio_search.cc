@@ -0,0 +1,204 @@
+#include "portfolio_search.h"
+
+#include "../option_parser.h"
+#include "../plugin.h"
+
+#include "../utils/countdown_timer.h"
+#include "../utils/memory.h"
+
+#include <iostream>
+#include <limits>
+
+using namespace std;
+
+namespace portfolio_search {
+PortfolioSearch::PortfolioSearch(const Options &opts)
+    : SearchEngine(opts),
+      engine_configs(opts.get_list<ParseTree>("engine_configs")),
+      relative_times(opts.get_list<double>("relative_times")),
+      optimal(opts.get<bool>("optimal")),
+      pass_bound(opts.get<bool>("pass_bound")),
+      position(0),
+      best_bound(bound) {
+}
+
+PortfolioSearch::~PortfolioSearch() {
+}
+
+void PortfolioSearch::initialize() {
+    timer = utils::make_unique_ptr<utils::CountdownTimer>(max_time);
+    current_round.clear();
+    for (size_t i = 0; i < engine_configs.size(); ++i)
+        current_round.push_back(i);
+}
+
+double PortfolioSearch::compute_run_time() const {
+    /*
+      As in the portfolios of the driver, each configuration gets the share
+      of the remaining time given by its relative time divided by the
+      relative times of all configurations that still have to run in this
+      round. The last configuration of a round uses all remaining time.
+    */
+    double remaining_time = timer->get_remaining_time();
+    if (remaining_time == numeric_limits<double>::infinity())
+        return remaining_time;
+    double remaining_relative_time = 0;
+    for (size_t i = position; i < current_round.size(); ++i)
+        remaining_relative_time += relative_times[current_round[i]];
+    double relative_time = relative_times[current_round[position]];
+    return remaining_time * relative_time / remaining_relative_time;
+}
+
+SearchEngine *PortfolioSearch::create_engine(int config_id) const {
+    OptionParser parser(engine_configs[config_id], false);
+    SearchEngine *engine = parser.start_parsing<SearchEngine *>();
+
+    cout << "Starting search: ";
+    kptree::print_tree_bracketed(engine_configs[config_id], cout);
+    cout << endl;
+
+    return engine;
+}
+
+SearchStatus PortfolioSearch::step() {
+    if (position == current_round.size()) {
+        // Only the configurations that found a cheaper plan run again.
+        if (optimal || next_round.empty())
+            return found_solution() ? SOLVED : FAILED;
+        current_round.swap(next_round);
+        next_round.clear();
+        position = 0;
+        cout << "Starting next portfolio round with "
+             << current_round.size() << " configurations" << endl;
+    }
+
+    double run_time = compute_run_time();
+    if (run_time <= 0)
+        return found_solution() ? SOLVED : TIMEOUT;
+    int config_id = current_round[position++];
+    cout << "Portfolio configuration " << config_id << ": run time "
+         << run_time << "s, remaining time " << timer->get_remaining_time()
+         << "s" << endl;
+
+    unique_ptr<SearchEngine> engine(create_engine(config_id));
+    engine->set_max_time(min(engine->get_max_time(), run_time));
+    if (pass_bound)
+        engine->set_bound(min(engine->get_bound(), best_bound));
+
+    engine->search();
+
+    if (engine->found_solution()) {
+        const Plan &found_plan = engine->get_plan();
+        ap_float plan_cost = calculate_plan_cost(found_plan);
+        /*
+          Only configurations that improved the best plan run again. A
+          configuration that found no cheaper plan would find the same plan
+          in the next round.
+        */
+        if (plan_cost < best_bound) {
+            save_plan(found_plan, true);
+            best_bound = plan_cost;
+            set_plan(found_plan);
+            next_round.push_back(config_id);
+        }
+    }
+    engine->print_statistics();
+
+    const SearchStatistics &engine_stats = engine->get_statistics();
+    statistics.inc_expanded(engine_stats.get_expanded());
+    statistics.inc_evaluated_states(engine_stats.get_evaluated_states());
+    statistics.inc_evaluations(engine_stats.get_evaluations());
+    statistics.inc_generated(engine_stats.get_generated());
+    statistics.inc_generated_ops(engine_stats.get_generated_ops());
+    statistics.inc_reopened(engine_stats.get_reopened());
+
+    if (found_solution()) {
+        cout << "Best solution cost so far: " << best_bound << endl;
+        if (optimal)
+            return SOLVED;
+    }
+    return IN_PROGRESS;
+}
+
+void PortfolioSearch::print_statistics() const {
+    cout << "Cumulative statistics:" << endl;
+    statistics.print_detailed_statistics();
+}
+
+void PortfolioSearch::save_plan_if_necessary() const {
+    // We don't need to save here, as we automatically save after
+    // each successful configuration.
+}
+
+static SearchEngine *_parse(OptionParser &parser) {
+    parser.document_synopsis(
+        "Portfolio search",
+        "Runs the given search engines one after the other in one process. "
+        "Each engine gets the share of the remaining time (max_time) that "
+        "corresponds to its relative time among the engines that still have "
+        "to run, as in the portfolios of the driver. For satisficing "
+        "portfolios, the engines that found a cheaper plan than all "
+        "previous engines are run again with the cost of the best plan as "
+        "bound until no engine finds a cheaper plan or the time is used "
+        "up.");
+    parser.document_note(
+        "Sharing precomputations",
+        "All engines share the task and the state registry. To share a "
+        "heuristic and its preprocessing (e.g. a PDB collection or a "
+        "landmark graph) between engines, predefine it:\n```\n"
+        "--heuristic \"h=numeric_cpdbs()\" --search "
+        "\"portfolio([astar(h), lazy_greedy(h)], relative_times=[2, 1], "
+        "max_time=300)\"\n```\n"
+        "Heuristics defined inside an engine configuration are built "
+        "again for each run of the engine.");
+    parser.add_list_option<ParseTree>("engine_configs",
+                                      "list of search engines");
+    parser.add_list_option<double>(
+        "relative_times",
+        "relative time of each search engine; all engines get the same "
+        "time if this is empty",
+        "[]");
+    parser.add_option<bool>(
+        "optimal",
+        "stop after the first engine that finds a plan",
+        "false");
+    parser.add_option<bool>(
+        "pass_bound",
+        "use the cost of the best plan found so far as bound. The bound is "
+        "the real cost of the plan, regardless of the cost_type parameter.",
+        "true");
+    SearchEngine::add_options_to_parser(parser);
+    Options opts = parser.parse();
+
+    opts.verify_list_non_empty<ParseTree>("engine_configs");
+
+    if (parser.help_mode())
+        return nullptr;
+
+    int num_engines = opts.get_list<ParseTree>("engine_configs").size();
+    vector<double> relative_times = opts.get_list<double>("relative_times");
+    if (relative_times.empty()) {
+        relative_times.assign(num_engines, 1);
+    } else if (static_cast<int>(relative_times.size()) != num_engines) {
+        parser.error("need one relative time per search engine");
+    }
+    for (double relative_time : relative_times) {
+        if (relative_time <= 0)
+            parser.error("relative times must be positive");
+    }
+    opts.set<vector<double>>("relative_times", relative_times);
+
+    if (parser.dry_run()) {
+        //check if the supplied search engines can be parsed
+        for (const ParseTree &config : opts.get_list<ParseTree>("engine_configs")) {
+            OptionParser test_parser(config, true);
+            test_parser.start_parsing<SearchEngine *>();
+        }
+        return nullptr;
+    } else {
+        return new PortfolioSearch(opts);
+    }
+}
+
+static Plugin<SearchEngine> _plugin("portfolio", _parse);
+}
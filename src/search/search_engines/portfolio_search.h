@@ -0,0 +1,55 @@
+#ifndef SEARCH_ENGINES_PORTFOLIO_SEARCH_H
+#define SEARCH_ENGINES_PORTFOLIO_SEARCH_H
+
+#include "../option_parser_util.h"
+#include "../search_engine.h"
+
+#include <memory>
+#include <vector>
+
+namespace options {
+class Options;
+}
+
+namespace utils {
+class CountdownTimer;
+}
+
+namespace portfolio_search {
+/*
+  Runs a sequence of search engines in this process, one after the other,
+  where each engine gets a share of the remaining time that is proportional
+  to its relative time. This is the in-process counterpart of the portfolios
+  of the driver: the task, the successor generator, the state registry and
+  all predefined heuristics (and whatever they precompute) are shared by all
+  configurations instead of being rebuilt for each of them.
+*/
+class PortfolioSearch : public SearchEngine {
+    const std::vector<ParseTree> engine_configs;
+    const std::vector<double> relative_times;
+    const bool optimal;
+    const bool pass_bound;
+
+    // Indices of the configurations of the current round and the position
+    // of the next configuration to run among them.
+    std::vector<int> current_round;
+    std::vector<int> next_round;
+    std::size_t position;
+
+    ap_float best_bound;
+    std::unique_ptr<utils::CountdownTimer> timer;
+
+    double compute_run_time() const;
+    SearchEngine *create_engine(int config_id) const;
+
+    virtual void initialize() override;
+    virtual SearchStatus step() override;
+public:
+    explicit PortfolioSearch(const options::Options &opts);
+    virtual ~PortfolioSearch() override;
+    virtual void save_plan_if_necessary() const override;
+    virtual void print_statistics() const override;
+};
+}
+
+#endif
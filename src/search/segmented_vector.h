@@ -1,9 +1,15 @@
 #ifndef SEGMENTED_VECTOR_H
 #define SEGMENTED_VECTOR_H
 
+#include "utils/segment_allocator.h"
+
 #include <algorithm>
+#include <atomic>
 #include <cassert>
 #include <iostream>
+#include <memory>
+#include <mutex>
+#include <new>
 #include <vector>
 
 
@@ -32,10 +38,20 @@
   The class can also be used as a simple "memory pool" to reduce allocation
   costs (time and memory) when allocating many objects of the same type.
 
+  The memory for the segments is obtained from a utils::SegmentAllocator,
+  which can place them in huge-page backed arenas (see
+  utils/segment_allocator.h). The Allocator template parameter is only
+  used to construct and destroy the stored objects.
+
   SegmentedArrayVector is a similar class that can be used for compactly
   storing many fixed-size arrays. It's essentially a variant of SegmentedVector
   where the size of the stored data is only known at runtime, not at compile
   time.
+
+  ConcurrentSegmentedArrayVector also stores fixed-size arrays, but it can be
+  used by several threads at the same time. It has no push_back: arrays are
+  addressed by index, and the segment that contains an index is allocated
+  on the first access to one of its arrays (see below).
 */
 
 // TODO: Get rid of the code duplication here. How to do it without
@@ -55,6 +71,7 @@ class SegmentedVector {
         (SEGMENT_BYTES / sizeof(Entry)) : 1;
 
     EntryAllocator entry_allocator;
+    utils::SegmentAllocator segment_allocator;
 
     std::vector<Entry *> segments;
     size_t the_size;
@@ -68,7 +85,8 @@ class SegmentedVector {
     }
 
     void add_segment() {
-        Entry *new_segment = entry_allocator.allocate(SEGMENT_ELEMENTS);
+        Entry *new_segment = static_cast<Entry *>(
+            segment_allocator.allocate(SEGMENT_ELEMENTS * sizeof(Entry)));
         segments.push_back(new_segment);
     }
 
@@ -90,7 +108,8 @@ public:
             entry_allocator.destroy(&operator[](i));
         }
         for (size_t segment = 0; segment < segments.size(); ++segment) {
-            entry_allocator.deallocate(segments[segment], SEGMENT_ELEMENTS);
+            segment_allocator.deallocate(segments[segment],
+                                         SEGMENT_ELEMENTS * sizeof(Entry));
         }
     }
 
@@ -157,6 +176,7 @@ class SegmentedArrayVector {
     const size_t elements_per_segment;
 
     ElementAllocator element_allocator;
+    utils::SegmentAllocator segment_allocator;
 
     std::vector<Element *> segments;
     size_t the_size;
@@ -170,7 +190,8 @@ class SegmentedArrayVector {
     }
 
     void add_segment() {
-        Element *new_segment = element_allocator.allocate(elements_per_segment);
+        Element *new_segment = static_cast<Element *>(
+            segment_allocator.allocate(elements_per_segment * sizeof(Element)));
         segments.push_back(new_segment);
     }
 
@@ -206,7 +227,8 @@ public:
             }
         }
         for (size_t i = 0; i < segments.size(); ++i) {
-            element_allocator.deallocate(segments[i], elements_per_segment);
+            segment_allocator.deallocate(segments[i],
+                                         elements_per_segment * sizeof(Element));
         }
     }
 
@@ -265,4 +287,179 @@ public:
     }
 };
 
+
+/*
+  Stores fixed-size arrays like SegmentedArrayVector, but arrays can be
+  looked up and created by several threads at the same time.
+
+  The index of an array determines its position, so there is no size and no
+  push_back. All arrays of a segment are created (as copies of the default
+  array) when the segment is allocated, which happens on the first access
+  with get() to an index of the segment. find() never allocates and returns
+  nullptr for arrays of segments that do not exist yet. Arrays never move,
+  so returned pointers stay valid until the vector is destroyed.
+
+  The segment pointers are stored in a two-level table of atomic pointers:
+  a directory with blocks of segment pointers that are allocated on
+  demand. The directory grows with the blocks. Growing it replaces it with
+  a copy of twice the size, but the old directories are only deleted with
+  the vector, because other threads might still read them. Lookups only
+  load these pointers and never lock; growing the directory and allocating
+  a block or segment locks a mutex. The vector itself does not synchronize
+  accesses to the elements of an array.
+*/
+template<class Element>
+class ConcurrentSegmentedArrayVector {
+    static const size_t SEGMENT_BYTES = 8192;
+    static const size_t SEGMENTS_PER_BLOCK = 1024;
+    // Arrays are addressed by non-negative int values (e.g. StateIDs).
+    static const size_t MAX_ARRAYS = size_t(1) << 31;
+
+    typedef std::atomic<Element *> SegmentPointer;
+
+    struct Directory {
+        const size_t num_blocks;
+        std::unique_ptr<std::atomic<SegmentPointer *>[]> blocks;
+
+        explicit Directory(size_t num_blocks_)
+            : num_blocks(num_blocks_),
+              blocks(new std::atomic<SegmentPointer *>[num_blocks]) {
+            for (size_t i = 0; i < num_blocks; ++i)
+                blocks[i].store(nullptr, std::memory_order_relaxed);
+        }
+    };
+
+    const size_t elements_per_array;
+    const size_t arrays_per_segment;
+    const size_t elements_per_segment;
+    // Not owned.
+    const Element *default_array;
+
+    const size_t max_blocks;
+    std::atomic<Directory *> directory;
+    // All directories so far, the last one is the current directory.
+    std::vector<std::unique_ptr<Directory>> directories;
+
+    std::mutex allocation_mutex;
+    utils::SegmentAllocator segment_allocator;
+
+    size_t get_segment(size_t index) const {
+        return index / arrays_per_segment;
+    }
+
+    size_t get_offset(size_t index) const {
+        return (index % arrays_per_segment) * elements_per_array;
+    }
+
+    Element *get_segment_start(size_t segment) const {
+        const Directory *dir = directory.load(std::memory_order_acquire);
+        size_t block_index = segment / SEGMENTS_PER_BLOCK;
+        if (block_index >= dir->num_blocks)
+            return nullptr;
+        SegmentPointer *block =
+            dir->blocks[block_index].load(std::memory_order_acquire);
+        if (!block)
+            return nullptr;
+        return block[segment % SEGMENTS_PER_BLOCK].load(std::memory_order_acquire);
+    }
+
+    Element *allocate_segment(size_t segment) {
+        std::lock_guard<std::mutex> lock(allocation_mutex);
+        Directory *dir = directory.load(std::memory_order_relaxed);
+        size_t block_index = segment / SEGMENTS_PER_BLOCK;
+        if (block_index >= dir->num_blocks) {
+            size_t num_blocks = std::min(
+                std::max(2 * dir->num_blocks, block_index + 1), max_blocks);
+            Directory *new_dir = new Directory(num_blocks);
+            for (size_t i = 0; i < dir->num_blocks; ++i)
+                new_dir->blocks[i].store(
+                    dir->blocks[i].load(std::memory_order_relaxed),
+                    std::memory_order_relaxed);
+            directories.emplace_back(new_dir);
+            directory.store(new_dir, std::memory_order_release);
+            dir = new_dir;
+        }
+        std::atomic<SegmentPointer *> &block_pointer = dir->blocks[block_index];
+        SegmentPointer *block = block_pointer.load(std::memory_order_relaxed);
+        if (!block) {
+            block = new SegmentPointer[SEGMENTS_PER_BLOCK];
+            for (size_t i = 0; i < SEGMENTS_PER_BLOCK; ++i)
+                block[i].store(nullptr, std::memory_order_relaxed);
+            block_pointer.store(block, std::memory_order_release);
+        }
+        SegmentPointer &segment_pointer = block[segment % SEGMENTS_PER_BLOCK];
+        Element *start = segment_pointer.load(std::memory_order_relaxed);
+        // Another thread might have allocated the segment in the meantime.
+        if (!start) {
+            start = static_cast<Element *>(
+                segment_allocator.allocate(elements_per_segment * sizeof(Element)));
+            Element *dest = start;
+            for (size_t i = 0; i < arrays_per_segment; ++i) {
+                for (size_t j = 0; j < elements_per_array; ++j)
+                    new (dest++) Element(default_array[j]);
+            }
+            segment_pointer.store(start, std::memory_order_release);
+        }
+        return start;
+    }
+
+    // No implementation to forbid copies and assignment
+    ConcurrentSegmentedArrayVector(const ConcurrentSegmentedArrayVector<Element> &);
+    ConcurrentSegmentedArrayVector &operator=(const ConcurrentSegmentedArrayVector<Element> &);
+public:
+    // The default array must outlive the vector.
+    ConcurrentSegmentedArrayVector(size_t elements_per_array_,
+                                   const Element *default_array_)
+        : elements_per_array(elements_per_array_),
+          arrays_per_segment(
+              std::max(SEGMENT_BYTES / (elements_per_array * sizeof(Element)), size_t(1))),
+          elements_per_segment(elements_per_array * arrays_per_segment),
+          default_array(default_array_),
+          max_blocks((MAX_ARRAYS / arrays_per_segment + SEGMENTS_PER_BLOCK) /
+                     SEGMENTS_PER_BLOCK) {
+        assert(elements_per_array > 0);
+        directories.emplace_back(new Directory(1));
+        directory.store(directories.back().get(), std::memory_order_relaxed);
+    }
+
+    ~ConcurrentSegmentedArrayVector() {
+        // The current directory contains the blocks of all directories.
+        const Directory *dir = directory.load(std::memory_order_relaxed);
+        for (size_t i = 0; i < dir->num_blocks; ++i) {
+            SegmentPointer *block = dir->blocks[i].load(std::memory_order_relaxed);
+            if (!block)
+                continue;
+            for (size_t j = 0; j < SEGMENTS_PER_BLOCK; ++j) {
+                Element *start = block[j].load(std::memory_order_relaxed);
+                if (!start)
+                    continue;
+                for (size_t k = 0; k < elements_per_segment; ++k)
+                    start[k].~Element();
+                segment_allocator.deallocate(
+                    start, elements_per_segment * sizeof(Element));
+            }
+            delete[] block;
+        }
+    }
+
+    // Returns the array at the given index and allocates its segment if needed.
+    Element *get(size_t index) {
+        assert(index < MAX_ARRAYS);
+        size_t segment = get_segment(index);
+        Element *start = get_segment_start(segment);
+        if (!start)
+            start = allocate_segment(segment);
+        return start + get_offset(index);
+    }
+
+    // Returns the array at the given index or nullptr if it does not exist yet.
+    Element *find(size_t index) const {
+        assert(index < MAX_ARRAYS);
+        Element *start = get_segment_start(get_segment(index));
+        if (!start)
+            return nullptr;
+        return start + get_offset(index);
+    }
+};
+
 #endif
@@ -3,6 +3,11 @@
 
 #include <iostream>
 
+namespace utils {
+class PlanVisLogger;
+class SearchTraceWriter;
+}
+
 // For documentation on classes relevant to storing and working with registered
 // states see the file state_registry.h.
 
@@ -11,6 +16,10 @@ class StateID {
     friend std::ostream &operator<<(std::ostream &os, StateID id);
     template<typename>
     friend class PerStateInformation;
+    template<typename>
+    friend class PerStateStorage;
+    friend class utils::PlanVisLogger;
+    friend class utils::SearchTraceWriter;
 
     int value;
     explicit StateID(int value_)
@@ -3,19 +3,81 @@
 #include "axioms.h"
 #include "globals.h"
 #include "global_operator.h"
-#include "per_state_information.h"
+#include "per_state_array.h"
 #include "../symmetries/graph_creator.h"
+#include "utils/language.h"
+#include "utils/profiler.h"
+
+#include <algorithm>
 #include <cassert>
 
 using namespace std;
 
+static const int STRIPE_BITS = 6;
+static const int NUM_STRIPES = 1 << STRIPE_BITS;
+// Must be a power of 2.
+static const size_t INITIAL_STRIPE_BUCKETS = 16;
+static const int EMPTY_BUCKET = -1;
+
+static int get_stripe_index(uint64_t hash) {
+    return hash >> (64 - STRIPE_BITS);
+}
+
+static uint64_t hash_state_data(const PackedStateBin *buffer, int num_bins) {
+    uint64_t hash = utils::hash_sequence(buffer, num_bins);
+    /*
+      The stripe and the bucket are selected with the highest and lowest
+      bits of the hash value, so we mix all bits with the finalizer of
+      MurmurHash3.
+    */
+    hash ^= hash >> 33;
+    hash *= 0xff51afd7ed558ccdULL;
+    hash ^= hash >> 33;
+    hash *= 0xc4ceb9fe1a85ec53ULL;
+    hash ^= hash >> 33;
+    return hash;
+}
+
+/*
+  New states are built in a buffer of the calling thread and only copied
+  to the state data pool if they are not registered yet.
+*/
+static PackedStateBin *get_thread_buffer() {
+    static thread_local vector<PackedStateBin> buffer;
+    buffer.resize(g_state_packer->get_num_bins());
+    return buffer.data();
+}
+
+/*
+  Staging area of get_successor_states: the packed data, numeric values,
+  instrumentation variables and hash value of each successor. The vectors
+  are reused for all expansions of the calling thread.
+*/
+struct SuccessorBatch {
+    vector<PackedStateBin> buffers;
+    vector<vector<ap_float>> numeric_values;
+    vector<vector<ap_float>> instrumentation_variables;
+    vector<uint64_t> hashes;
+    vector<int> order;
+};
+
+static SuccessorBatch &get_thread_batch() {
+    static thread_local SuccessorBatch batch;
+    return batch;
+}
+
+StateRegistry::StateIDStripe::StateIDStripe()
+    : buckets(INITIAL_STRIPE_BUCKETS, StateIDBucket {EMPTY_BUCKET, 0}),
+      num_entries(0) {
+}
+
 StateRegistry::StateRegistry(int number_of_numeric_constants)
-        : state_data_pool(g_state_packer->get_num_bins()),
+        : empty_state_data(g_state_packer->get_num_bins(), 0),
+          state_data_pool(g_state_packer->get_num_bins(), empty_state_data.data()),
           numeric_constants(vector<ap_float>(number_of_numeric_constants, 0)),
           numeric_indices(vector<int>(g_initial_state_numeric.size(),-1)),
-          registered_states(0,
-                            StateIDSemanticHash(state_data_pool),
-                            StateIDSemanticEqual(state_data_pool)),
+          registered_states(new StateIDStripe[NUM_STRIPES]),
+          num_states(0),
           cached_initial_state(0) {
 }
 
@@ -28,25 +90,83 @@ StateRegistry::~StateRegistry() {
     delete cached_initial_state;
 }
 
-StateID StateRegistry::insert_id_or_pop_state() {
-    /*
-      Attempt to insert a StateID for the last state of state_data_pool
-      if none is present yet. If this fails (another entry for this state
-      is present), we have to remove the duplicate entry from the
-      state data pool.
-    */
-    StateID id(state_data_pool.size() - 1);
-    pair<StateIDSet::iterator, bool> result = registered_states.insert(id);
-    bool is_new_entry = result.second;
-    if (!is_new_entry) {
-        state_data_pool.pop_back();
+template<class UpdateValues>
+StateID StateRegistry::insert_state(
+    const PackedStateBin *buffer, UpdateValues update_values) {
+    static utils::ProfileNode &profile_node =
+        utils::get_profile_node("search/state_registry/insert");
+    utils::ProfileScope profile_scope(profile_node);
+    uint64_t hash = hash_state_data(buffer, g_state_packer->get_num_bins());
+    StateIDStripe &stripe = registered_states[get_stripe_index(hash)];
+    lock_guard<mutex> lock(stripe.mutex);
+    return insert_state_locked(stripe, buffer, hash, update_values);
+}
+
+template<class UpdateValues>
+StateID StateRegistry::insert_state_locked(
+    StateIDStripe &stripe, const PackedStateBin *buffer, uint64_t hash,
+    UpdateValues update_values) {
+    int num_bins = g_state_packer->get_num_bins();
+    uint32_t short_hash = static_cast<uint32_t>(hash);
+    size_t mask = stripe.buckets.size() - 1;
+    size_t pos = short_hash & mask;
+    while (stripe.buckets[pos].id != EMPTY_BUCKET) {
+        const StateIDBucket &bucket = stripe.buckets[pos];
+        if (bucket.hash == short_hash) {
+            const PackedStateBin *data = state_data_pool.find(bucket.id);
+            if (equal(buffer, buffer + num_bins, data)) {
+                StateID id(bucket.id);
+                update_values(id, false);
+                return id;
+            }
+        }
+        pos = (pos + 1) & mask;
+    }
+
+    StateID id(num_states++);
+    copy(buffer, buffer + num_bins, state_data_pool.get(id.value));
+    stripe.buckets[pos] = StateIDBucket {id.value, short_hash};
+    update_values(id, true);
+    // Keep the load factor at most 3/4.
+    if (4 * ++stripe.num_entries > 3 * stripe.buckets.size())
+        grow(stripe);
+    return id;
+}
+
+void StateRegistry::grow(StateIDStripe &stripe) {
+    vector<StateIDBucket> old_buckets(
+        2 * stripe.buckets.size(), StateIDBucket {EMPTY_BUCKET, 0});
+    old_buckets.swap(stripe.buckets);
+    size_t mask = stripe.buckets.size() - 1;
+    for (const StateIDBucket &bucket : old_buckets) {
+        if (bucket.id == EMPTY_BUCKET)
+            continue;
+        size_t pos = bucket.hash & mask;
+        while (stripe.buckets[pos].id != EMPTY_BUCKET)
+            pos = (pos + 1) & mask;
+        stripe.buckets[pos] = bucket;
     }
-    assert(registered_states.size() == state_data_pool.size());
-    return *result.first;
+}
+
+size_t StateRegistry::get_memory_in_bytes() const {
+    size_t bytes = size() * g_state_packer->get_num_bins() * sizeof(PackedStateBin);
+    for (int i = 0; i < NUM_STRIPES; ++i) {
+        StateIDStripe &stripe = registered_states[i];
+        lock_guard<mutex> lock(stripe.mutex);
+        bytes += stripe.buckets.size() * sizeof(StateIDBucket);
+    }
+    return bytes;
+}
+
+void StateRegistry::set_instrumentation_variables(
+    StateID id, const vector<ap_float> &instrumentation_variables) {
+    lock_guard<mutex> lock(get_value_mutex(id));
+    copy(instrumentation_variables.begin(), instrumentation_variables.end(),
+         g_cost_information[lookup_state(id)].begin());
 }
 
 GlobalState StateRegistry::lookup_state(StateID id) const {
-    return GlobalState(state_data_pool[id.value], *this, id);
+    return GlobalState(state_data_pool.find(id.value), *this, id);
 }
 
 const GlobalState &StateRegistry::get_initial_state() {
@@ -55,9 +175,8 @@ const GlobalState &StateRegistry::get_initial_state() {
         PackedStateBin *buffer = new PackedStateBin[g_state_packer->get_num_bins()];
         // Avoid garbage values in half-full bins.
         fill_n(buffer, g_state_packer->get_num_bins(), 0);
-        for (size_t i = 0; i < g_initial_state_data.size(); ++i) {
-            g_state_packer->set(buffer, i, g_initial_state_data[i]);
-        }
+        g_state_packer->pack_all(buffer, g_initial_state_data.data(),
+                                 g_initial_state_data.size());
 //        if(DEBUG) cout << "Initial state data size = " << g_initial_state_data.size() << " numeric = " << g_initial_state_numeric.size() << endl;
         int regular_index = g_initial_state_data.size(); // regular numeric variables are stored after logic variables
         int constant_index = 0;
@@ -111,12 +230,13 @@ const GlobalState &StateRegistry::get_initial_state() {
 //        if (DEBUG) cout << "InstrVars = " << instrumentation_variables << endl;
         g_axiom_evaluator->evaluate_arithmetic_axioms(g_initial_state_numeric);
         g_axiom_evaluator->evaluate(buffer, g_initial_state_numeric); // evaluate logic axioms
-        state_data_pool.push_back(buffer);
-        // buffer is copied by push_back
+        StateID id = insert_state(buffer, [&](StateID id, bool) {
+            // save instrumentation variables in PerStateArray attachment
+            set_instrumentation_variables(id, instrumentation_variables);
+        });
+        // buffer is copied by insert_state
         delete[] buffer;
-        StateID id = insert_id_or_pop_state();
         cached_initial_state = new GlobalState(lookup_state(id));
-        g_cost_information[*cached_initial_state] = instrumentation_variables; // save instrumentation variables in PerStateInformation attachment
 
         // reset the initial state with updated axioms
         // set g_initial_state_numeric to the state with evaluated axioms:
@@ -286,49 +406,50 @@ void StateRegistry::get_canonical_numeric_successor(
 //TODO it would be nice to move the actual state creation (and operator application)
 //     out of the StateRegistry. This could for example be done by global functions
 //     operating on state buffers (PackedStateBin *).
-GlobalState StateRegistry::get_successor_state(const GlobalState &predecessor, const GlobalOperator &op) {
+void StateRegistry::apply_operator(
+        const GlobalState &predecessor, const GlobalOperator &op,
+        PackedStateBin *buffer, vector<ap_float> &numeric_values,
+        vector<ap_float> &instrumentation_variables) {
     assert(!op.is_axiom());
-    state_data_pool.push_back(predecessor.get_packed_buffer());
-    PackedStateBin *buffer = state_data_pool[state_data_pool.size() - 1];
-    for (size_t i = 0; i < op.get_effects().size(); ++i) {
-        const GlobalEffect &effect = op.get_effects()[i];
-        if (effect.does_fire(predecessor))
-            g_state_packer->set(buffer, effect.var, effect.val);
+    op.apply_effects(predecessor, buffer);
+    get_numeric_successor(numeric_values, instrumentation_variables, op,
+                          buffer, predecessor.get_packed_buffer());
+}
+
+void StateRegistry::update_successor_values(
+        StateID id, bool is_new, const GlobalState &predecessor,
+        const vector<ap_float> &numeric_values,
+        const vector<ap_float> &instrumentation_variables) {
+    // Only a maximized metric keeps the old instrumentation values if they are better.
+    if (!is_new && !g_metric_minimizes) {
+        ap_float old_val = evaluate_metric(get_numeric_vars(predecessor));
+        ap_float new_val = evaluate_metric(numeric_values);
+//    	    if (DEBUG) cout << "Metric of old state = " << old_val << " new = " << new_val << endl;
+        if (old_val > new_val)
+            return;
     }
+    set_instrumentation_variables(id, instrumentation_variables);
+}
+
+GlobalState StateRegistry::get_successor_state(const GlobalState &predecessor, const GlobalOperator &op) {
+    static utils::ProfileNode &profile_node =
+        utils::get_profile_node("search/state_registry");
+    utils::ProfileScope profile_scope(profile_node);
+    PackedStateBin *buffer = get_thread_buffer();
+    copy(predecessor.get_packed_buffer(),
+         predecessor.get_packed_buffer() + g_state_packer->get_num_bins(), buffer);
 //    if (DEBUG) cout << "Determining Successor state. getting predecessor..." << endl;
-    vector<ap_float> succ_vals = get_numeric_vars(predecessor);
-    vector<ap_float> inst_vals = g_cost_information[predecessor];
+    vector<ap_float> inst_vals;
+    vector<ap_float> succ_vals = get_numeric_vars(predecessor, inst_vals);
 //    if (DEBUG) cout << "Predecessor vector = " << succ_vals << endl;
 //    if (DEBUG) cout << "Instrumentation vector = " << inst_vals << endl;
-    get_numeric_successor(succ_vals, inst_vals, op, buffer, predecessor.get_packed_buffer());
+    apply_operator(predecessor, op, buffer, succ_vals, inst_vals);
 //    if (DEBUG) cout << "Successor vector = " << succ_vals << endl;
 //    if (DEBUG) cout << "Instrumentation vector = " << inst_vals << endl;
-    StateID id = insert_id_or_pop_state();
+    StateID id = insert_state(buffer, [&](StateID id, bool is_new) {
+        update_successor_values(id, is_new, predecessor, succ_vals, inst_vals);
+    });
     GlobalState successor = lookup_state(id);
-    if (id.value == (int) state_data_pool.size()-1) {
-//    	if(DEBUG) cout << "New State!!!!" << endl;
-        g_cost_information[successor] = inst_vals;
-    } else {
-        vector<ap_float> old_metric = g_cost_information[successor];
-        ap_float old_val = evaluate_metric(get_numeric_vars(predecessor));
-        ap_float new_val = evaluate_metric(succ_vals);
-//    	if (DEBUG) cout << "Metric of old state = " << old_val << " new = " << new_val << endl;
-        if (g_metric_minimizes && old_val < new_val) {
-            g_cost_information[successor] = old_metric;
-//    			cout << "metric minimizes, so the old metric value retains : " << evaluate_metric(successor);
-        } else {
-            g_cost_information[successor] = inst_vals;
-//    		cout << "metric maximizes or oldval > newval" << endl;
-        }
-
-        if (!g_metric_minimizes && old_val > new_val) {
-            g_cost_information[successor] = old_metric;
-//    		cout << "metric maximizes, so the old metric value retains : " << evaluate_metric(successor);
-        } else {
-            g_cost_information[successor] = inst_vals;
-            //    	else cout << "metric minimizes or oldval < newval" << endl;
-        }
-    }
 //    if (DEBUG) {
 //    	cout << "State registry returns successor of " << predecessor.id << " : " << id << " (Operator =" << op.get_name() << ")" << endl;
 //    	successor.dump_fdr();
@@ -336,50 +457,109 @@ GlobalState StateRegistry::get_successor_state(const GlobalState &predecessor, c
     return successor;
 }
 
+void StateRegistry::get_successor_states(
+        const GlobalState &predecessor, const vector<const GlobalOperator *> &ops,
+        vector<StateID> &successor_ids) {
+    static utils::ProfileNode &profile_node =
+        utils::get_profile_node("search/state_registry");
+    utils::ProfileScope profile_scope(profile_node);
+    int num_bins = g_state_packer->get_num_bins();
+    int num_successors = ops.size();
+    SuccessorBatch &batch = get_thread_batch();
+    batch.buffers.resize(num_successors * num_bins);
+    batch.numeric_values.resize(num_successors);
+    batch.instrumentation_variables.resize(num_successors);
+    batch.hashes.resize(num_successors);
+    batch.order.resize(num_successors);
+    successor_ids.assign(num_successors, StateID::no_state);
+
+    vector<ap_float> inst_vals;
+    vector<ap_float> numeric_vals = get_numeric_vars(predecessor, inst_vals);
+    const PackedStateBin *predecessor_buffer = predecessor.get_packed_buffer();
+    for (int i = 0; i < num_successors; ++i) {
+        PackedStateBin *buffer = &batch.buffers[i * num_bins];
+        copy(predecessor_buffer, predecessor_buffer + num_bins, buffer);
+        batch.numeric_values[i] = numeric_vals;
+        batch.instrumentation_variables[i] = inst_vals;
+        apply_operator(predecessor, *ops[i], buffer, batch.numeric_values[i],
+                       batch.instrumentation_variables[i]);
+        batch.hashes[i] = hash_state_data(buffer, num_bins);
+        batch.order[i] = i;
+    }
+
+    /*
+      Group the successors by stripe. The sort is stable, so equal
+      successors are inserted in the order of their operators, as with
+      get_successor_state, and their instrumentation variables are updated
+      in this order (see the header for what this means for duplicates).
+    */
+    stable_sort(batch.order.begin(), batch.order.end(), [&](int lhs, int rhs) {
+            return get_stripe_index(batch.hashes[lhs]) <
+                   get_stripe_index(batch.hashes[rhs]);
+        });
+
+    static utils::ProfileNode &insert_profile_node =
+        utils::get_profile_node("search/state_registry/insert");
+    utils::ProfileScope insert_profile_scope(insert_profile_node);
+    int begin = 0;
+    while (begin < num_successors) {
+        int stripe_index = get_stripe_index(batch.hashes[batch.order[begin]]);
+        int end = begin + 1;
+        while (end < num_successors &&
+               get_stripe_index(batch.hashes[batch.order[end]]) == stripe_index)
+            ++end;
+
+        StateIDStripe &stripe = registered_states[stripe_index];
+        lock_guard<mutex> lock(stripe.mutex);
+        /*
+          Load the first bucket of each successor and then the data of the
+          states in these buckets before the buckets are probed one after
+          the other, so that the cache misses of the group overlap.
+        */
+        size_t mask = stripe.buckets.size() - 1;
+        for (int k = begin; k < end; ++k) {
+            uint32_t short_hash = static_cast<uint32_t>(batch.hashes[batch.order[k]]);
+            utils::prefetch(&stripe.buckets[short_hash & mask]);
+        }
+        for (int k = begin; k < end; ++k) {
+            uint32_t short_hash = static_cast<uint32_t>(batch.hashes[batch.order[k]]);
+            const StateIDBucket &bucket = stripe.buckets[short_hash & mask];
+            if (bucket.id != EMPTY_BUCKET && bucket.hash == short_hash)
+                utils::prefetch(state_data_pool.find(bucket.id));
+        }
+        for (int k = begin; k < end; ++k) {
+            int i = batch.order[k];
+            successor_ids[i] = insert_state_locked(
+                stripe, &batch.buffers[i * num_bins], batch.hashes[i],
+                [&](StateID id, bool is_new) {
+                    update_successor_values(
+                        id, is_new, predecessor, batch.numeric_values[i],
+                        batch.instrumentation_variables[i]);
+                });
+        }
+        begin = end;
+    }
+}
+
 GlobalState StateRegistry::get_canonical_successor_state(const GlobalState &predecessor, const GlobalOperator &op) {
     assert(g_symmetry_graph != nullptr);
     assert(!op.is_axiom());
-    state_data_pool.push_back(predecessor.get_packed_buffer());
-    PackedStateBin *buffer = state_data_pool[state_data_pool.size() - 1];
-    for (size_t i = 0; i < op.get_effects().size(); ++i) {
-        const GlobalEffect &effect = op.get_effects()[i];
-        if (effect.does_fire(predecessor))
-            g_state_packer->set(buffer, effect.var, effect.val);
-    }
+    PackedStateBin *buffer = get_thread_buffer();
+    copy(predecessor.get_packed_buffer(),
+         predecessor.get_packed_buffer() + g_state_packer->get_num_bins(), buffer);
+    op.apply_effects(predecessor, buffer);
 //    if (DEBUG) cout << "Determining Successor state. getting predecessor..." << endl;
-    vector<ap_float> succ_vals = get_numeric_vars(predecessor);
-    vector<ap_float> inst_vals = g_cost_information[predecessor];
+    vector<ap_float> inst_vals;
+    vector<ap_float> succ_vals = get_numeric_vars(predecessor, inst_vals);
 //    if (DEBUG) cout << "Predecessor vector = " << succ_vals << endl;
 //    if (DEBUG) cout << "Instrumentation vector = " << inst_vals << endl;
     get_canonical_numeric_successor(succ_vals, inst_vals, op, buffer, predecessor.get_packed_buffer());
 //    if (DEBUG) cout << "Successor vector = " << succ_vals << endl;
 //    if (DEBUG) cout << "Instrumentation vector = " << inst_vals << endl;
-    StateID id = insert_id_or_pop_state();
+    StateID id = insert_state(buffer, [&](StateID id, bool is_new) {
+        update_successor_values(id, is_new, predecessor, succ_vals, inst_vals);
+    });
     GlobalState successor = lookup_state(id);
-    if (id.value == (int) state_data_pool.size()-1) {
-//    	if(DEBUG) cout << "New State!!!!" << endl;
-        g_cost_information[successor] = inst_vals;
-    } else {
-        vector<ap_float> old_metric = g_cost_information[successor];
-        ap_float old_val = evaluate_metric(get_numeric_vars(predecessor));
-        ap_float new_val = evaluate_metric(succ_vals);
-//    	if (DEBUG) cout << "Metric of old state = " << old_val << " new = " << new_val << endl;
-        if (g_metric_minimizes && old_val < new_val) {
-            g_cost_information[successor] = old_metric;
-//    			cout << "metric minimizes, so the old metric value retains : " << evaluate_metric(successor);
-        } else {
-            g_cost_information[successor] = inst_vals;
-//    		cout << "metric maximizes or oldval > newval" << endl;
-        }
-
-        if (!g_metric_minimizes && old_val > new_val) {
-            g_cost_information[successor] = old_metric;
-//    		cout << "metric maximizes, so the old metric value retains : " << evaluate_metric(successor);
-        } else {
-            g_cost_information[successor] = inst_vals;
-            //    	else cout << "metric minimizes or oldval < newval" << endl;
-        }
-    }
 //    if (DEBUG) {
 //    	cout << "State registry returns successor of " << predecessor.id << " : " << id << " (Operator =" << op.get_name() << ")" << endl;
 //    	successor.dump_fdr();
@@ -391,9 +571,7 @@ GlobalState StateRegistry::register_state(const std::vector<container_int> &valu
     PackedStateBin *buffer = new PackedStateBin[g_state_packer->get_num_bins()];
     // Avoid garbage values in half-full bins.
     fill_n(buffer, g_state_packer->get_num_bins(), 0);
-    for (size_t i = 0; i < values.size(); ++i) {
-        g_state_packer->set(buffer, i, values[i]);
-    }
+    g_state_packer->pack_all(buffer, values.data(), values.size());
     int regular_index = values.size(); // regular numeric variables are stored after logic variables
     int constant_index = 0;
     int derived_index = 0;
@@ -433,48 +611,43 @@ GlobalState StateRegistry::register_state(const std::vector<container_int> &valu
     }
     g_axiom_evaluator->evaluate_arithmetic_axioms(numeric_values);
     g_axiom_evaluator->evaluate(buffer, numeric_values); // evaluate logic axioms
-    state_data_pool.push_back(buffer);
-    // buffer is copied by push_back
-    delete[] buffer;
-    StateID id = insert_id_or_pop_state();
-    GlobalState new_state = lookup_state(id);
-
-    if (id.value == (int) state_data_pool.size()-1) {
-//    	if(DEBUG) cout << "New State!!!!" << endl;
-        g_cost_information[new_state] = instrumentation_variables;
-    } else {
-        vector<ap_float> old_metric = g_cost_information[new_state];
-        ap_float old_val = evaluate_metric(get_numeric_vars(new_state));
-        ap_float new_val = evaluate_metric(numeric_values);
-//    	if (DEBUG) cout << "Metric of old state = " << old_val << " new = " << new_val << endl;
-        if (g_metric_minimizes && old_val < new_val) {
-            g_cost_information[new_state] = old_metric;
-//    			cout << "metric minimizes, so the old metric value retains : " << evaluate_metric(successor);
-        } else {
-            g_cost_information[new_state] = instrumentation_variables;
-//    		cout << "metric maximizes or oldval > newval" << endl;
+    StateID id = insert_state(buffer, [&](StateID id, bool is_new) {
+        // Only a maximized metric keeps the old instrumentation values if they are better.
+        if (!is_new && !g_metric_minimizes) {
+            ap_float old_val = evaluate_metric(get_numeric_vars(lookup_state(id)));
+            ap_float new_val = evaluate_metric(numeric_values);
+//    	    if (DEBUG) cout << "Metric of old state = " << old_val << " new = " << new_val << endl;
+            if (old_val > new_val)
+                return;
         }
-
-        if (!g_metric_minimizes && old_val > new_val) {
-            g_cost_information[new_state] = old_metric;
-//    		cout << "metric maximizes, so the old metric value retains : " << evaluate_metric(successor);
-        } else {
-            g_cost_information[new_state] = instrumentation_variables;
-            //    	else cout << "metric minimizes or oldval < newval" << endl;
-        }
-    }
-
-    return new_state;
+        set_instrumentation_variables(id, instrumentation_variables);
+    });
+    // buffer is copied by insert_state
+    delete[] buffer;
+    return lookup_state(id);
 }
 
 void StateRegistry::subscribe(PerStateInformationBase *psi) const {
+    lock_guard<mutex> lock(subscribers_mutex);
     subscribers.insert(psi);
 }
 
 void StateRegistry::unsubscribe(PerStateInformationBase *const psi) const {
+    lock_guard<mutex> lock(subscribers_mutex);
     subscribers.erase(psi);
 }
 
+GlobalState StateRegistry::register_packed_state(
+    const PackedStateBin *buffer,
+    const vector<ap_float> &instrumentation_variables) {
+    assert(cached_initial_state);
+    StateID id = insert_state(buffer, [&](StateID id, bool is_new) {
+        if (is_new)
+            set_instrumentation_variables(id, instrumentation_variables);
+    });
+    return lookup_state(id);
+}
+
 ap_float StateRegistry::evaluate_metric(const vector<ap_float> &numeric_state) const {
     assert(g_metric_fluent_id >= 0);
     assert(g_metric_fluent_id < (int) numeric_state.size());
@@ -509,13 +682,26 @@ ap_float StateRegistry::assign_effect(ap_float aff_value, f_operator fop, ap_flo
 }
 
 vector<ap_float> StateRegistry::get_numeric_vars(const GlobalState &state) const {
-    vector<ap_float> result(g_numeric_var_types.size());
 //	if(DEBUG) cout << "Retrieving numeric state variables from StateRegistry" <<endl;
-    const vector<ap_float> &instrumentation_variables = g_cost_information[state];
+    lock_guard<mutex> lock(get_value_mutex(state.get_id()));
+    return get_numeric_vars(state.get_packed_buffer(), g_cost_information[state]);
+}
+
+vector<ap_float> StateRegistry::get_numeric_vars(
+        const GlobalState &state, vector<ap_float> &instrumentation_variables) const {
+    lock_guard<mutex> lock(get_value_mutex(state.get_id()));
+    ArrayView<ap_float> state_inst_vals = g_cost_information[state];
+    instrumentation_variables = state_inst_vals.to_vector();
+    return get_numeric_vars(state.get_packed_buffer(), state_inst_vals);
+}
+
+vector<ap_float> StateRegistry::get_numeric_vars(
+        const PackedStateBin *buffer,
+        ArrayView<const ap_float> instrumentation_variables) const {
+    vector<ap_float> result(g_numeric_var_types.size());
 //    if(DEBUG) cout << "instrumentation variables " << instrumentation_variables << endl;
     assert(g_initial_state_numeric.size() == g_numeric_var_types.size());
     assert(g_initial_state_numeric.size() == numeric_indices.size());
-    const PackedStateBin *buffer = state.get_packed_buffer();
     for (size_t i = 0; i < g_numeric_var_types.size(); ++i) {
         assert(i < numeric_indices.size());
         switch (g_numeric_var_types[i]) {
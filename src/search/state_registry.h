@@ -1,6 +1,7 @@
 #ifndef STATE_REGISTRY_H
 #define STATE_REGISTRY_H
 
+#include "array_view.h"
 #include "global_state.h"
 #include "globals.h"
 #include "int_packer.h"
@@ -9,8 +10,12 @@
 
 #include "utils/hash.h"
 
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
 #include <set>
-#include <unordered_set>
+#include <vector>
 
 /*
   Overview of classes relevant to storing and working with registered states.
@@ -34,7 +39,7 @@
     The actual state data is internally represented as a PackedStateBin array.
     Each PackedStateBin can contain the values of multiple variables.
     To minimize allocation overhead, the implementation stores the data of many
-    such states in a single large array (see SegmentedArrayVector).
+    such states in a single large array (see ConcurrentSegmentedArrayVector).
     PackedStateBin arrays are never manipulated directly but through
     a global IntPacker object.
 
@@ -46,11 +51,14 @@
     The StateRegistry also stores the actual state data in a memory friendly way.
     It uses the following class:
 
-  SegmentedArrayVector<PackedStateBin>
+  ConcurrentSegmentedArrayVector<PackedStateBin>
     This class is used to store the actual (packed) state data for all states
     while avoiding dynamically allocating each state individually.
     The index within this vector corresponds to the ID of the state.
 
+  Several threads can register and look up states of the same StateRegistry
+  and access PerStateInformation objects at the same time (see below).
+
   PerStateInformation<T>
     Associates a value of type T with every state in a given StateRegistry.
     Can be thought of as a very compactly implemented map from GlobalState to T.
@@ -100,49 +108,89 @@
 class PerStateInformationBase;
 
 class StateRegistry {
-    struct StateIDSemanticHash {
-        const SegmentedArrayVector<PackedStateBin> &state_data_pool;
-        StateIDSemanticHash(const SegmentedArrayVector<PackedStateBin> &state_data_pool_)
-            : state_data_pool(state_data_pool_) {
-        }
-        size_t operator()(StateID id) const {
-            return utils::hash_sequence(state_data_pool[id.value],
-                                        g_state_packer->get_num_bins());
-        }
-    };
-
-    struct StateIDSemanticEqual {
-        const SegmentedArrayVector<PackedStateBin> &state_data_pool;
-        StateIDSemanticEqual(const SegmentedArrayVector<PackedStateBin> &state_data_pool_)
-            : state_data_pool(state_data_pool_) {
-        }
-
-        bool operator()(StateID lhs, StateID rhs) const {
-            size_t size = g_state_packer->get_num_bins();
-            const PackedStateBin *lhs_data = state_data_pool[lhs.value];
-            const PackedStateBin *rhs_data = state_data_pool[rhs.value];
-            return std::equal(lhs_data, lhs_data + size, rhs_data);
-        }
-    };
-
     /*
       Hash set of StateIDs used to detect states that are already registered in
       this registry and find their IDs. States are compared/hashed semantically,
       i.e. the actual state data is compared, not the memory location.
+
+      The set is split into stripes by hash value. Each stripe is a hash
+      table with open addressing and linear probing that is protected by its
+      own mutex, so threads only wait for each other if they register states
+      of the same stripe. Buckets store 32 bits of the hash value of their
+      state, which avoids most comparisons of state data and allows
+      to grow a table without hashing its states again.
     */
-    typedef std::unordered_set<StateID,
-                               StateIDSemanticHash,
-                               StateIDSemanticEqual> StateIDSet;
+    struct StateIDBucket {
+        int id;
+        std::uint32_t hash;
+    };
+
+    struct alignas(64) StateIDStripe {
+        std::mutex mutex;
+        std::vector<StateIDBucket> buckets;
+        std::size_t num_entries;
 
-    SegmentedArrayVector<PackedStateBin> state_data_pool;
+        StateIDStripe();
+    };
+
+    // Used to initialize the state data pool, must be declared before it.
+    const std::vector<PackedStateBin> empty_state_data;
+    ConcurrentSegmentedArrayVector<PackedStateBin> state_data_pool;
     std::vector<ap_float> numeric_constants;
     std::vector<int> numeric_indices;
-    StateIDSet registered_states;
+    std::unique_ptr<StateIDStripe[]> registered_states;
+    std::atomic<int> num_states;
     GlobalState *cached_initial_state;
 
+    /*
+      The instrumentation variables of a state change when it is reached
+      again (see get_successor_state), so they are only read and written
+      while holding the mutex that the ID of the state is mapped to.
+    */
+    static const int NUM_VALUE_MUTEXES = 64;
+    mutable std::mutex value_mutexes[NUM_VALUE_MUTEXES];
+
+    mutable std::mutex subscribers_mutex;
     mutable std::set<PerStateInformationBase *> subscribers;
 
-    StateID insert_id_or_pop_state();
+    /*
+      Registers a copy of the given state data unless an equal state is
+      registered already and returns the ID of the state. Either way,
+      update_values(id, is_new) is called before other threads can register
+      the same state, e.g. to set its instrumentation variables.
+    */
+    template<class UpdateValues>
+    StateID insert_state(const PackedStateBin *buffer, UpdateValues update_values);
+    // Same as above for a state of the given stripe, whose mutex is locked.
+    template<class UpdateValues>
+    StateID insert_state_locked(
+        StateIDStripe &stripe, const PackedStateBin *buffer, std::uint64_t hash,
+        UpdateValues update_values);
+    void grow(StateIDStripe &stripe);
+
+    /*
+      Applies op to predecessor in the given buffer, which must contain a
+      copy of the predecessor. numeric_values and instrumentation_variables
+      must contain the values of the predecessor and are updated.
+    */
+    void apply_operator(
+        const GlobalState &predecessor, const GlobalOperator &op,
+        PackedStateBin *buffer, std::vector<ap_float> &numeric_values,
+        std::vector<ap_float> &instrumentation_variables);
+    void update_successor_values(
+        StateID id, bool is_new, const GlobalState &predecessor,
+        const std::vector<ap_float> &numeric_values,
+        const std::vector<ap_float> &instrumentation_variables);
+
+    std::mutex &get_value_mutex(StateID id) const {
+        return value_mutexes[id.value % NUM_VALUE_MUTEXES];
+    }
+    void set_instrumentation_variables(
+        StateID id, const std::vector<ap_float> &instrumentation_variables);
+    // Also returns a copy of the instrumentation variables of the state.
+    std::vector<ap_float> get_numeric_vars(
+        const GlobalState &state,
+        std::vector<ap_float> &instrumentation_variables) const;
 
 public:
     explicit StateRegistry(int number_of_numeric_constants);
@@ -158,25 +206,58 @@ public:
     /*
       Returns a reference to the initial state and registers it if this was not
       done before. The result is cached internally so subsequent calls are cheap.
+      The first call must not happen concurrently with other calls.
     */
     const GlobalState &get_initial_state();
 
     /*
       Returns the state that results from applying op to predecessor and
       registers it if this was not done before. This is an expensive operation
-      as it includes duplicate checking.
+      as it includes duplicate checking. Several threads can call it at
+      the same time.
     */
     GlobalState get_successor_state(const GlobalState &predecessor, const GlobalOperator &op);
 
+    /*
+      Registers the successors of predecessor for all given operators and
+      stores their IDs in successor_ids, in the order of the operators. The
+      successors are built and hashed first and then inserted grouped by
+      stripe, so that each stripe is locked once and the hash buckets (and
+      the data of the states they refer to) are prefetched before they are
+      probed. The instrumentation variables of the predecessor are read
+      once for all operators.
+
+      The registry ends up as after calling get_successor_state for each
+      operator in order (except for the IDs of new states), but all
+      successors are registered before the caller looks at any of them. If
+      several operators lead to the same state, the instrumentation
+      variables of that state are therefore already updated for all of
+      them (i.e., they are the values that get_successor_state leaves
+      after the last of these operators) when the caller evaluates the
+      successor of the first operator.
+    */
+    void get_successor_states(
+        const GlobalState &predecessor,
+        const std::vector<const GlobalOperator *> &ops,
+        std::vector<StateID> &successor_ids);
+
     GlobalState get_canonical_successor_state(const GlobalState &predecessor, const GlobalOperator &op);
 
     /*
-      Returns the number of states registered so far.
+      Returns the number of states registered so far. While other threads
+      register states, this includes states whose data is not written yet.
     */
     size_t size() const {
-        return registered_states.size();
+        return num_states.load();
     }
 
+    /*
+      Returns the number of bytes used for the packed data of the registered
+      states and for the buckets of the hash set. Instrumentation variables
+      and other per-state information are not included.
+    */
+    size_t get_memory_in_bytes() const;
+
     /*
       Remembers the given PerStateInformation. If this StateRegistry is
       destroyed, it notifies all subscribed PerStateInformation objects.
@@ -208,10 +289,28 @@ public:
     GlobalState register_state(const std::vector<container_int> &values,
                                std::vector<ap_float> &numeric_values);
 
+    /*
+      Registers a copy of a packed state buffer that was created by another
+      registry (e.g. read back from disk) with its instrumentation
+      variables. The buffer must already contain evaluated axioms, and the
+      initial state of this registry must have been created before.
+    */
+    GlobalState register_packed_state(
+        const PackedStateBin *buffer,
+        const std::vector<ap_float> &instrumentation_variables);
+
     ap_float evaluate_metric(const std::vector<ap_float> &numeric_state) const;
 
     std::vector<ap_float> get_numeric_vars(const GlobalState &state) const;
 
+    /*
+      Same as above for a packed state buffer that is not (or no longer)
+      registered, e.g. when decoding states stored in a search trace.
+    */
+    std::vector<ap_float> get_numeric_vars(
+        const PackedStateBin *buffer,
+        ArrayView<const ap_float> instrumentation_variables) const;
+
 protected:
     ap_float assign_effect(ap_float aff_value, f_operator fop, ap_float ass_value);
 
@@ -4,6 +4,7 @@
 #include "task_tools.h"
 
 #include "utils/collections.h"
+#include "utils/profiler.h"
 
 #include <algorithm>
 #include <cassert>
@@ -249,5 +250,8 @@ void SuccessorGenerator::generate_applicable_ops(
 
 void SuccessorGenerator::generate_applicable_ops(
     const GlobalState &state, std::vector<const GlobalOperator *> &applicable_ops) const {
+    static utils::ProfileNode &profile_node =
+        utils::get_profile_node("search/successor_generation");
+    utils::ProfileScope profile_scope(profile_node);
     root->generate_applicable_ops(state, applicable_ops);
 }
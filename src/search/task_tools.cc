@@ -2,6 +2,7 @@
 
 #include "../utils/system.h"
 
+#include <cstring>
 #include <iostream>
 
 using namespace std;
@@ -81,3 +82,139 @@ ap_float get_average_operator_cost(TaskProxy task_proxy) {
     average_operator_cost /= task_proxy.get_operators().size();
     return average_operator_cost;
 }
+
+namespace {
+// 64-bit FNV-1a, which does not depend on the standard library.
+class StableHash {
+    uint64_t hash;
+public:
+    explicit StableHash(uint64_t hash = 14695981039346656037ULL)
+        : hash(hash) {
+    }
+
+    void add(uint64_t value) {
+        for (int i = 0; i < 8; ++i) {
+            hash ^= (value >> (8 * i)) & 0xff;
+            hash *= 1099511628211ULL;
+        }
+    }
+
+    void add(int value) {
+        add(static_cast<uint64_t>(static_cast<int64_t>(value)));
+    }
+
+    void add(ap_float value) {
+        double d = static_cast<double>(value);
+        uint64_t bits;
+        memcpy(&bits, &d, sizeof(bits));
+        add(bits);
+    }
+
+    void add(const string &value) {
+        add(static_cast<uint64_t>(value.size()));
+        for (char c : value)
+            add(static_cast<int>(c));
+    }
+
+    void add(FactProxy fact) {
+        add(fact.get_variable().get_id());
+        add(fact.get_value());
+    }
+
+    void add(const ConditionsProxy &conditions) {
+        add(static_cast<int>(conditions.size()));
+        for (size_t i = 0; i < conditions.size(); ++i)
+            add(conditions[i]);
+    }
+
+    void add(OperatorProxy op) {
+        add(op.get_cost());
+        add(op.get_preconditions());
+        add(static_cast<int>(op.get_effects().size()));
+        for (EffectProxy effect : op.get_effects()) {
+            add(effect.get_conditions());
+            add(effect.get_fact());
+        }
+        add(static_cast<int>(op.get_ass_effects().size()));
+        for (AssEffectProxy effect : op.get_ass_effects()) {
+            add(effect.get_conditions());
+            NumAssProxy assignment = effect.get_assignment();
+            add(assignment.get_affected_variable().get_id());
+            add(static_cast<int>(assignment.get_assigment_operator_type()));
+            add(assignment.get_assigned_variable().get_id());
+        }
+    }
+
+    uint64_t get() const {
+        return hash;
+    }
+};
+}
+
+uint64_t compute_static_task_hash(TaskProxy task) {
+    StableHash hash;
+    VariablesProxy variables = task.get_variables();
+    hash.add(static_cast<int>(variables.size()));
+    for (VariableProxy var : variables) {
+        hash.add(var.get_name());
+        hash.add(var.get_domain_size());
+    }
+    NumericVariablesProxy numeric_variables = task.get_numeric_variables();
+    hash.add(static_cast<int>(numeric_variables.size()));
+    for (NumericVariableProxy num_var : numeric_variables) {
+        hash.add(num_var.get_name());
+        hash.add(static_cast<int>(num_var.get_var_type()));
+        // Constants only have a value in the initial state.
+        if (num_var.get_var_type() == constant)
+            hash.add(num_var.get_initial_state_value());
+    }
+    OperatorsProxy operators = task.get_operators();
+    hash.add(static_cast<int>(operators.size()));
+    for (OperatorProxy op : operators)
+        hash.add(op);
+    AxiomsProxy axioms = task.get_axioms();
+    hash.add(static_cast<int>(axioms.size()));
+    for (size_t i = 0; i < axioms.size(); ++i)
+        hash.add(axioms[i]);
+    ComparisonAxiomsProxy comparison_axioms = task.get_comparison_axioms();
+    hash.add(static_cast<int>(comparison_axioms.size()));
+    for (ComparisonAxiomProxy axiom : comparison_axioms) {
+        hash.add(axiom.get_left_variable().get_id());
+        hash.add(axiom.get_right_variable().get_id());
+        hash.add(static_cast<int>(axiom.get_comparison_operator_type()));
+        hash.add(axiom.get_true_fact());
+        hash.add(axiom.get_false_fact());
+    }
+    AssignmentAxiomsProxy assignment_axioms = task.get_assignment_axioms();
+    hash.add(static_cast<int>(assignment_axioms.size()));
+    for (AssignmentAxiomProxy axiom : assignment_axioms) {
+        hash.add(axiom.get_assignment_variable().get_id());
+        hash.add(axiom.get_left_variable().get_id());
+        hash.add(static_cast<int>(axiom.get_arithmetic_operator_type()));
+        hash.add(axiom.get_right_variable().get_id());
+    }
+    hash.add(task.get_goals());
+    return hash.get();
+}
+
+uint64_t compute_initial_state_hash(TaskProxy task) {
+    StableHash hash;
+    State initial_state = task.get_initial_state();
+    for (size_t var = 0; var < initial_state.size(); ++var)
+        hash.add(initial_state[var].get_value());
+    for (NumericVariableProxy num_var : task.get_numeric_variables())
+        hash.add(initial_state.nval(num_var.get_id()));
+    return hash.get();
+}
+
+uint64_t extend_stable_hash(uint64_t hash, uint64_t value) {
+    StableHash extended_hash(hash);
+    extended_hash.add(value);
+    return extended_hash.get();
+}
+
+uint64_t extend_stable_hash(uint64_t hash, const string &value) {
+    StableHash extended_hash(hash);
+    extended_hash.add(value);
+    return extended_hash.get();
+}
@@ -3,6 +3,9 @@
 
 #include "task_proxy.h"
 
+#include <cstdint>
+#include <string>
+
 
 inline bool is_applicable(OperatorProxy op, const State &state) {
     for (FactProxy precondition : op.get_preconditions()) {
@@ -50,4 +53,26 @@ void verify_no_conditional_effects(TaskProxy task);
 
 ap_float get_average_operator_cost(TaskProxy task_proxy);
 
+/*
+  Return a hash of the parts of the task that stay the same when the task is
+  solved again from a different initial state: the variables, the numeric
+  variables (including the values of numeric constants), the operators, the
+  axioms and the goal. Unlike std::hash, the result only depends on the task,
+  so it can be used to identify precomputations that are stored on disk.
+
+  Runtime: O(n), where n is the size of the task.
+*/
+uint64_t compute_static_task_hash(TaskProxy task);
+
+// Hash of the initial state that is stable in the same sense as above.
+uint64_t compute_initial_state_hash(TaskProxy task);
+
+/*
+  Continue a stable hash (e.g. one of the task hashes above) with the given
+  value, for example to include a configuration in the key of a
+  precomputation.
+*/
+uint64_t extend_stable_hash(uint64_t hash, uint64_t value);
+uint64_t extend_stable_hash(uint64_t hash, const std::string &value);
+
 #endif
@@ -160,11 +160,7 @@ std::vector<ap_float> RootTask::get_initial_state_numeric_values() const {
 
 vector<int> RootTask::get_state_values(const GlobalState &global_state) const {
     // TODO: Use unpacked values directly once issue348 is merged.
-    int num_vars = g_variable_domain.size();
-    vector<int> values(num_vars);
-    for (int var = 0; var < num_vars; ++var)
-        values[var] = global_state[var];
-    return values;
+    return global_state.get_values();
 }
 
 Fact RootTask::get_comparison_axiom_effect(
@@ -19,6 +19,18 @@ namespace utils {
 template<typename T>
 void unused_variable(const T &) {
 }
+
+/*
+  Hint to the processor that the memory at the given address will be read
+  soon. This does nothing for compilers that do not have __builtin_prefetch.
+*/
+inline void prefetch(const void *address) {
+#if defined(_MSC_VER)
+    unused_variable(address);
+#else
+    __builtin_prefetch(address);
+#endif
+}
 }
 
 #endif
@@ -0,0 +1,52 @@
+#include "parallel.h"
+
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+using namespace std;
+
+namespace utils {
+void parallel_for(size_t num_items, int num_threads,
+                  const function<void(size_t)> &func) {
+    size_t num_workers = min<size_t>(max(num_threads, 1), num_items);
+    if (num_workers <= 1) {
+        for (size_t i = 0; i < num_items; ++i)
+            func(i);
+        return;
+    }
+
+    atomic<size_t> next_item(0);
+    mutex exception_mutex;
+    exception_ptr first_exception;
+    auto work = [&]() {
+        while (true) {
+            size_t item = next_item.fetch_add(1);
+            if (item >= num_items)
+                return;
+            try {
+                func(item);
+            } catch (...) {
+                lock_guard<mutex> lock(exception_mutex);
+                if (!first_exception)
+                    first_exception = current_exception();
+                next_item = num_items;
+                return;
+            }
+        }
+    };
+
+    vector<thread> workers;
+    workers.reserve(num_workers - 1);
+    for (size_t i = 1; i < num_workers; ++i)
+        workers.emplace_back(work);
+    work();
+    for (thread &worker : workers)
+        worker.join();
+    if (first_exception)
+        rethrow_exception(first_exception);
+}
+}
@@ -0,0 +1,19 @@
+#ifndef UTILS_PARALLEL_H
+#define UTILS_PARALLEL_H
+
+#include <cstddef>
+#include <functional>
+
+namespace utils {
+/*
+  Calls func(i) for all i in [0, num_items) with up to num_threads threads,
+  one of which is the calling thread. Items are handed out one at a time,
+  so the calls can happen in any order and func must be safe to call
+  concurrently for different items. If a call throws, no further items are
+  handed out and the first exception is rethrown once all threads are done.
+*/
+void parallel_for(std::size_t num_items, int num_threads,
+                  const std::function<void(std::size_t)> &func);
+}
+
+#endif
@@ -14,43 +14,53 @@ using namespace std;
 namespace utils {
 PlanVisLogger::PlanVisLogger() {
 	var_names_latex.clear();
-	if (PLAN_VIS_LOG == plan_vis_log) {
+	if (PLAN_VIS_LOG == plan_vis_log)
+		write_header();
+}
+
+PlanVisLogger::PlanVisLogger(const std::string &file_name_)
+	: file_name(file_name_) {
+	write_header();
+}
+
+void PlanVisLogger::write_header() {
 	ofstream outfile;
-		outfile.open(file_name);
-		assert(g_variable_name.size() > 0);
-		outfile << "{\"vars\":[{\"VN\":\"" << g_variable_name[0] << "\",\n\"Vals\":[\"" << g_fact_names[0][0] << "\"";
-		for (size_t j=1; j < g_fact_names[0].size(); ++j)
-			outfile	<< ", \"" <<g_fact_names[0][j] << "\"";
+	outfile.open(file_name);
+	assert(g_variable_name.size() > 0);
+	outfile << "{\"vars\":[{\"VN\":\"" << g_variable_name[0] << "\",\n\"Vals\":[\"" << g_fact_names[0][0] << "\"";
+	for (size_t j=1; j < g_fact_names[0].size(); ++j)
+		outfile	<< ", \"" <<g_fact_names[0][j] << "\"";
+	outfile << "]}";
+	for (size_t i= 1; i < g_variable_name.size(); ++i) {
+		outfile << ",\n{\"VN\":\"" << g_variable_name[i] << "\",\n\"Vals\":[\"" << g_fact_names[i][0] << "\"";
+		for (size_t j=1; j < g_fact_names[i].size(); ++j)
+			outfile	<< ", \"" <<g_fact_names[i][j] << "\"";
 		outfile << "]}";
-		for (size_t i= 1; i < g_variable_name.size(); ++i) {
-			outfile << ",\n{\"VN\":\"" << g_variable_name[i] << "\",\n\"Vals\":[\"" << g_fact_names[i][0] << "\"";
-			for (size_t j=1; j < g_fact_names[i].size(); ++j)
-				outfile	<< ", \"" <<g_fact_names[i][j] << "\"";
-			outfile << "]}";
-		}
-		for (size_t i= 0; i < g_numeric_var_names.size(); ++i)
-			outfile << ",\n{\"VN\":\"" << g_numeric_var_names[i] << "\"}";
-		outfile << "],\"states\":[";
-		outfile.close();
 	}
+	for (size_t i= 0; i < g_numeric_var_names.size(); ++i)
+		outfile << ",\n{\"VN\":\"" << g_numeric_var_names[i] << "\"}";
+	outfile << "],\"states\":[";
+	outfile.close();
 }
 
 
 void PlanVisLogger::log_node(const StateID& stateid, std::string variables,
-		ap_float h_val, Timer htime, ap_float g_val, const StateID& parentid, bool is_goal,
+		ap_float h_val, double htime, ap_float g_val, const StateID& parentid, bool is_goal,
+		bool is_init) {
+	log_node(stateid.value, variables, h_val, htime, g_val, parentid.value,
+			is_goal, is_init);
+}
+
+void PlanVisLogger::log_node(int stateid, const std::string &variables,
+		ap_float h_val, double htime, ap_float g_val, int parentid, bool is_goal,
 		bool is_init) {
 
 	ofstream outfile;
 	outfile.open(file_name, std::ofstream::app);
-	stringstream ss;
-	ss << stateid;
-	string converted = ss.str();
-	converted.erase(0,1); // remove leading '#'
-	outfile << "{\t\"ID\":\"" << converted << "\",\n";
+	outfile << "{\t\"ID\":\"" << stateid << "\",\n";
 	outfile << "\t\"V\":[" << variables << "],\n";
     outfile << "\t\"H\":" << h_val << ",\n";
-    double timeval = htime();
-    outfile << "\t\"HT\": " << timeval << ",\n";
+    outfile << "\t\"HT\": " << htime << ",\n";
     outfile << "\t\"G\":" << g_val << ",\n";
     if (is_goal) {
     	outfile << "\t\"GoalState\": true,\n";
@@ -58,30 +68,23 @@ void PlanVisLogger::log_node(const StateID& stateid, std::string variables,
     if (is_init) {
     	outfile << "\t\"InitialState\": true\n},\n";
     } else {
-    	ss.str(std::string());
-    	ss << parentid;
-    	converted = ss.str();
-    	converted.erase(0,1); // remove leading '#'
-    	outfile << "\t\"P\":\"" << converted << "\"\n},\n";
+    	outfile << "\t\"P\":\"" << parentid << "\"\n},\n";
     }
     outfile.close();
 }
 
 void PlanVisLogger::log_duplicate(const StateID& stateid, ap_float g_val,
 		const StateID& parentid) {
+	log_duplicate(stateid.value, g_val, parentid.value);
+}
+
+void PlanVisLogger::log_duplicate(int stateid, ap_float g_val,
+		int parentid) {
 	ofstream outfile;
 	outfile.open(file_name, std::ofstream::app);
-	stringstream ss;
-	ss << stateid;
-	string converted = ss.str();
-	converted.erase(0,1); // remove leading '#'
-    outfile << "{\t\"ID\":\"" << converted << "\",\n";
+    outfile << "{\t\"ID\":\"" << stateid << "\",\n";
     outfile << "\t\"G\":" << g_val << ",\n";
-    ss.str(std::string());
-    ss << parentid;
-    converted = ss.str();
-    converted.erase(0,1); // remove leading '#'
-    outfile << "\t\"P\":\"" << converted << "\"\n}\n";
+    outfile << "\t\"P\":\"" << parentid << "\"\n}\n";
     outfile.close();
 }
 
@@ -19,22 +19,38 @@ class PlanVisLogger {
 	std::string explored_file = "explored_trace.data";
 	std::vector<std::string> var_names_latex;
 	std::string prune_latex_string(std::string full_state);
+	void write_header();
 public:
 	PlanVisLogger();
+	// Always writes the header, used when converting binary search traces.
+	explicit PlanVisLogger(const std::string &file_name);
 
 	void log_duplicate(const StateID &stateid,
 			ap_float g_val,
 			const StateID &parentid);
 
+	void log_duplicate(int stateid,
+			ap_float g_val,
+			int parentid);
+
 	void log_node(const StateID &stateid,
 			std::string variables,
 			ap_float h_val,
-			utils::Timer htime,
+			double htime,
 			ap_float g_val,
 			const StateID &parentid,
 			bool is_goal,
 			bool is_init);
 
+	void log_node(int stateid,
+			const std::string &variables,
+			ap_float h_val,
+			double htime,
+			ap_float g_val,
+			int parentid,
+			bool is_goal,
+			bool is_init);
+
 	void register_latex_var(std::string var_name);
 
 	void log_latex(std::string numeric_vals);
@@ -0,0 +1,169 @@
+#include "profiler.h"
+
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <mutex>
+
+using namespace std;
+
+namespace utils {
+uint64_t g_profile_sample_rate = 0;
+
+static string profile_json_filename;
+static uint64_t start_ticks = 0;
+static chrono::steady_clock::time_point start_time;
+
+static ProfileNode &get_root() {
+    // Never destroyed because static ProfileNode references may outlive it.
+    static ProfileNode *root = new ProfileNode("");
+    return *root;
+}
+
+ProfileNode::ProfileNode(const string &name)
+    : name(name),
+      calls(0),
+      sampled_calls(0),
+      sampled_ticks(0) {
+}
+
+ProfileNode &ProfileNode::get_child(const string &child_name) {
+    for (ProfileNode *child : children)
+        if (child->name == child_name)
+            return *child;
+    children.push_back(new ProfileNode(child_name));
+    return *children.back();
+}
+
+ProfileNode &get_profile_node(const string &path) {
+    // Function-local static nodes can be initialized by several search threads.
+    static mutex tree_mutex;
+    lock_guard<mutex> lock(tree_mutex);
+    ProfileNode *node = &get_root();
+    size_t begin = 0;
+    while (begin <= path.size()) {
+        size_t end = path.find('/', begin);
+        if (end == string::npos)
+            end = path.size();
+        node = &node->get_child(path.substr(begin, end - begin));
+        begin = end + 1;
+    }
+    return *node;
+}
+
+void enable_profiling(uint64_t sample_rate) {
+    g_profile_sample_rate = sample_rate;
+    start_ticks = read_time_stamp_counter();
+    start_time = chrono::steady_clock::now();
+}
+
+void set_profile_json_filename(const string &filename) {
+    profile_json_filename = filename;
+}
+
+static double get_ticks_per_second() {
+    double seconds = chrono::duration<double>(
+        chrono::steady_clock::now() - start_time).count();
+    uint64_t ticks = read_time_stamp_counter() - start_ticks;
+    return seconds > 0 ? ticks / seconds : 1;
+}
+
+/*
+  Nodes without scopes of their own (e.g. "search/heuristics") only group
+  their children. Their time is the sum of the time of their children.
+*/
+static bool is_used(const ProfileNode &node) {
+    if (node.get_calls() > 0)
+        return true;
+    for (const ProfileNode *child : node.get_children())
+        if (is_used(*child))
+            return true;
+    return false;
+}
+
+static double get_seconds(const ProfileNode &node, double ticks_per_second) {
+    if (node.get_calls() > 0)
+        return node.get_estimated_ticks() / ticks_per_second;
+    double seconds = 0;
+    for (const ProfileNode *child : node.get_children())
+        seconds += get_seconds(*child, ticks_per_second);
+    return seconds;
+}
+
+static void print_nodes(const vector<ProfileNode *> &nodes,
+                        double ticks_per_second, double parent_seconds,
+                        int depth) {
+    for (const ProfileNode *node : nodes) {
+        if (!is_used(*node))
+            continue;
+        double seconds = get_seconds(*node, ticks_per_second);
+        cout << string(2 * depth, ' ') << node->get_name() << ": "
+             << node->get_calls() << " calls, " << seconds << "s";
+        if (parent_seconds > 0)
+            cout << " (" << fixed << setprecision(1)
+                 << 100 * seconds / parent_seconds << "%)" << defaultfloat
+                 << setprecision(6);
+        cout << endl;
+        print_nodes(node->get_children(), ticks_per_second, seconds,
+                    depth + 1);
+    }
+}
+
+void print_profile() {
+    if (!g_profile_sample_rate)
+        return;
+    cout << "Profile (every " << g_profile_sample_rate
+         << ". call timed, times extrapolated):" << endl;
+    print_nodes(get_root().get_children(), get_ticks_per_second(), 0, 0);
+    if (!profile_json_filename.empty())
+        write_profile_json(profile_json_filename);
+}
+
+static string escape_json(const string &text) {
+    string result;
+    for (char c : text) {
+        if (c == '"' || c == '\\')
+            result += '\\';
+        result += c;
+    }
+    return result;
+}
+
+static void write_nodes_json(ostream &out,
+                             const vector<ProfileNode *> &children,
+                             double ticks_per_second) {
+    out << "[";
+    bool first = true;
+    for (const ProfileNode *child : children) {
+        if (!is_used(*child))
+            continue;
+        if (!first)
+            out << ",";
+        first = false;
+        out << "{\"name\": \"" << escape_json(child->get_name()) << "\", "
+            << "\"calls\": " << child->get_calls() << ", "
+            << "\"seconds\": "
+            << get_seconds(*child, ticks_per_second) << ", "
+            << "\"children\": ";
+        write_nodes_json(out, child->get_children(), ticks_per_second);
+        out << "}";
+    }
+    out << "]";
+}
+
+void write_profile_json(const string &filename) {
+    if (!g_profile_sample_rate)
+        return;
+    ofstream out(filename);
+    if (!out) {
+        cerr << "Could not write profile to " << filename << endl;
+        return;
+    }
+    out << "{\"sample_rate\": " << g_profile_sample_rate << ", "
+        << "\"nodes\": ";
+    write_nodes_json(out, get_root().get_children(), get_ticks_per_second());
+    out << "}" << endl;
+    cout << "Profile written to " << filename << endl;
+}
+}
@@ -0,0 +1,126 @@
+#ifndef UTILS_PROFILER_H
+#define UTILS_PROFILER_H
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#elif defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#else
+#include <chrono>
+#endif
+
+namespace utils {
+/*
+  Sampling profiler for the components of the search (successor
+  generation, state registry, axioms, heuristics, open lists, pruning).
+
+  Components are organized in a tree of ProfileNodes that is addressed
+  with paths like "search/heuristics/ff". Code that should be profiled
+  opens a ProfileScope for its node. Every call is counted, but only
+  every Nth call of a node (--profile N) is timed with the time stamp
+  counter; the total time of a node is extrapolated from the sampled
+  calls. A node's time includes the time of its children when they are
+  called from within the node.
+
+  When profiling is disabled (the default), a ProfileScope only costs
+  one well-predicted branch. The counters are atomic because the threads
+  of a parallel search share the nodes.
+*/
+class ProfileNode {
+    friend class ProfileScope;
+
+    std::string name;
+    std::vector<ProfileNode *> children;
+    std::atomic<uint64_t> calls;
+    std::atomic<uint64_t> sampled_calls;
+    std::atomic<uint64_t> sampled_ticks;
+public:
+    explicit ProfileNode(const std::string &name);
+    ProfileNode(const ProfileNode &) = delete;
+
+    ProfileNode &get_child(const std::string &child_name);
+
+    const std::string &get_name() const {
+        return name;
+    }
+
+    const std::vector<ProfileNode *> &get_children() const {
+        return children;
+    }
+
+    uint64_t get_calls() const {
+        return calls.load(std::memory_order_relaxed);
+    }
+
+    // Estimated total time of all calls in time stamp counter ticks.
+    double get_estimated_ticks() const {
+        uint64_t num_sampled = sampled_calls.load(std::memory_order_relaxed);
+        if (num_sampled == 0)
+            return 0;
+        double ticks = sampled_ticks.load(std::memory_order_relaxed);
+        return ticks / num_sampled * get_calls();
+    }
+};
+
+// Sample every Nth call of each node; 0 disables profiling.
+extern uint64_t g_profile_sample_rate;
+
+inline uint64_t read_time_stamp_counter() {
+#if defined(_MSC_VER) || defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    return std::chrono::steady_clock::now().time_since_epoch().count();
+#endif
+}
+
+class ProfileScope {
+    ProfileNode *sampled_node;
+    uint64_t start_ticks;
+public:
+    explicit ProfileScope(ProfileNode &node)
+        : sampled_node(nullptr),
+          start_ticks(0) {
+        if (g_profile_sample_rate) {
+            // Time the first call and every Nth call after it.
+            uint64_t call = node.calls.fetch_add(1, std::memory_order_relaxed);
+            if (call % g_profile_sample_rate == 0) {
+                sampled_node = &node;
+                start_ticks = read_time_stamp_counter();
+            }
+        }
+    }
+
+    ~ProfileScope() {
+        if (sampled_node) {
+            sampled_node->sampled_ticks.fetch_add(
+                read_time_stamp_counter() - start_ticks,
+                std::memory_order_relaxed);
+            sampled_node->sampled_calls.fetch_add(
+                1, std::memory_order_relaxed);
+        }
+    }
+
+    ProfileScope(const ProfileScope &) = delete;
+};
+
+/*
+  Returns the node with the given path ("a/b/c"), creating it and its
+  ancestors if necessary. Nodes live until the end of the program, so
+  it is safe to keep references to them in static variables.
+*/
+extern ProfileNode &get_profile_node(const std::string &path);
+
+extern void enable_profiling(uint64_t sample_rate);
+// Makes print_profile also write the profile as JSON (--profile-json).
+extern void set_profile_json_filename(const std::string &filename);
+// Does nothing if profiling is disabled.
+extern void print_profile();
+extern void write_profile_json(const std::string &filename);
+}
+
+#endif
@@ -0,0 +1,280 @@
+#include "search_trace.h"
+
+#include "planvis.h"
+#include "system.h"
+
+#include "../global_operator.h"
+#include "../global_state.h"
+#include "../per_state_array.h"
+#include "../state_registry.h"
+
+#include <cassert>
+#include <cstring>
+#include <iostream>
+#include <sstream>
+#include <unordered_map>
+
+using namespace std;
+
+namespace utils {
+static const char SEARCH_TRACE_MAGIC[8] = "NFDTRC1";
+static const int SEARCH_TRACE_VERSION = 1;
+static const size_t CHUNK_BYTES = 4 * 1024 * 1024;
+
+static int get_num_instrumentation_vars() {
+    int count = 0;
+    for (numType type : g_numeric_var_types)
+        if (type == instrumentation)
+            ++count;
+    return count;
+}
+
+static int get_op_id(const GlobalOperator *op) {
+    if (!op)
+        return -1;
+    assert(op >= &g_operators.front() && op <= &g_operators.back());
+    return op - &g_operators.front();
+}
+
+SearchTraceWriter::SearchTraceWriter(
+    const string &filename, size_t buffer_size_in_mb)
+    : num_bins(g_state_packer->get_num_bins()),
+      num_instrumentation_vars(get_num_instrumentation_vars()),
+      record_size(sizeof(SearchTraceRecord) +
+                  num_bins * sizeof(PackedStateBin) +
+                  num_instrumentation_vars * sizeof(ap_float)),
+      records_per_chunk(max(CHUNK_BYTES / record_size, size_t(1))),
+      file(fopen(filename.c_str(), "wb")),
+      start_time(chrono::steady_clock::now()),
+      current_chunk(0),
+      current_size(0),
+      finished(false) {
+    if (!file) {
+        cerr << "Could not open search trace file " << filename << endl;
+        exit_with(ExitCode::INPUT_ERROR);
+    }
+    SearchTraceHeader header;
+    memcpy(header.magic, SEARCH_TRACE_MAGIC, sizeof(header.magic));
+    header.version = SEARCH_TRACE_VERSION;
+    header.num_bins = num_bins;
+    header.num_instrumentation_vars = num_instrumentation_vars;
+    header.record_size = record_size;
+    fwrite(&header, sizeof(header), 1, file);
+
+    // We need at least two chunks so that the search can keep going
+    // while the writer thread is busy.
+    size_t chunk_bytes = records_per_chunk * record_size;
+    size_t num_chunks = max(buffer_size_in_mb * 1024 * 1024 / chunk_bytes,
+                            size_t(2));
+    chunks.resize(num_chunks, vector<char>(chunk_bytes));
+    for (size_t i = num_chunks - 1; i > 0; --i)
+        free_chunks.push_back(i);
+
+    writer_thread = thread(&SearchTraceWriter::run_writer, this);
+    cout << "Writing search trace to " << filename << " ("
+         << record_size << " bytes per record, "
+         << num_chunks << " x " << chunk_bytes << " bytes buffer)" << endl;
+}
+
+SearchTraceWriter::~SearchTraceWriter() {
+    {
+        lock_guard<std::mutex> lock(mutex);
+        if (current_size > 0)
+            full_chunks.emplace_back(current_chunk, current_size);
+        finished = true;
+    }
+    chunk_full.notify_one();
+    writer_thread.join();
+    fclose(file);
+}
+
+void SearchTraceWriter::run_writer() {
+    while (true) {
+        pair<int, size_t> chunk;
+        {
+            unique_lock<std::mutex> lock(mutex);
+            chunk_full.wait(lock, [this] () {
+                                return finished || !full_chunks.empty();
+                            });
+            if (full_chunks.empty())
+                return;
+            chunk = full_chunks.front();
+            full_chunks.pop_front();
+        }
+        fwrite(chunks[chunk.first].data(), 1, chunk.second, file);
+        {
+            lock_guard<std::mutex> lock(mutex);
+            free_chunks.push_back(chunk.first);
+        }
+        chunk_written.notify_one();
+    }
+}
+
+void SearchTraceWriter::hand_off_current_chunk() {
+    unique_lock<std::mutex> lock(mutex);
+    full_chunks.emplace_back(current_chunk, current_size);
+    chunk_full.notify_one();
+    chunk_written.wait(lock, [this] () {return !free_chunks.empty(); });
+    current_chunk = free_chunks.back();
+    free_chunks.pop_back();
+    current_size = 0;
+}
+
+void SearchTraceWriter::log(
+    const GlobalState &state, int parent_id, int op_id, int flags,
+    ap_float g, ap_float h, double h_time) {
+    if (current_size + record_size > records_per_chunk * record_size)
+        hand_off_current_chunk();
+    char *dest = chunks[current_chunk].data() + current_size;
+
+    SearchTraceRecord record;
+    record.state_id = state.get_id().value;
+    record.parent_id = parent_id;
+    record.op_id = op_id;
+    record.flags = flags;
+    record.g = g;
+    record.h = h;
+    record.h_time = h_time;
+    record.time = get_elapsed_seconds(start_time);
+    memcpy(dest, &record, sizeof(record));
+    dest += sizeof(record);
+
+    memcpy(dest, state.get_packed_buffer(), num_bins * sizeof(PackedStateBin));
+    dest += num_bins * sizeof(PackedStateBin);
+
+    if (num_instrumentation_vars > 0) {
+        ArrayView<ap_float> instrumentation_vars = g_cost_information[state];
+        assert(static_cast<int>(instrumentation_vars.size()) ==
+               num_instrumentation_vars);
+        memcpy(dest, instrumentation_vars.data(),
+               num_instrumentation_vars * sizeof(ap_float));
+    }
+    current_size += record_size;
+}
+
+void SearchTraceWriter::log_node(
+    const GlobalState &state, const GlobalState *parent,
+    const GlobalOperator *op, ap_float g, ap_float h, double h_time,
+    bool is_goal) {
+    int flags = SearchTraceRecord::NEW_NODE;
+    if (is_goal)
+        flags |= SearchTraceRecord::GOAL;
+    if (!parent)
+        flags |= SearchTraceRecord::INITIAL;
+    int parent_id = parent ? parent->get_id().value : -1;
+    log(state, parent_id, get_op_id(op), flags, g, h, h_time);
+}
+
+void SearchTraceWriter::log_duplicate(
+    const GlobalState &state, const GlobalState &parent,
+    const GlobalOperator &op, ap_float g) {
+    log(state, parent.get_id().value, get_op_id(&op),
+        SearchTraceRecord::DUPLICATE, g, 0, 0);
+}
+
+double SearchTraceWriter::get_elapsed_seconds(
+    chrono::steady_clock::time_point since) {
+    return chrono::duration<double>(chrono::steady_clock::now() - since).count();
+}
+
+
+struct TracedState {
+    vector<container_int> values;
+    vector<ap_float> numeric_values;
+};
+
+// Same output as GlobalState::dump_plan_vis_log.
+static string dump_plan_vis_log(const TracedState &state) {
+    stringstream outstream;
+    for (size_t i = 0; i < state.values.size(); ++i)
+        outstream << "{\"" << i << "\":" << state.values[i] << "},";
+    for (size_t i = 0; i < state.numeric_values.size(); ++i)
+        outstream << " {\"" << state.values.size() + i << "\":"
+                  << state.numeric_values[i] << "},";
+    string result = outstream.str();
+    if (!result.empty())
+        result.pop_back();
+    return result;
+}
+
+// Same output as GlobalState::dump_plan_vis_log(parent).
+static string dump_plan_vis_log(const TracedState &state,
+                                const TracedState &parent) {
+    stringstream outstream;
+    for (size_t i = 0; i < state.values.size(); ++i)
+        if (state.values[i] != parent.values[i])
+            outstream << "{\"" << i << "\":" << state.values[i] << "},";
+    for (size_t i = 0; i < state.numeric_values.size(); ++i)
+        if (state.numeric_values[i] != parent.numeric_values[i])
+            outstream << "{\"" << state.values.size() + i << "\":"
+                      << state.numeric_values[i] << "},";
+    string result = outstream.str();
+    if (!result.empty())
+        result.pop_back();
+    return result;
+}
+
+void convert_search_trace(const string &trace_filename,
+                          const string &plan_vis_filename) {
+    FILE *in = fopen(trace_filename.c_str(), "rb");
+    if (!in) {
+        cerr << "Could not open search trace file " << trace_filename << endl;
+        exit_with(ExitCode::INPUT_ERROR);
+    }
+    SearchTraceHeader header;
+    if (fread(&header, sizeof(header), 1, in) != 1 ||
+        memcmp(header.magic, SEARCH_TRACE_MAGIC, sizeof(header.magic)) != 0 ||
+        header.version != SEARCH_TRACE_VERSION) {
+        cerr << trace_filename << " is not a search trace file" << endl;
+        exit_with(ExitCode::INPUT_ERROR);
+    }
+    if (header.num_bins != g_state_packer->get_num_bins() ||
+        header.num_instrumentation_vars != get_num_instrumentation_vars()) {
+        cerr << "Search trace " << trace_filename
+             << " does not belong to the given task" << endl;
+        exit_with(ExitCode::INPUT_ERROR);
+    }
+
+    // Make sure the registry knows where numeric variables are stored.
+    g_initial_state();
+
+    PlanVisLogger logger(plan_vis_filename);
+    unordered_map<int, TracedState> traced_states;
+    vector<char> buffer(header.record_size);
+    int num_vars = g_variable_domain.size();
+    size_t num_records = 0;
+    while (fread(buffer.data(), header.record_size, 1, in) == 1) {
+        ++num_records;
+        SearchTraceRecord record;
+        memcpy(&record, buffer.data(), sizeof(record));
+        if (record.flags & SearchTraceRecord::DUPLICATE) {
+            logger.log_duplicate(record.state_id, record.g, record.parent_id);
+            continue;
+        }
+
+        const PackedStateBin *packed_state = reinterpret_cast<const PackedStateBin *>(
+            buffer.data() + sizeof(record));
+        vector<ap_float> instrumentation_vars(header.num_instrumentation_vars);
+        memcpy(instrumentation_vars.data(),
+               buffer.data() + sizeof(record) + header.num_bins * sizeof(PackedStateBin),
+               header.num_instrumentation_vars * sizeof(ap_float));
+
+        TracedState &state = traced_states[record.state_id];
+        state.values.resize(num_vars);
+        g_state_packer->unpack_all(packed_state, state.values.data(), num_vars);
+        state.numeric_values = g_state_registry->get_numeric_vars(
+            packed_state, instrumentation_vars);
+
+        bool is_init = record.flags & SearchTraceRecord::INITIAL;
+        auto parent = traced_states.find(record.parent_id);
+        string variables = (is_init || parent == traced_states.end()) ?
+            dump_plan_vis_log(state) : dump_plan_vis_log(state, parent->second);
+        logger.log_node(record.state_id, variables, record.h, record.h_time,
+                        record.g, is_init ? record.state_id : record.parent_id,
+                        record.flags & SearchTraceRecord::GOAL, is_init);
+    }
+    fclose(in);
+    cout << "Converted " << num_records << " search trace records from "
+         << trace_filename << " to " << plan_vis_filename << endl;
+}
+}
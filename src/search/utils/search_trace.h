@@ -0,0 +1,112 @@
+#ifndef UTILS_SEARCH_TRACE_H
+#define UTILS_SEARCH_TRACE_H
+
+#include "../globals.h" // ap_float, container_int
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+class GlobalOperator;
+class GlobalState;
+
+namespace utils {
+/*
+  Fixed-size part of every record in a binary search trace. Each record
+  is followed by the packed state buffer (num_bins container_ints) and
+  the instrumentation variables (num_instrumentation_vars ap_floats) of
+  the state, so all records of one trace have the same size, which is
+  stored in the SearchTraceHeader.
+*/
+struct SearchTraceRecord {
+    enum Flags {
+        NEW_NODE = 1,
+        DUPLICATE = 2,
+        GOAL = 4,
+        INITIAL = 8
+    };
+    int state_id;
+    int parent_id;  // -1 for the initial state
+    int op_id;      // -1 for the initial state
+    int flags;
+    ap_float g;
+    ap_float h;
+    double h_time;  // seconds spent computing h
+    double time;    // seconds since the trace was opened
+};
+
+struct SearchTraceHeader {
+    char magic[8];
+    int version;
+    int num_bins;
+    int num_instrumentation_vars;
+    int record_size;
+};
+
+/*
+  Low-overhead replacement for PlanVisLogger that can be enabled at
+  runtime (--search-trace FILENAME).
+
+  Records are copied into a ring of fixed-size chunks. Full chunks are
+  handed to a background thread that writes them to disk, so the search
+  thread only pays for a memcpy per node. If the writer thread falls
+  behind, log_* blocks until a chunk is free again; no records are
+  dropped.
+
+  Binary traces can be converted into the text format written by
+  PlanVisLogger with convert_search_trace (--convert-search-trace).
+*/
+class SearchTraceWriter {
+    const int num_bins;
+    const int num_instrumentation_vars;
+    const size_t record_size;
+    const size_t records_per_chunk;
+
+    std::FILE *file;
+    std::chrono::steady_clock::time_point start_time;
+
+    std::vector<std::vector<char>> chunks;
+    // Chunk the search thread is currently filling and its fill level.
+    int current_chunk;
+    size_t current_size;
+
+    std::mutex mutex;
+    std::condition_variable chunk_written;
+    std::condition_variable chunk_full;
+    std::deque<std::pair<int, size_t>> full_chunks;
+    std::vector<int> free_chunks;
+    bool finished;
+    std::thread writer_thread;
+
+    void run_writer();
+    void hand_off_current_chunk();
+    void log(const GlobalState &state, int parent_id, int op_id, int flags,
+             ap_float g, ap_float h, double h_time);
+public:
+    SearchTraceWriter(const std::string &filename, size_t buffer_size_in_mb);
+    ~SearchTraceWriter();
+
+    void log_node(const GlobalState &state, const GlobalState *parent,
+                  const GlobalOperator *op, ap_float g, ap_float h,
+                  double h_time, bool is_goal);
+    void log_duplicate(const GlobalState &state, const GlobalState &parent,
+                       const GlobalOperator &op, ap_float g);
+
+    static double get_elapsed_seconds(
+        std::chrono::steady_clock::time_point since);
+};
+
+/*
+  Writes the binary trace in trace_filename in PlanVisLogger's text format
+  to plan_vis_filename. Requires the task of the traced run to be loaded.
+*/
+extern void convert_search_trace(const std::string &trace_filename,
+                                 const std::string &plan_vis_filename);
+}
+
+#endif
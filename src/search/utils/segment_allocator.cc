@@ -0,0 +1,209 @@
+#include "segment_allocator.h"
+
+#include "system.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <iostream>
+#include <mutex>
+#include <new>
+#include <set>
+#include <stdexcept>
+
+#if OPERATING_SYSTEM == LINUX
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+using namespace std;
+
+namespace utils {
+static const size_t HUGE_PAGE_BYTES = 2 * 1024 * 1024;
+static const size_t MIN_ARENA_BYTES = HUGE_PAGE_BYTES;
+static const size_t MAX_ARENA_BYTES = 32 * HUGE_PAGE_BYTES;
+static const size_t SEGMENT_ALIGNMENT = alignof(max_align_t);
+
+static SegmentMemory segment_memory = SegmentMemory::HEAP;
+
+/*
+  Segmented vectors can be destroyed during static destruction (e.g.
+  g_cost_information), so the set of live allocators and its mutex are
+  never destroyed. Allocators can be created by several threads, e.g.
+  when numeric PDBs are built in parallel.
+*/
+static mutex &get_live_allocators_mutex() {
+    static mutex *live_allocators_mutex = new mutex();
+    return *live_allocators_mutex;
+}
+
+static set<const SegmentAllocator *> &get_live_allocators() {
+    static set<const SegmentAllocator *> *live_allocators =
+        new set<const SegmentAllocator *>();
+    return *live_allocators;
+}
+
+#if OPERATING_SYSTEM == LINUX
+// From <numaif.h>, which is only available with libnuma installed.
+static const int MPOL_LOCAL_POLICY = 4;
+
+static char *map_arena(size_t size, bool numa_local) {
+    /*
+      Over-allocate by one huge page so that we can cut out a region
+      aligned to huge pages; transparent huge pages are only used for
+      aligned 2 MB ranges.
+    */
+    size_t mapped_size = size + HUGE_PAGE_BYTES;
+    void *mapped = mmap(nullptr, mapped_size, PROT_READ | PROT_WRITE,
+                        MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+    if (mapped == MAP_FAILED)
+        return nullptr;
+    uintptr_t raw = reinterpret_cast<uintptr_t>(mapped);
+    uintptr_t aligned = (raw + HUGE_PAGE_BYTES - 1) & ~(HUGE_PAGE_BYTES - 1);
+    size_t head = aligned - raw;
+    size_t tail = mapped_size - head - size;
+    if (head)
+        munmap(mapped, head);
+    if (tail)
+        munmap(reinterpret_cast<void *>(aligned + size), tail);
+
+    char *start = reinterpret_cast<char *>(aligned);
+    // Both calls are hints: if they fail we still have usable memory.
+    madvise(start, size, MADV_HUGEPAGE);
+    if (numa_local)
+        syscall(SYS_mbind, start, size, MPOL_LOCAL_POLICY, nullptr, 0, 0);
+    return start;
+}
+
+static void unmap_arena(char *start, size_t size) {
+    munmap(start, size);
+}
+
+static size_t get_resident_bytes_of_range(char *start, size_t size) {
+    size_t page_size = sysconf(_SC_PAGESIZE);
+    size_t num_pages = (size + page_size - 1) / page_size;
+    vector<unsigned char> page_status(num_pages);
+    if (mincore(start, size, page_status.data()) != 0)
+        return size;
+    size_t resident_pages = count_if(
+        page_status.begin(), page_status.end(),
+        [] (unsigned char status) {return status & 1; });
+    return resident_pages * page_size;
+}
+#else
+static char *map_arena(size_t, bool) {
+    return nullptr;
+}
+
+static void unmap_arena(char *, size_t) {
+    assert(false);
+}
+
+static size_t get_resident_bytes_of_range(char *, size_t size) {
+    return size;
+}
+#endif
+
+
+SegmentAllocator::SegmentAllocator()
+    : heap_bytes(0) {
+    lock_guard<mutex> lock(get_live_allocators_mutex());
+    get_live_allocators().insert(this);
+}
+
+SegmentAllocator::~SegmentAllocator() {
+    for (const Arena &arena : arenas)
+        unmap_arena(arena.start, arena.size);
+    lock_guard<mutex> lock(get_live_allocators_mutex());
+    get_live_allocators().erase(this);
+}
+
+void *SegmentAllocator::allocate_from_arena(size_t bytes) {
+    bytes = (bytes + SEGMENT_ALIGNMENT - 1) & ~(SEGMENT_ALIGNMENT - 1);
+    if (arenas.empty() || arenas.back().used + bytes > arenas.back().size) {
+        size_t arena_size = arenas.empty() ?
+            MIN_ARENA_BYTES : min(2 * arenas.back().size, MAX_ARENA_BYTES);
+        arena_size = max(arena_size,
+                         (bytes + HUGE_PAGE_BYTES - 1) & ~(HUGE_PAGE_BYTES - 1));
+        bool numa_local = segment_memory == SegmentMemory::HUGE_PAGES_NUMA_LOCAL;
+        char *start = map_arena(arena_size, numa_local);
+        if (!start)
+            return nullptr;
+        arenas.push_back({start, arena_size, 0});
+    }
+    Arena &arena = arenas.back();
+    void *segment = arena.start + arena.used;
+    arena.used += bytes;
+    return segment;
+}
+
+void *SegmentAllocator::allocate(size_t bytes) {
+    if (segment_memory != SegmentMemory::HEAP) {
+        void *segment = allocate_from_arena(bytes);
+        if (segment)
+            return segment;
+        // Fall back to the heap, which handles running out of memory.
+    }
+    void *segment = ::operator new(bytes);
+    heap_bytes += bytes;
+    return segment;
+}
+
+void SegmentAllocator::deallocate(void *segment, size_t bytes) {
+    char *address = static_cast<char *>(segment);
+    for (const Arena &arena : arenas) {
+        if (address >= arena.start && address < arena.start + arena.size) {
+            // Arena memory is released by the destructor.
+            return;
+        }
+    }
+    ::operator delete(segment);
+    assert(heap_bytes >= bytes);
+    heap_bytes -= bytes;
+}
+
+size_t SegmentAllocator::get_reserved_bytes() const {
+    size_t reserved = heap_bytes;
+    for (const Arena &arena : arenas)
+        reserved += arena.size;
+    return reserved;
+}
+
+size_t SegmentAllocator::get_resident_bytes() const {
+    size_t resident = heap_bytes;
+    for (const Arena &arena : arenas)
+        resident += get_resident_bytes_of_range(arena.start, arena.size);
+    return resident;
+}
+
+void set_segment_memory(SegmentMemory mode) {
+    segment_memory = mode;
+}
+
+SegmentMemory get_segment_memory() {
+    return segment_memory;
+}
+
+SegmentMemory parse_segment_memory(const string &name) {
+    if (name == "heap")
+        return SegmentMemory::HEAP;
+    else if (name == "huge_pages")
+        return SegmentMemory::HUGE_PAGES;
+    else if (name == "huge_pages_numa_local")
+        return SegmentMemory::HUGE_PAGES_NUMA_LOCAL;
+    throw invalid_argument("unknown segment memory mode " + name);
+}
+
+void print_segment_memory_statistics() {
+    size_t reserved = 0;
+    size_t resident = 0;
+    lock_guard<mutex> lock(get_live_allocators_mutex());
+    for (const SegmentAllocator *allocator : get_live_allocators()) {
+        reserved += allocator->get_reserved_bytes();
+        resident += allocator->get_resident_bytes();
+    }
+    cout << "Segment memory reserved: " << reserved / 1024 << " KB" << endl;
+    cout << "Segment memory resident: " << resident / 1024 << " KB" << endl;
+}
+}
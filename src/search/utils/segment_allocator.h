@@ -0,0 +1,74 @@
+#ifndef UTILS_SEGMENT_ALLOCATOR_H
+#define UTILS_SEGMENT_ALLOCATOR_H
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace utils {
+enum class SegmentMemory {
+    // Every segment is allocated individually with operator new.
+    HEAP,
+    // Segments are carved out of large anonymous mappings that are
+    // aligned to and advised for transparent huge pages.
+    HUGE_PAGES,
+    // Like HUGE_PAGES, but the mappings are bound to the NUMA node of
+    // the thread that first touches them.
+    HUGE_PAGES_NUMA_LOCAL
+};
+
+/*
+  Provides the memory for the segments of SegmentedVector and
+  SegmentedArrayVector.
+
+  With the default HEAP mode this behaves exactly like allocating each
+  segment with new. In the huge page modes, segments are handed out
+  consecutively from arenas that are mapped with mmap and MADV_HUGEPAGE,
+  so that random accesses into large state pools (e.g. the hash lookups
+  of the StateRegistry) cause far fewer TLB misses. Arenas start at 2 MB
+  and double in size up to 64 MB. Their memory is only released when the
+  owning SegmentAllocator is destroyed, which matches how the segmented
+  vectors use their segments.
+
+  The mode is global and can be changed at any time (--segment-memory);
+  it only affects segments allocated afterwards. On systems without
+  mmap, all modes fall back to HEAP.
+*/
+class SegmentAllocator {
+    struct Arena {
+        char *start;
+        std::size_t size;
+        std::size_t used;
+    };
+    std::vector<Arena> arenas;
+    std::size_t heap_bytes;
+
+    void *allocate_from_arena(std::size_t bytes);
+public:
+    SegmentAllocator();
+    ~SegmentAllocator();
+    SegmentAllocator(const SegmentAllocator &) = delete;
+    SegmentAllocator &operator=(const SegmentAllocator &) = delete;
+
+    void *allocate(std::size_t bytes);
+    void deallocate(void *segment, std::size_t bytes);
+
+    // Address space that is allocated or mapped by this allocator.
+    std::size_t get_reserved_bytes() const;
+    /*
+      Part of the reserved memory that is backed by physical pages.
+      Heap segments are always counted as resident.
+    */
+    std::size_t get_resident_bytes() const;
+};
+
+extern void set_segment_memory(SegmentMemory mode);
+extern SegmentMemory get_segment_memory();
+// Throws std::invalid_argument for unknown names.
+extern SegmentMemory parse_segment_memory(const std::string &name);
+
+// Prints reserved and resident memory of all live segment allocators.
+extern void print_segment_memory_statistics();
+}
+
+#endif
@@ -1,5 +1,9 @@
 #include "system.h"
 
+#include <atomic>
+
+using namespace std;
+
 namespace utils {
 const char *get_exit_code_message_reentrant(ExitCode exitcode) {
     switch (exitcode) {
@@ -37,8 +41,16 @@ bool is_exit_code_error_reentrant(ExitCode exitcode) {
     }
 }
 
+static atomic<bool> exit_throws_exception(false);
+
 void exit_with(ExitCode exitcode) {
     report_exit_code_reentrant(exitcode);
+    if (exit_throws_exception)
+        throw ExitException(exitcode);
     exit(static_cast<int>(exitcode));
 }
+
+void set_exit_throws(bool exit_throws) {
+    exit_throws_exception = exit_throws;
+}
 }
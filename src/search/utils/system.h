@@ -42,7 +42,27 @@ enum class ExitCode {
     OUT_OF_MEMORY = 6
 };
 
+/*
+  Thrown by exit_with instead of terminating the process if this was
+  enabled with set_exit_throws(true). The planner service uses this to end
+  a single request instead of the whole process. The setting applies to
+  all threads, so code that calls exit_with in worker threads must pass
+  the exception on to the thread that started them (see parallel_for).
+*/
+class ExitException {
+    ExitCode exitcode;
+public:
+    explicit ExitException(ExitCode exitcode)
+        : exitcode(exitcode) {
+    }
+
+    ExitCode get_exit_code() const {
+        return exitcode;
+    }
+};
+
 NO_RETURN extern void exit_with(ExitCode returncode);
+extern void set_exit_throws(bool exit_throws);
 
 int get_peak_memory_in_kb();
 const char *get_exit_code_message_reentrant(ExitCode exitcode);
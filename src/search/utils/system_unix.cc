@@ -162,6 +162,8 @@ void out_of_memory_handler() {
       memory for the stack of the signal handler and raising a signal here.
     */
     write_reentrant_str(STDOUT_FILENO, "Failed to allocate memory.\n");
+    // A new handler must not throw other exceptions than bad_alloc.
+    set_exit_throws(false);
     exit_with(ExitCode::OUT_OF_MEMORY);
 }
 
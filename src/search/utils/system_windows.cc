@@ -16,6 +16,8 @@ using namespace std;
 namespace utils {
 void out_of_memory_handler() {
     cout << "Failed to allocate memory." << endl;
+    // A new handler must not throw other exceptions than bad_alloc.
+    set_exit_throws(false);
     exit_with(ExitCode::OUT_OF_MEMORY);
 }
 